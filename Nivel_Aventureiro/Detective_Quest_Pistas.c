@@ -7,11 +7,21 @@
  * Estruturas:
  *   1. Árvore Binária: Representa o mapa da mansão (Salas).
  *   2. BST (Binary Search Tree): Armazena as pistas coletadas em ordem alfabética.
+ *
+ * Uso:
+ *   ./Detective_Quest_Pistas             Mansão padrão.
+ *   ./Detective_Quest_Pistas <caso.txt>  Mansão lida de um arquivo de caso
+ *                                        (mesmo formato do Nível Mestre).
+ *   ./Detective_Quest_Pistas --lote <sessoes|-> [caso.txt]
+ *                                        Repete sessões sem menus: cada linha
+ *                                        tem os movimentos (ex.: "eds") e gera
+ *                                        "salas <TAB> pistas".
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 // ============================================================================
 // DEFINIÇÃO DAS ESTRUTURAS
@@ -50,6 +60,15 @@ void explorarSalasComPistas(Sala* mapa, PistaNode** raizPistas);
 // Imprime a árvore de pistas em ordem alfabética (Percurso Em-Ordem).
 void exibirPistas(PistaNode* raiz);
 
+// Lê a mansão de um arquivo de caso (retorna NULL se o arquivo for inválido).
+Sala* carregarMansao(const char* arquivo);
+
+// Repete uma sessão gravada (movimentos e/d/s) sem menus nem impressão.
+void repetirSessao(Sala* mapa, const char* movimentos, int* salas, int* pistas);
+
+// Lê sessões (uma por linha) e imprime uma linha de resultado por sessão.
+int executarLote(Sala* mapa, const char* arquivo);
+
 // Funções auxiliares para liberar memória.
 void liberarMapa(Sala* raiz);
 void liberarPistas(PistaNode* raiz);
@@ -58,22 +77,39 @@ void liberarPistas(PistaNode* raiz);
 // FUNÇÃO PRINCIPAL
 // ============================================================================
 
-int main() {
-    // 1. Construção do Mapa da Mansão (Árvore Binária Fixa)
-    // Nível 0: Raiz
-    Sala* mansao = criarSala("Hall de Entrada", "Pegadas de lama no chão");
-    
-    // Nível 1
-    mansao->esquerda = criarSala("Sala de Estar", "Relógio parado às 10h");
-    mansao->direita = criarSala("Cozinha", ""); // Cozinha sem pista
-    
-    // Nível 2 (Esquerda)
-    mansao->esquerda->esquerda = criarSala("Biblioteca", "Livro de venenos aberto");
-    mansao->esquerda->direita = criarSala("Jardim de Inverno", "Terra revirada recente");
-    
-    // Nível 2 (Direita)
-    mansao->direita->esquerda = criarSala("Sala de Jantar", "Taça de vinho quebrada");
-    mansao->direita->direita = criarSala("Porão", "Chave enferrujada antiga");
+int main(int argc, char* argv[]) {
+    Sala* mansao;
+    int modoLote = (argc >= 3 && strcmp(argv[1], "--lote") == 0);
+    const char* arquivoCaso = modoLote ? (argc >= 4 ? argv[3] : NULL)
+                                       : (argc >= 2 ? argv[1] : NULL);
+
+    if (arquivoCaso != NULL) {
+        // 1. Mapa da Mansão lido do arquivo de caso
+        mansao = carregarMansao(arquivoCaso);
+        if (mansao == NULL) return 1;
+    } else {
+        // 1. Construção do Mapa da Mansão (Árvore Binária Fixa)
+        // Nível 0: Raiz
+        mansao = criarSala("Hall de Entrada", "Pegadas de lama no chão");
+        
+        // Nível 1
+        mansao->esquerda = criarSala("Sala de Estar", "Relógio parado às 10h");
+        mansao->direita = criarSala("Cozinha", ""); // Cozinha sem pista
+        
+        // Nível 2 (Esquerda)
+        mansao->esquerda->esquerda = criarSala("Biblioteca", "Livro de venenos aberto");
+        mansao->esquerda->direita = criarSala("Jardim de Inverno", "Terra revirada recente");
+        
+        // Nível 2 (Direita)
+        mansao->direita->esquerda = criarSala("Sala de Jantar", "Taça de vinho quebrada");
+        mansao->direita->direita = criarSala("Porão", "Chave enferrujada antiga");
+    }
+
+    if (modoLote) {
+        int ok = executarLote(mansao, argv[2]);
+        liberarMapa(mansao);
+        return ok ? 0 : 1;
+    }
 
     // 2. Inicialização da Árvore de Pistas (Inventário vazio)
     PistaNode* inventarioPistas = NULL;
@@ -234,30 +270,292 @@ void explorarSalasComPistas(Sala* salaAtual, PistaNode** raizPistas) {
 /*
  * Função: exibirPistas
  * Realiza o percurso Em-Ordem (In-Order) na BST para imprimir alfabeticamente.
+ * Percurso de Morris: sem recursão nem pilha. Antes de descer à esquerda, o
+ * predecessor do nó ganha um "fio" temporário de volta a ele, desfeito na
+ * volta; ao final a árvore está como antes.
  */
 void exibirPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        exibirPistas(raiz->esquerda);
-        printf("- %s\n", raiz->conteudo);
-        exibirPistas(raiz->direita);
+    PistaNode* atual = raiz;
+
+    while (atual != NULL) {
+        if (atual->esquerda == NULL) {
+            printf("- %s\n", atual->conteudo);
+            atual = atual->direita;
+            continue;
+        }
+
+        PistaNode* predecessor = atual->esquerda;
+        while (predecessor->direita != NULL && predecessor->direita != atual) {
+            predecessor = predecessor->direita;
+        }
+        if (predecessor->direita == NULL) {
+            predecessor->direita = atual; // Fio de volta
+            atual = atual->esquerda;
+        } else {
+            predecessor->direita = NULL;  // Esquerda concluída: visita o nó
+            printf("- %s\n", atual->conteudo);
+            atual = atual->direita;
+        }
+    }
+}
+
+// Remove espaços e quebras de linha das pontas (altera a string).
+static char* aparar(char* texto) {
+    while (isspace((unsigned char)*texto)) texto++;
+    char* fim = texto + strlen(texto);
+    while (fim > texto && isspace((unsigned char)fim[-1])) *--fim = '\0';
+    return texto;
+}
+
+/*
+ * Função: carregarMansao
+ * Lê as salas de um arquivo de caso:
+ *   sala <id> <esquerda> <direita> <nome> | <pista>
+ * A sala 0 é a entrada e -1 indica que não há caminho. Linhas "suspeito",
+ * "implica", "limiar" e "porta" (usadas no Nível Mestre) e comentários com
+ * '#' são ignorados.
+ */
+Sala* carregarMansao(const char* arquivo) {
+    FILE* entrada = fopen(arquivo, "r");
+    if (entrada == NULL) {
+        printf("Erro: não foi possível abrir o caso '%s'.\n", arquivo);
+        return NULL;
+    }
+
+    Sala** salas = NULL;
+    long (*filhos)[2] = NULL;
+    size_t capacidade = 0, quantidade = 0;
+    char linha[1024];
+    int numeroLinha = 0, ok = 1;
+
+    while (ok && fgets(linha, sizeof(linha), entrada) != NULL) {
+        char* texto = aparar(linha);
+        long id, esquerda, direita;
+        int lidos = 0;
+        numeroLinha++;
+
+        if (texto[0] == '\0' || texto[0] == '#' || strncmp(texto, "suspeito ", 9) == 0 ||
+            strncmp(texto, "implica ", 8) == 0 || strncmp(texto, "limiar ", 7) == 0 ||
+            strncmp(texto, "porta ", 6) == 0) {
+            continue;
+        }
+
+        if (sscanf(texto, "sala %ld %ld %ld %n", &id, &esquerda, &direita, &lidos) != 3 || lidos == 0 ||
+            id < 0 || id > 10000000) {
+            ok = 0;
+            break;
+        }
+
+        char* nome = texto + lidos;
+        char* pista = strchr(nome, '|');
+        if (pista != NULL) *pista++ = '\0';
+        nome = aparar(nome);
+        pista = pista ? aparar(pista) : "";
+        if (strlen(nome) >= sizeof(((Sala*)0)->nome) || strlen(pista) >= sizeof(((Sala*)0)->pista)) {
+            ok = 0;
+            break;
+        }
+
+        if ((size_t)id >= capacidade) {
+            size_t nova = capacidade ? capacidade : 64;
+            while (nova <= (size_t)id) nova *= 2;
+            salas = realloc(salas, nova * sizeof(Sala*));
+            filhos = realloc(filhos, nova * sizeof(*filhos));
+            if (salas == NULL || filhos == NULL) {
+                printf("Erro crítico: Falha na alocação de memória.\n");
+                exit(1);
+            }
+            memset(salas + capacidade, 0, (nova - capacidade) * sizeof(Sala*));
+            capacidade = nova;
+        }
+        if (salas[id] != NULL) {
+            ok = 0;
+            break;
+        }
+        salas[id] = criarSala(nome, pista);
+        filhos[id][0] = esquerda;
+        filhos[id][1] = direita;
+        if ((size_t)id + 1 > quantidade) quantidade = (size_t)id + 1;
+    }
+    fclose(entrada);
+    if (!ok) printf("Erro: linha %d inválida em '%s'.\n", numeroLinha, arquivo);
+
+    for (size_t i = 0; ok && i < quantidade; i++) {
+        if (salas[i] == NULL) {
+            printf("Erro: a sala %zu não foi definida em '%s'.\n", i, arquivo);
+            ok = 0;
+        }
+    }
+
+    // Liga os caminhos: cada sala (exceto a entrada) tem exatamente uma origem
+    char* temOrigem = calloc(quantidade + 1, 1);
+    if (temOrigem == NULL) {
+        printf("Erro crítico: Falha na alocação de memória.\n");
+        exit(1);
+    }
+    for (size_t i = 0; ok && i < quantidade; i++) {
+        for (int lado = 0; lado < 2 && ok; lado++) {
+            long filho = filhos[i][lado];
+            if (filho < 0) continue;
+            if ((size_t)filho >= quantidade || filho == 0 || temOrigem[filho]) {
+                printf("Erro: caminho inválido da sala %zu para a sala %ld.\n", i, filho);
+                ok = 0;
+                break;
+            }
+            temOrigem[filho] = 1;
+            if (lado == 0) salas[i]->esquerda = salas[filho];
+            else salas[i]->direita = salas[filho];
+        }
+    }
+    free(temOrigem);
+
+    // Com uma origem por sala, só é árvore se todas as salas forem alcançáveis
+    // a partir da entrada (um ciclo isolado ficaria de fora). Percurso em largura.
+    size_t alcancadas = 0;
+    if (ok && quantidade > 0) {
+        Sala** fila = malloc(quantidade * sizeof(Sala*));
+        if (fila == NULL) {
+            printf("Erro crítico: Falha na alocação de memória.\n");
+            exit(1);
+        }
+        fila[alcancadas++] = salas[0];
+        for (size_t inicio = 0; inicio < alcancadas; inicio++) {
+            if (fila[inicio]->esquerda) fila[alcancadas++] = fila[inicio]->esquerda;
+            if (fila[inicio]->direita) fila[alcancadas++] = fila[inicio]->direita;
+        }
+        free(fila);
     }
+    if (ok && (quantidade == 0 || alcancadas != quantidade)) {
+        printf("Erro: as salas de '%s' não formam uma árvore a partir da sala 0.\n", arquivo);
+        ok = 0;
+    }
+
+    Sala* raiz = NULL;
+    if (ok) {
+        raiz = salas[0];
+    } else {
+        // Libera sala por sala (as ligações podem estar incompletas)
+        for (size_t i = 0; i < quantidade; i++) free(salas[i]);
+    }
+    free(salas);
+    free(filhos);
+    return raiz;
 }
 
 /*
- * Funções de Limpeza (Recursivas Pós-Ordem)
+ * Função: repetirSessao
+ * Mesma navegação de explorarSalasComPistas, mas lendo os movimentos de uma
+ * string. Pistas com o mesmo texto contam uma vez só (como na BST).
+ */
+void repetirSessao(Sala* mapa, const char* movimentos, int* salas, int* pistas) {
+    const char* vistas[64];   // Pistas da sessão (o caminho costuma ser curto)
+    const char** coletadas = vistas;
+    int capacidade = 64;
+    Sala* salaAtual = mapa;
+
+    *salas = 0;
+    *pistas = 0;
+    while (salaAtual != NULL) {
+        (*salas)++;
+
+        if (salaAtual->pista[0] != '\0') {
+            int repetida = 0;
+            for (int i = 0; i < *pistas && !repetida; i++) {
+                repetida = (strcmp(coletadas[i], salaAtual->pista) == 0);
+            }
+            if (!repetida) {
+                if (*pistas == capacidade) {
+                    capacidade *= 2;
+                    const char** maior = malloc(capacidade * sizeof(const char*));
+                    if (maior == NULL) {
+                        printf("Erro crítico: Falha na alocação de memória.\n");
+                        exit(1);
+                    }
+                    memcpy(maior, coletadas, *pistas * sizeof(const char*));
+                    if (coletadas != vistas) free(coletadas);
+                    coletadas = maior;
+                }
+                coletadas[(*pistas)++] = salaAtual->pista;
+            }
+        }
+
+        if (salaAtual->esquerda == NULL && salaAtual->direita == NULL) break;
+
+        // Próximo movimento válido; opções inválidas ou bloqueadas são ignoradas
+        Sala* destino = NULL;
+        int sair = 0;
+        while (destino == NULL && !sair && *movimentos != '\0') {
+            char opcao = *movimentos++;
+            if (opcao == 'e' || opcao == 'E') destino = salaAtual->esquerda;
+            else if (opcao == 'd' || opcao == 'D') destino = salaAtual->direita;
+            else if (opcao == 's' || opcao == 'S') sair = 1;
+        }
+        salaAtual = destino; // NULL encerra a sessão
+    }
+
+    if (coletadas != vistas) free(coletadas);
+}
+
+/*
+ * Função: executarLote
+ * Lê as sessões do arquivo (ou da entrada padrão com "-"). Cada linha começa
+ * com os movimentos; linhas vazias ou iniciadas por '#' são ignoradas.
+ */
+int executarLote(Sala* mapa, const char* arquivo) {
+    FILE* entrada = (strcmp(arquivo, "-") == 0) ? stdin : fopen(arquivo, "r");
+    if (entrada == NULL) {
+        printf("Erro: não foi possível abrir as sessões '%s'.\n", arquivo);
+        return 0;
+    }
+
+    char* linha = NULL;
+    size_t capacidade = 0;
+    while (getline(&linha, &capacidade, entrada) != -1) {
+        linha[strcspn(linha, " \t\r\n")] = '\0'; // Só os movimentos
+        if (linha[0] == '\0' || linha[0] == '#') continue;
+
+        int salas, pistas;
+        repetirSessao(mapa, linha, &salas, &pistas);
+        printf("%d\t%d\n", salas, pistas);
+    }
+
+    free(linha);
+    if (entrada != stdin) fclose(entrada);
+    return 1;
+}
+
+/*
+ * Funções de Limpeza (Iterativas, sem pilha)
+ * Enquanto o nó atual tiver filho esquerdo, uma rotação à direita o traz
+ * para cima; sem filho esquerdo, o nó é liberado e segue-se à direita.
+ * Memória extra constante, mesmo numa mansão com milhões de salas em fila.
  */
 void liberarMapa(Sala* raiz) {
-    if (raiz != NULL) {
-        liberarMapa(raiz->esquerda);
-        liberarMapa(raiz->direita);
-        free(raiz);
+    while (raiz != NULL) {
+        if (raiz->esquerda != NULL) {
+            Sala* esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        } else {
+            Sala* direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
 }
 
 void liberarPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
+    while (raiz != NULL) {
+        if (raiz->esquerda != NULL) {
+            PistaNode* esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        } else {
+            PistaNode* direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
 }
@@ -6,42 +6,809 @@
  * Objetivo: Sistema de exploração de mansão com coleta de pistas e julgamento.
  * Estruturas:
  *   1. Árvore Binária: Representa o mapa da mansão (Salas).
- *   2. BST (Binary Search Tree): Armazena as pistas coletadas em ordem alfabética.
- *   3. Tabela Hash: Associa pistas a suspeitos para o veredito final.
+ *   2. BST (Binary Search Tree): Armazena as pistas coletadas em ordem alfabética
+ *      (balanceada como árvore AVL, com inserção iterativa).
+ *   3. Tabela Hash: Associa pistas a suspeitos para o veredito final
+ *      (endereçamento aberto e crescimento automático).
+ *   4. Arena do Caso: Pools de nós (salas, pistas) liberados de uma vez.
+ *   5. Tabela de Símbolos: Cada texto (cômodo, pista, suspeito) é guardado uma
+ *      única vez e as estruturas acima armazenam apenas seu id inteiro.
+ *   6. Inventário: A BST de pistas mais um placar de evidências por suspeito,
+ *      atualizado a cada pista nova (veredito e ranking sem percorrer a BST).
+ *   7. Arquivos de Caso: Mansão e gabarito lidos de um texto ou de um binário
+ *      compilado, mapeado com mmap e usado no próprio lugar.
+ *   8. Mansão Compacta: As mesmas salas num vetor contíguo em ordem de largura,
+ *      com os filhos calculados pelo índice (percursos sem saltar pela memória).
+ *   9. Modo Lote: Repete sessões gravadas (sequências e/d/s) sem menus,
+ *      com uma linha de resultado por sessão.
+ *  10. Simulador: Muitas sessões em paralelo (threads) sobre a mesma mansão e
+ *      tabela, só lidas; cada thread tem seu placar e contadores próprios.
+ *  11. Renderizador de Saída: O texto do jogo é juntado num buffer e escrito
+ *      com um write() por descarga; o modo silencioso troca os banners por
+ *      linhas "campo<TAB>valor" fáceis de processar.
+ *  12. Perito: Programação dinâmica de baixo para cima na mansão compacta;
+ *      para cada sala e suspeito, o máximo de pontos (pesos do índice
+ *      invertido) ainda alcançável e o caminho até eles, consultados em
+ *      O(1) durante o jogo (opção [p]).
+ *  13. Sessão Gravada: Posição e árvore de pistas num binário versionado
+ *      (opção [g]); ao continuar, os nós são usados no próprio arquivo
+ *      mapeado, sem reinserir pista por pista, e o placar é refeito deles.
+ *  14. Textos Vetorizados: Hash dos textos 16 ou 32 bytes por vez
+ *      (SSE2/AVX2, escolhidos ao iniciar conforme o processador, com versão
+ *      escalar de reserva); o hash é o mesmo em todos os caminhos.
+ *      Igualdade e ordem continuam escalares (strcmp da libc): as chaves
+ *      são textos internados de tamanho variável.
+ *  15. Gabarito Gerado: A mansão padrão usa uma tabela sem colisões gerada
+ *      por --gerar-gabarito e embutida no código (uma sondagem por consulta,
+ *      nenhuma alocação); casos em arquivo usam a tabela dinâmica.
+ *  16. Índice Invertido: Cada pista aponta para vários suspeitos com pesos
+ *      (linhas "implica"); cada pista nova soma a sua lista ao placar do
+ *      inventário e o ranking dos primeiros sai de um heap. O limiar para
+ *      condenar vem do caso (linha "limiar"; padrão: 2).
+ *  17. Índice de Nomes: Os nomes do elenco sem caixa e sem acento num vetor
+ *      ordenado; a acusação aceita o começo do nome ("mord" -> Mordomo),
+ *      achado por busca binária, e sugere os nomes quando há mais de um.
+ *  18. Mapa em Grafo: No modo --mapa as salas e portas (linhas "porta",
+ *      com ciclos) ficam em listas de vizinhos contíguas (CSR); dá para
+ *      voltar, cada sala é visitada uma vez para a pista e a menor rota até
+ *      um cômodo sai de uma busca em largura pelos dois lados, com carimbos.
+ *  19. Estatísticas: Compilado com -DESTATISTICAS, o jogo conta sondagens
+ *      das tabelas hash, profundidade e rotações da AVL de pistas, chamadas
+ *      de alocação e o tempo de cada fase, e grava tudo em JSON ao sair
+ *      (estatisticas.json, ou o arquivo em DQ_ESTATISTICAS; "-" = stderr).
+ *      Sem a opção, nada disso é compilado.
+ *  20. Gerador de Casos: Casos aleatórios, mas válidos, de qualquer tamanho
+ *      (forma e inclinação da árvore, densidade de pistas, suspeitos, pistas
+ *      com hash colidindo, pesos extras, portas), e o teste de carga
+ *      "jogo" dos benchmarks, que os passa por carga, mapa, exploração e
+ *      veredito.
+ *  21. Servidor de Sessões: Muitos jogadores ao mesmo tempo por um socket
+ *      Unix, num laço epoll de uma thread; o caso é carregado uma vez e cada
+ *      sessão guarda só sala, pistas e placar (reaproveitada do pool ao
+ *      fechar). O cliente de teste (nos benchmarks) abre conexões ociosas,
+ *      joga partidas e mostra os percentis de latência.
+ *  22. Diário de Movimentos: Cada movimento e pista nova vão para um diário
+ *      que só cresce, em lotes com verificação; o jogo sincroniza com o
+ *      disco antes de esperar cada escolha, e fora disso as sincronias são
+ *      agrupadas (por volume ou a cada 50 ms). Após uma queda, a partida é
+ *      refeita do diário, até o último lote inteiro.
+ *  23. Tabela Concorrente: Variante da tabela pista -> suspeito para carga
+ *      em várias threads, com inserção e consulta sem travas (CAS numa
+ *      palavra por posição), crescimento com migração cooperativa e
+ *      liberação dos vetores antigos por épocas.
+ *
+ * Uso:
+ *   ./Ultimo_Caso                      Jogo interativo (mansão padrão).
+ *   ./Ultimo_Caso <caso.txt|caso.dqc>  Jogo interativo com um caso em arquivo.
+ *   ./Ultimo_Caso --continuar <sessao.dqs> [caso]
+ *                                      Retoma uma sessão gravada com [g] no
+ *                                      mesmo caso (pode ser combinado com -q).
+ *   ./Ultimo_Caso --mapa [caso]        Exploração pelo grafo: caminhos da árvore
+ *                                      nos dois sentidos mais as linhas "porta"
+ *                                      do caso; [r <cômodo>] mostra a menor rota
+ *                                      (pode ser combinado com -q: portas, rota).
+ *   ./Ultimo_Caso -q [caso]            Modo silencioso (saída para máquinas):
+ *                                      sala, pista, saidas, fim, coletada,
+ *                                      placar, faltam, mais_citado, acusar,
+ *                                      sugestoes, veredito.
+ *   ./Ultimo_Caso --compilar <caso.txt> <caso.dqc>
+ *                                      Gera o binário compilado de um caso.
+ *   ./Ultimo_Caso --gerar-gabarito [caso]
+ *                                      Escreve em C a tabela sem colisões do
+ *                                      gabarito (embutida para a mansão padrão).
+ *   ./Ultimo_Caso --gerar-caso <caso.txt> [chave=valor...]
+ *                                      Gera um caso sintético (chaves: salas,
+ *                                      forma=completa|aleatoria, inclinacao,
+ *                                      densidade, suspeitos, colisao, implica,
+ *                                      portas, semente).
+ *   ./Ultimo_Caso --lote <sessoes|-> [caso]
+ *                                      Repete sessões: cada linha tem os movimentos
+ *                                      (ex.: "eds") e, opcionalmente, o acusado
+ *                                      (nome ou começo dele).
+ *                                      Saída por sessão (separada por tabulação):
+ *                                      salas  pistas  acusado  provas  veredito
+ *   ./Ultimo_Caso --perito [caso]      Máximo de pontos por suspeito a partir da
+ *                                      entrada (com os pesos do caso) e o
+ *                                      caminho que os reúne.
+ *   ./Ultimo_Caso --simular <n|sessoes> [threads] [caso]
+ *                                      Simula n sessões aleatórias (ou as do
+ *                                      arquivo) em paralelo e mostra, por
+ *                                      suspeito, quantas vezes seria condenado.
+ *   ./Ultimo_Caso --diario <partida.dqj> [caso]
+ *                                      Anota cada movimento e pista nova num
+ *                                      diário (apagado ao fim da partida).
+ *   ./Ultimo_Caso --recuperar <partida.dqj> [caso]
+ *                                      Retoma a partida interrompida do diário
+ *                                      (pode ser combinado com -q).
+ *   ./Ultimo_Caso --servidor <socket> [caso]
+ *                                      Atende sessões no socket Unix até Ctrl+C;
+ *                                      o protocolo é o do modo -q (uma linha por
+ *                                      comando, blocos terminados por linha vazia).
+ *   gcc -DESTATISTICAS ... Ultimo_Caso.c   Versão com estatísticas: qualquer modo
+ *                                      acima grava o JSON ao terminar.
+ *
+ * Benchmarks, estresse da tabela concorrente e o cliente de teste do
+ * servidor ficam fora do jogo, em Ultimo_Caso_Benchmarks.c (que inclui este
+ * arquivo):
+ *   gcc -O2 -o Ultimo_Caso_Benchmarks Ultimo_Caso_Benchmarks.c -lpthread
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
 #include <string.h>
 #include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <signal.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXTOS_X86 1
+#endif
+
+// ============================================================================
+// ESTATÍSTICAS (SÓ COM -DESTATISTICAS)
+// ============================================================================
+
+// Contadores de comportamento das estruturas e tempos por fase, gravados em
+// JSON na saída do programa. Sem -DESTATISTICAS as macros abaixo não geram
+// código nenhum. Os contadores são atômicos (o simulador consulta as tabelas
+// de várias threads).
+#define FAIXAS_SONDAGEM 8       // Sondagens por busca: 1, 2, 3-4, 5-8, ..., 65+
+
+typedef enum FaseJogo {
+    FASE_CARGA,                 // Leitura ou montagem do caso
+    FASE_MAPA,                  // Mansão compacta, perito, grafo de salas
+    FASE_EXPLORACAO,            // Exploração (inclui o tempo do jogador)
+    FASE_VEREDITO,              // Relatório, acusação (inclui a digitação) e veredito
+    FASE_REPETICAO,             // Modo lote e simulador
+    QUANTIDADE_FASES
+} FaseJogo;
+
+typedef struct SondagensTabela {
+    atomic_size_t buscas;
+    atomic_size_t sondagens;
+    atomic_size_t maior;
+    atomic_size_t faixas[FAIXAS_SONDAGEM];
+} SondagensTabela;
+
+typedef struct Estatisticas {
+    SondagensTabela simbolos;   // Índice de textos (funcaoHash)
+    SondagensTabela gabarito;   // Tabela pista -> suspeito (ids)
+    atomic_size_t insercoesPistas;
+    atomic_size_t profundidadePistas;   // Maior profundidade de uma inserção na AVL
+    atomic_size_t rotacoesPistas;
+    atomic_size_t callocs, reallocs, frees;
+    atomic_size_t bytesPedidos;
+    double inicioFase[QUANTIDADE_FASES];
+    double segundosFase[QUANTIDADE_FASES];
+    size_t vezesFase[QUANTIDADE_FASES];
+    double inicio;
+    int argc;
+    char** argv;
+} Estatisticas;
+
+#ifdef ESTATISTICAS
+Estatisticas estatisticas;
+
+static void registrarMaior(atomic_size_t* maior, size_t valor) {
+    size_t atual = atomic_load_explicit(maior, memory_order_relaxed);
+    while (valor > atual &&
+           !atomic_compare_exchange_weak_explicit(maior, &atual, valor, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static void registrarSondagens(SondagensTabela* tabela, size_t sondagens) {
+    size_t faixa = 0;
+    while (faixa + 1 < FAIXAS_SONDAGEM && ((size_t)1 << faixa) < sondagens) faixa++;
+    atomic_fetch_add_explicit(&tabela->buscas, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tabela->sondagens, sondagens, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tabela->faixas[faixa], 1, memory_order_relaxed);
+    registrarMaior(&tabela->maior, sondagens);
+}
+
+// Alocações contadas: as chamadas abaixo passam por estas funções (só neste
+// arquivo; as feitas dentro da libc não entram).
+static void* callocContado(size_t quantidade, size_t tamanho) {
+    atomic_fetch_add_explicit(&estatisticas.callocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&estatisticas.bytesPedidos, quantidade * tamanho, memory_order_relaxed);
+    return calloc(quantidade, tamanho);
+}
+
+static void* reallocContado(void* ptr, size_t bytes) {
+    atomic_fetch_add_explicit(&estatisticas.reallocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&estatisticas.bytesPedidos, bytes, memory_order_relaxed);
+    return realloc(ptr, bytes);
+}
+
+static void freeContado(void* ptr) {
+    if (ptr != NULL) atomic_fetch_add_explicit(&estatisticas.frees, 1, memory_order_relaxed);
+    free(ptr);
+}
+
+#define calloc(quantidade, tamanho) callocContado(quantidade, tamanho)
+#define realloc(ptr, bytes) reallocContado(ptr, bytes)
+#define free(ptr) freeContado(ptr)
+
+#define ESTATISTICA_SOMAR(campo, valor) \
+    atomic_fetch_add_explicit(&estatisticas.campo, (valor), memory_order_relaxed)
+#define ESTATISTICA_MAIOR(campo, valor) registrarMaior(&estatisticas.campo, (valor))
+#define ESTATISTICA_SONDAGENS(tabela, sondagens) registrarSondagens(&estatisticas.tabela, (sondagens))
+#define INICIAR_ESTATISTICAS(argc, argv) iniciarEstatisticas((argc), (argv))
+#define INICIAR_FASE(fase) iniciarFase(fase)
+#define ENCERRAR_FASE(fase) encerrarFase(fase)
+#else
+#define ESTATISTICA_SOMAR(campo, valor) ((void)0)
+#define ESTATISTICA_MAIOR(campo, valor) ((void)0)
+#define ESTATISTICA_SONDAGENS(tabela, sondagens) ((void)(sondagens))
+#define INICIAR_ESTATISTICAS(argc, argv) ((void)0)
+#define INICIAR_FASE(fase) ((void)0)
+#define ENCERRAR_FASE(fase) ((void)0)
+#endif
 
 // ============================================================================
 // DEFINIÇÃO DAS ESTRUTURAS
 // ============================================================================
 
-// Estrutura para a Árvore de Pistas (BST)
+// Estrutura para a Tabela de Símbolos (Internação de textos)
+// Associa cada texto distinto a um id inteiro compacto (0, 1, 2, ...).
+// Os textos são copiados para blocos que nunca mudam de endereço.
+#define SEM_SIMBOLO (-1)
+#define TAM_BLOCO_TEXTO 65536
+
+typedef struct BlocoTexto {
+    struct BlocoTexto* proximo;
+    size_t usados;
+    size_t capacidade;
+    char dados[];
+} BlocoTexto;
+
+typedef struct TabelaSimbolos {
+    const char** textos;    // id -> texto
+    uint64_t* hashes;       // id -> hash do texto (evita recalcular ao crescer)
+    size_t quantidade;
+    size_t capacidadeTextos;
+    int32_t* indice;        // Endereçamento aberto: posição -> id (SEM_SIMBOLO = livre)
+    size_t capacidadeIndice;
+    BlocoTexto* blocos;
+} TabelaSimbolos;
+
+// Estrutura para a Árvore de Pistas (BST balanceada - AVL)
 typedef struct PistaNode {
-    char conteudo[100];
+    int conteudo;               // Id da pista na tabela de símbolos
+    int altura;                 // Altura da subárvore (folha = 1)
     struct PistaNode* esquerda;
     struct PistaNode* direita;
 } PistaNode;
 
+// Limite da pilha de caminho da inserção: uma AVL com 2^64 nós tem altura < 93.
+#define ALTURA_MAXIMA_AVL 96
+
 // Estrutura para a Árvore da Mansão (Mapa)
 typedef struct Sala {
-    char nome[50];
-    char pista[100];        // Pista associada ao cômodo
+    int nome;               // Id do nome do cômodo
+    int pista;              // Id da pista associada (SEM_SIMBOLO = sem pista)
     struct Sala* esquerda;  // Caminho à esquerda
     struct Sala* direita;   // Caminho à direita
 } Sala;
 
 // Estrutura para a Tabela Hash (Associação Pista -> Suspeito)
+// As associações ficam dentro do próprio vetor da tabela (sem nós separados).
 typedef struct HashNode {
-    char pista[100];
-    char suspeito[50];
-    struct HashNode* proximo; // Tratamento de colisão por encadeamento
+    int pista;              // Id da pista (SEM_SIMBOLO indica posição livre)
+    int suspeito;           // Índice do suspeito no elenco da tabela
 } HashNode;
 
-#define TAM_HASH 31 // Tamanho primo para a tabela hash
+// Posição de um gabarito gerado em tempo de compilação (--gerar-gabarito).
+typedef struct EntradaGabarito {
+    const char* pista;      // NULL = posição vazia
+    int suspeito;           // Índice no elenco
+    uint64_t hash;          // funcaoHash(pista) no momento da geração
+} EntradaGabarito;
+
+// Tabela sem colisões para um gabarito fixo: cada pista tem uma posição só,
+// calculada de seu hash com a semente escolhida pelo gerador. 'slots' é um
+// vetor estático com as mesmas posições, preenchido com os ids ao usar.
+typedef struct GabaritoFixo {
+    const EntradaGabarito* entradas;
+    HashNode* slots;        // Preenchidos por usarGabaritoFixo
+    const char* const* elenco;
+    size_t quantidade;
+    size_t quantidadeSuspeitos;
+    unsigned bits;          // 2^bits posições
+    uint64_t semente;
+} GabaritoFixo;
+
+// Par do gabarito escrito à mão (fonte da tabela gerada).
+typedef struct ParGabarito {
+    const char* pista;
+    const char* suspeito;
+} ParGabarito;
+
+// Tabela com endereçamento aberto (sondagem linear) que dobra de tamanho
+// quando a carga passa de 3/4. Também mantém o elenco de suspeitos com
+// índices densos (0..k-1), usados pelos placares de evidências.
+// Com 'fixo', os slots são os do gabarito gerado (sem alocação nem
+// sondagem); a primeira inserção passa a tabela para slots dinâmicos.
+typedef struct TabelaHash {
+    const GabaritoFixo* fixo;
+    HashNode* slots;
+    size_t capacidade;      // Sempre potência de 2
+    size_t quantidade;
+    int* suspeitos;         // Índice do suspeito -> id do nome
+    size_t quantidadeSuspeitos;
+    size_t capacidadeSuspeitos;
+    int* indiceSuspeito;    // Id do símbolo -> índice do suspeito (ou -1)
+    size_t capacidadeIndiceSuspeito;
+} TabelaHash;
+
+// Conjunto de pistas como mapa de bits sobre os ids de símbolo (bit id =
+// pista presente). Operações entre conjuntos andam 64 pistas por palavra.
+typedef struct ConjuntoPistas {
+    uint64_t* palavras;
+    size_t quantidadePalavras;
+} ConjuntoPistas;
+
+typedef enum { CONJUNTO_UNIAO, CONJUNTO_INTERSECAO, CONJUNTO_DIFERENCA } OperacaoConjunto;
+
+// Para cada suspeito, o conjunto das pistas do gabarito que apontam para ele
+// (k máscaras contíguas de 'palavras' palavras). Provas contra s =
+// popcount(coletadas & máscara[s]).
+typedef struct MascarasSuspeitos {
+    uint64_t* bits;
+    size_t palavras;
+    size_t quantidadeSuspeitos;
+} MascarasSuspeitos;
+
+#define PROVAS_PARA_CONDENAR 2
+
+// Implicação ponderada (ids de símbolo): além do suspeito do gabarito, que
+// conta com peso 1, uma pista pode pesar contra outros suspeitos.
+typedef struct Implicacao {
+    int32_t pista;
+    int32_t suspeito;
+    int32_t peso;           // >= 1
+} Implicacao;
+
+// Porta extra entre duas salas (índices na ordem em largura da mansão,
+// a mesma da mansão compacta e do .dqc). Vale nos dois sentidos.
+typedef struct PortaMapa {
+    uint32_t a;
+    uint32_t b;
+} PortaMapa;
+
+// Estrutura do Caso: mapa da mansão e gabarito pista -> suspeito.
+// O mapa vem da arena (caso montado ou lido de texto) ou diretamente do
+// arquivo compilado mapeado em memória.
+typedef struct Caso {
+    Sala* mansao;           // Sala de entrada
+    size_t quantidadeSalas;
+    TabelaHash tabela;
+    Implicacao* implicacoes; // Linhas "implica" do caso (pesos extras)
+    size_t quantidadeImplicacoes;
+    size_t capacidadeImplicacoes;
+    int64_t limiar;         // Pontos para condenar (0 = PROVAS_PARA_CONDENAR)
+    PortaMapa* portas;      // Linhas "porta" do caso (só o modo mapa as usa)
+    size_t quantidadePortas;
+    void* mapeamento;       // Arquivo .dqc mapeado (NULL se o mapa está na arena)
+    size_t tamanhoMapeamento;
+} Caso;
+
+// Estrutura do Índice Invertido (pista -> suspeitos, com peso)
+// Em CSR: as entradas da pista p ficam em entradas[inicio[p] .. inicio[p + 1]),
+// com o índice do suspeito no elenco. A pista do gabarito entra com peso 1
+// para o seu suspeito e cada implicação acrescenta uma entrada (duplas
+// repetidas somam). Coletar uma pista soma a sua lista ao placar.
+typedef struct PesoSuspeito {
+    int32_t suspeito;
+    int32_t peso;
+} PesoSuspeito;
+
+typedef struct IndicePistas {
+    size_t* inicio;         // universo + 1 posições
+    PesoSuspeito* entradas;
+    size_t universo;        // Ids de símbolo cobertos
+    size_t quantidadeSuspeitos;
+} IndicePistas;
+
+// Estrutura do Inventário do Detetive
+// Além da BST de pistas, guarda os pontos de cada suspeito com os pesos do
+// índice invertido. O placar é atualizado na coleta (cada pista nova soma a
+// sua lista do índice), então relatório, ranking e veredito só o leem.
+// As mesmas pistas ficam num mapa de bits: repetição é descoberta sem
+// descer a árvore, e as contas entre conjuntos usam máscaras.
+typedef struct Inventario {
+    PistaNode* raiz;
+    ConjuntoPistas coletadas;
+    const IndicePistas* indice; // Pesos pista -> suspeitos (só lido)
+    int64_t* placar;        // Índice do suspeito no elenco -> pontos
+    size_t totalPistas;     // Pistas distintas coletadas
+} Inventario;
+
+// Suspeitos listados no placar do relatório final (os de mais pontos).
+#define RANKING_EXIBIDO 10
+
+// Estrutura do Índice de Nomes (acusação por prefixo, sem caixa nem acento)
+// Os nomes do elenco normalizados (minúsculas, sem acentos do Latin-1,
+// espaços simples) num vetor ordenado: os nomes que começam com um prefixo
+// formam uma faixa contígua, achada por busca binária. A faixa também é a
+// lista de sugestões quando o começo digitado serve a mais de um suspeito.
+#define TAM_NOME_ACUSADO 256
+#define NOMES_SUGERIDOS 10
+
+typedef struct IndiceNomes {
+    char* chaves;           // Nomes normalizados, um após o outro (com '\0')
+    size_t* deslocamento;   // Posição na ordem -> início da chave
+    int32_t* suspeito;      // Posição na ordem -> índice no elenco
+    size_t quantidade;
+} IndiceNomes;
+
+// Estrutura da Mansão Compacta (layout implícito em largura)
+// As salas ficam num vetor em ordem de largura, e os filhos de uma sala são
+// vizinhos nesse vetor: basta uma palavra por sala com o índice do primeiro
+// filho e os bits das saídas existentes. Numa mansão completa o primeiro
+// filho de i é 2i+1 (layout de Eytzinger). Os textos ficam fora, como ids.
+#define SAIDA_ESQUERDA 1u
+#define SAIDA_DIREITA 2u
+#define SEM_SALA UINT32_MAX
+#define MAX_SALAS_COMPACTAS (UINT32_MAX >> 2)
+
+typedef struct MansaoCompacta {
+    size_t quantidade;
+    uint32_t* ligacoes;     // (índice do primeiro filho << 2) | saídas
+    int32_t* pistas;        // Id da pista de cada sala (SEM_SIMBOLO = sem pista)
+    int32_t* nomes;         // Id do nome de cada sala
+} MansaoCompacta;
+
+// Estrutura do Mapa da Mansão (grafo de salas, modo --mapa)
+// Os caminhos da árvore e as portas do caso, todos de mão dupla, em CSR:
+// os vizinhos da sala s ficam em vizinhos[inicio[s] .. inicio[s + 1]).
+// A primeira saída de cada sala (exceto a entrada) volta para a de origem.
+// As salas também ficam agrupadas pelo id do nome, do mesmo jeito: as de
+// nome i em salasPorNome[inicioNome[i] .. inicioNome[i + 1]).
+typedef struct MapaSalas {
+    MansaoCompacta mansao;  // Nomes e pistas por sala (índices em largura)
+    size_t* inicio;         // quantidade + 1 posições
+    uint32_t* vizinhos;
+    size_t* inicioNome;     // quantidadeNomes + 1 posições
+    uint32_t* salasPorNome;
+    size_t quantidadeNomes; // Ids de nome cobertos (os símbolos na montagem)
+} MapaSalas;
+
+// Busca em largura pelos dois lados (origem e destino), reaproveitada entre
+// rotas: o carimbo de uma sala é 'rodada' (lado da origem) ou 'rodada + 1'
+// (lado do destino); carimbos de rodadas antigas não valem, então nada é
+// zerado por rota. Cada sala entra em no máximo um lado.
+typedef struct BuscaMapa {
+    uint32_t* anterior;     // Lado da origem: de onde se chegou; do destino: para onde segue
+    uint32_t* distancia;    // Passos até a raiz do seu lado
+    uint32_t* carimbo;
+    uint32_t* fila;         // Lado da origem do começo para o fim; do destino, do fim para o começo
+    size_t quantidade;
+    uint32_t rodada;
+} BuscaMapa;
+
+// Estrutura do Perito (rotas pré-calculadas)
+// melhor[sala * k + s]: pontos contra o suspeito s (pesos do índice
+// invertido, como no veredito) que ainda podem ser somados da sala para
+// baixo, contando a pista da própria sala. Uma pista só pontua na primeira
+// sala do caminho desde a entrada em que aparece (como no inventário, que
+// não repete pistas). O bit da mesma posição em 'direita' diz por qual lado
+// se chega a esse máximo.
+#define LIMITE_ENTRADAS_PERITO ((size_t)1 << 27)
+
+typedef struct Perito {
+    MansaoCompacta mansao;
+    size_t quantidadeSuspeitos;
+    int64_t* melhor;
+    uint8_t* direita;
+    int64_t limiar;         // Do caso: a opção [p] e --perito mostram o mesmo do veredito
+    int pronto;
+} Perito;
+
+// Estrutura do Repetidor de Sessões (Modo Lote)
+// Estado de trabalho de quem repete sessões. A mansão compacta e o índice
+// pista -> suspeitos são só lidos (podem ser compartilhados); os carimbos
+// evitam zerar os vetores a cada sessão: uma entrada só vale se o seu
+// carimbo é o da sessão atual.
+typedef struct Repetidor {
+    const MansaoCompacta* mansao;
+    const IndicePistas* indice;
+    size_t quantidadeSimbolos;
+    size_t quantidadeSuspeitos;
+    uint32_t* carimboPista;         // Id da pista -> sessão que a coletou por último
+    uint32_t* carimboPlacar;        // Índice do suspeito -> sessão do valor em 'placar'
+    int64_t* placar;
+    uint32_t sessao;
+} Repetidor;
+
+typedef struct ResultadoSessao {
+    uint32_t salas;         // Salas em que o jogador entrou (inclui a entrada)
+    uint32_t pistas;        // Pistas distintas coletadas
+    int acusado;            // Índice do suspeito acusado (-1 = sem acusação)
+    int64_t provas;         // Pontos contra o acusado
+} ResultadoSessao;
+
+// Estrutura do Simulador de Sessões
+// Dados comuns a todas as threads (só leitura durante a simulação).
+typedef struct Simulacao {
+    const MansaoCompacta* mansao;
+    const IndicePistas* indice;
+    TabelaHash* tabela;
+    int64_t limiar;             // Pontos para condenar
+    const char* roteiro;        // Sessões gravadas (NULL = sessões aleatórias)
+    size_t tamanhoRoteiro;
+    uint32_t movimentosSessao;  // Tamanho das sessões aleatórias
+} Simulacao;
+
+// Parte de uma thread: sua faixa de trabalho, seu Repetidor e seus totais.
+// Os totais só são escritos no fim, para as threads não disputarem a mesma
+// linha de cache durante o laço.
+typedef struct TrabalhoSimulacao {
+    const Simulacao* simulacao;
+    size_t inicio, fim;         // Sessões aleatórias ou bytes do roteiro
+    uint64_t semente;
+    uint64_t sessoes, salas, pistas, semPistas;
+    uint64_t* condenavel;       // Por suspeito: placar >= limiar do caso
+    uint64_t* maisCitado;       // Por suspeito: vezes em que liderou o placar sozinho
+    uint64_t* empatado;         // Por suspeito: vezes em que dividiu a liderança
+} TrabalhoSimulacao;
+
+// Tabela concorrente pista -> suspeito (ids internados), para carregar em
+// várias threads: cada posição é uma palavra de 64 bits trocada inteira por
+// CAS, com (pista + 1) nos 32 bits altos e (suspeito + 1) nos baixos; 0 =
+// livre. O bit MOVIDA_CONCORRENTE congela a posição para a migração: ao
+// passar de 3/4, um vetor com o dobro é pendurado em 'proximo' e as escritas
+// só seguem nele depois que todas as posições antigas foram congeladas e
+// copiadas. Vetores fora de uso são liberados por épocas. Guarda o id do
+// suspeito, não o elenco: copiarTabelaConcorrente() o monta numa thread só.
+#define MOVIDA_CONCORRENTE 0x80000000ULL
+#define MAX_PARTICIPANTES 64
+#define BLOCO_MIGRACAO 1024
+
+typedef struct VetorConcorrente {
+    size_t capacidade;          // Sempre potência de 2
+    atomic_size_t ocupadas;
+    atomic_size_t proximoBloco; // Próximas posições a migrar
+    atomic_size_t migradas;
+    atomic_int completa;        // Todas as posições congeladas e copiadas
+    struct VetorConcorrente* _Atomic proximo;
+    struct VetorConcorrente* aposentadoSeguinte; // Lista de quem o aposentou
+    uint64_t epocaAposentado;
+    _Atomic uint64_t posicoes[];
+} VetorConcorrente;
+
+// Thread registrada na tabela: época vista ao entrar numa operação (0 =
+// fora de operação) e os vetores que aposentou. Uma linha de cache cada.
+typedef struct ParticipanteTabela {
+    _Alignas(64) _Atomic uint64_t epoca;
+    VetorConcorrente* aposentados;
+    size_t liberados;
+} ParticipanteTabela;
+
+typedef struct TabelaConcorrente {
+    VetorConcorrente* _Atomic atual;
+    atomic_int participantes;
+    _Alignas(64) _Atomic uint64_t epoca; // Época global (começa em 1)
+    ParticipanteTabela participante[MAX_PARTICIPANTES];
+} TabelaConcorrente;
+
+// Estrutura do Gerador de Casos (casos sintéticos para testes de carga)
+// Lida de pares "chave=valor" na linha de comando (ver lerParametrosCaso).
+#define MAX_BITS_COLISAO 16
+
+typedef struct ParametrosCaso {
+    size_t salas;
+    int aleatoria;              // 0 = árvore completa; 1 = cada sala presa a uma origem sorteada
+    unsigned inclinacao;        // % de salas presas à anterior (árvore aleatória; 100 = corredor)
+    unsigned densidade;         // % de salas com pista
+    size_t suspeitos;
+    unsigned colisao;           // Bits baixos de funcaoHash iguais em todas as pistas (0 = nenhum)
+    unsigned implicacoes;       // % de pistas com um peso extra contra outro suspeito
+    size_t portas;
+    uint64_t semente;
+} ParametrosCaso;
+
+// Formato binário compilado (.dqc), na ordem de bytes e alinhamento da
+// máquina que o gerou, com estas seções após o cabeçalho:
+//   deslocamentos dos textos (uint64_t por símbolo) e os textos (com '\0'),
+//   salas (registros com o layout de Sala; filhos = índice + 1, 0 = sem saída),
+//   associações (pares de int32: id da pista, id do suspeito),
+//   elenco (int32: id de cada suspeito, na ordem do caso),
+//   implicações (trios de int32: id da pista, id do suspeito, peso),
+//   portas (pares de uint32: índices das salas na ordem em largura).
+#define MAGICA_CASO "DQCB"
+#define VERSAO_CASO 3
+
+// Sessão gravada (.dqs), com as mesmas convenções do .dqc. Seções após o
+// cabeçalho:
+//   movimentos desde a entrada ('e'/'d'),
+//   pistas coletadas (registros com o layout de PistaNode, em largura;
+//   filhos = índice + 1, 0 = sem filho).
+// O placar não é gravado: ao carregar, as pistas somam os pesos do índice.
+// Os ids de pista só valem no caso em que a sessão foi gravada: a impressão
+// digital do caso (textos e gabarito) é conferida antes de usar os registros.
+#define MAGICA_SESSAO "DQSS"
+#define VERSAO_SESSAO 2
+#define ARQUIVO_SESSAO "sessao.dqs"
+
+typedef struct CabecalhoSessao {
+    char magica[4];
+    uint32_t versao;
+    uint64_t impressaoCaso;
+    uint64_t quantidadeMovimentos;
+    uint64_t quantidadePistas;
+    uint64_t deslocamentoPistas;
+    uint64_t tamanhoArquivo;
+} CabecalhoSessao;
+
+// Movimentos feitos desde a entrada (gravados na sessão).
+typedef struct Trajeto {
+    char* movimentos;
+    size_t passos;
+    size_t capacidade;
+} Trajeto;
+
+// Arquivo de sessão mapeado: os nós da árvore de pistas vivem nele.
+typedef struct SessaoCarregada {
+    void* mapeamento;
+    size_t tamanho;
+} SessaoCarregada;
+
+// Diário de movimentos (.dqj): só cresce no fim. Após o cabeçalho, lotes de
+//   uint32_t tamanho, uint32_t verificação (FNV-1a do conteúdo, semeado com
+//   o número do lote) e o conteúdo: 'e'/'d' (um byte por movimento) ou 'p'
+//   seguido do id da pista (int32_t) a cada pista nova.
+// Um lote cortado ou com verificação errada no fim (queda durante a escrita)
+// é descartado na recuperação; a sessão volta ao último lote inteiro.
+#define MAGICA_DIARIO "DQDJ"
+#define VERSAO_DIARIO 1
+#define CABECALHO_LOTE (2 * sizeof(uint32_t))
+#define DIARIO_BYTES_SINCRONIA 4096    // fdatasync ao juntar isto sem sincronia...
+#define DIARIO_INTERVALO_SINCRONIA 0.05 // ...ou passado este tempo (s) da anterior
+
+typedef struct CabecalhoDiario {
+    char magica[4];
+    uint32_t versao;
+    uint64_t impressaoCaso;
+} CabecalhoDiario;
+
+typedef struct Diario {
+    int ativo;
+    int descritor;
+    unsigned char* lote;        // Lote em montagem (o cabeçalho ocupa o começo)
+    size_t usados;
+    size_t capacidade;
+    uint32_t lotes;             // Lotes já no arquivo (semente da próxima verificação)
+    size_t limiteSincronia;     // Bytes escritos sem fdatasync que forçam uma
+    double intervaloSincronia;
+    size_t naoSincronizados;
+    double ultimaSincronia;
+    size_t escritas, sincronias;
+    size_t movimentos, pistas;  // Recuperados por recuperarDiario
+    size_t descartados;         // Bytes do fim cortados na recuperação
+} Diario;
+
+typedef struct CabecalhoCaso {
+    char magica[4];
+    uint32_t versao;
+    uint64_t quantidadeSimbolos;
+    uint64_t quantidadeSalas;
+    uint64_t quantidadeAssociacoes;
+    uint64_t deslocamentoTextos;
+    uint64_t deslocamentoSalas;
+    uint64_t deslocamentoAssociacoes;
+    uint64_t quantidadeSuspeitos;
+    uint64_t deslocamentoElenco;
+    uint64_t quantidadeImplicacoes;
+    uint64_t deslocamentoImplicacoes;
+    int64_t limiar;
+    uint64_t quantidadePortas;
+    uint64_t deslocamentoPortas;
+    uint64_t tamanhoArquivo;
+} CabecalhoCaso;
+
+// Estrutura do Renderizador de Saída
+// Todo o texto do jogo passa por aqui e sai em um único write() por
+// descarga: antes de cada pergunta ao jogador, no fim e com o buffer cheio.
+#define TAM_BUFFER_SAIDA (1 << 16)
+
+typedef struct Renderizador {
+    char dados[TAM_BUFFER_SAIDA];
+    size_t usados;
+    int silencioso;         // 1 = sem banners, linhas "campo<TAB>valor"
+    size_t descargas;       // Chamadas a write() feitas até agora
+} Renderizador;
+
+#define CAPACIDADE_INICIAL_HASH 16
+
+// Estrutura para a Arena do Caso (Alocação em blocos)
+// Cada pool entrega nós de um único tipo, tirados de blocos grandes.
+// Nenhum nó é liberado individualmente: o caso inteiro é descartado de uma vez.
+#define NOS_POR_BLOCO 1024
+
+typedef struct BlocoPool {
+    struct BlocoPool* proximo;
+    size_t usados;                      // Nós já entregues deste bloco
+    _Alignas(void*) unsigned char dados[];
+} BlocoPool;
+
+typedef struct Pool {
+    size_t tamanhoNo;
+    BlocoPool* primeiro;    // Lista de blocos (reaproveitados após o reset)
+    BlocoPool* atual;       // Bloco de onde saem as próximas alocações
+    size_t alocacoes;       // Nós entregues desde o último reset
+    size_t blocos;          // Blocos pedidos ao sistema (mallocs)
+} Pool;
+
+typedef struct ArenaCaso {
+    Pool salas;
+    Pool pistas;
+} ArenaCaso;
+
+// Estrutura do Servidor de Sessões (modo --servidor)
+// Um processo, um laço de eventos (epoll) e muitas sessões. A mansão
+// compacta, os índices e as marcas de pista nova são do caso e só lidos;
+// cada conexão recebe uma SessaoServidor tirada de um pool, devolvida a uma
+// lista de livres ao fechar (placar e buffers são reaproveitados).
+// Protocolo por linhas, nas mesmas linhas "campo<TAB>valor" do modo -q:
+// cada comando (e, d, s ou o nome do acusado) recebe um bloco de resposta
+// terminado por uma linha vazia.
+#define TAM_LINHA_SERVIDOR TAM_NOME_ACUSADO
+#define EVENTOS_POR_ESPERA 256
+#define FAIXAS_LATENCIA (61 * 16)   // Log-linear: 16 faixas por potência de 2 (erro < 7%)
+
+typedef struct HistogramaLatencia {
+    uint64_t contagem[FAIXAS_LATENCIA];     // Em nanossegundos
+    uint64_t total;
+    uint64_t maior;
+} HistogramaLatencia;
+
+typedef struct SessaoServidor {
+    int descritor;
+    uint32_t sala;              // Índice na mansão compacta (SEM_SALA = hora da acusação)
+    int encerrando;             // Veredito dado: fecha quando a resposta sair inteira
+    int esperandoEscrita;       // EPOLLOUT ligado (o socket encheu)
+    int64_t* placar;            // Pontos por suspeito (índice no elenco, com os pesos)
+    int32_t* coletadas;         // Pistas na ordem da coleta
+    size_t quantidadeColetadas, capacidadeColetadas;
+    char* saida;                // Resposta ainda não enviada
+    size_t usadosSaida, enviadosSaida, capacidadeSaida;
+    size_t usadosEntrada;
+    char entrada[TAM_LINHA_SERVIDOR];
+    struct SessaoServidor* anterior;    // Lista das ativas (ou, livre, só 'proxima')
+    struct SessaoServidor* proxima;
+} SessaoServidor;
+
+typedef struct Servidor {
+    MansaoCompacta mansao;
+    IndicePistas indice;
+    IndiceNomes nomes;
+    TabelaHash* tabela;
+    int32_t* pistaNova;         // Por sala: a pista, se é a 1ª do caminho desde a entrada; SEM_SIMBOLO se não
+    int64_t limiar;
+    int epoll;
+    int reserva;                // Descritor guardado para recusar conexões no limite (EMFILE)
+    Pool pool;
+    SessaoServidor* ativas;
+    SessaoServidor* livres;
+    size_t quantidadeAtivas, maiorAtivas, conexoes, comandos;
+    HistogramaLatencia latencia;
+} Servidor;
 
 // ============================================================================
 // PROTÓTIPOS DAS FUNÇÕES
@@ -50,119 +817,574 @@ typedef struct HashNode {
 // criarSala() – cria dinamicamente um cômodo.
 Sala* criarSala(char* nome, char* pista);
 
-// inserirPista() – insere a pista coletada na árvore de pistas.
-PistaNode* inserirPista(PistaNode* raiz, char* conteudo);
+// inserirPista() – insere a pista coletada (id) na árvore de pistas.
+PistaNode* inserirPista(PistaNode* raiz, int conteudo);
 
 // explorarSalas() – navega pela árvore e ativa o sistema de pistas.
-void explorarSalas(Sala* mapa, PistaNode** raizPistas);
+void explorarSalas(Sala* mapa, Inventario* inventario, TabelaHash* tabela);
 
 // inserirNaHash() – insere associação pista/suspeito na tabela hash.
-void inserirNaHash(HashNode* tabela[], char* pista, char* suspeito);
+void inserirNaHash(TabelaHash* tabela, char* pista, char* suspeito);
+void inserirNaHashIds(TabelaHash* tabela, int pista, int suspeito);
 
 // encontrarSuspeito() – consulta o suspeito correspondente a uma pista.
-char* encontrarSuspeito(HashNode* tabela[], char* pista);
+const char* encontrarSuspeito(TabelaHash* tabela, char* pista);
+int encontrarSuspeitoId(TabelaHash* tabela, int pista);
 
 // verificarSuspeitoFinal() – conduz à fase de julgamento final.
-void verificarSuspeitoFinal(PistaNode* raizPistas, HashNode* tabela[], char* suspeitoAcusado);
+void verificarSuspeitoFinal(const int64_t* pontos, TabelaHash* tabela, const char* suspeitoAcusado, int64_t limiar);
+
+// Funções do Inventário (placar incremental de evidências, com os pesos)
+void iniciarInventario(Inventario* inventario, const IndicePistas* indice);
+int coletarPista(Inventario* inventario, int pista);
+int64_t evidenciasContra(Inventario* inventario, TabelaHash* tabela, const char* suspeito);
+static int64_t pontosSuspeito(const Inventario* inventario, int suspeito);
+void liberarInventario(Inventario* inventario);
+
+// Funções do Conjunto de Pistas (mapa de bits) e das máscaras por suspeito
+void iniciarConjunto(ConjuntoPistas* conjunto);
+int marcarPista(ConjuntoPistas* conjunto, int pista);
+int contemPista(const ConjuntoPistas* conjunto, int pista);
+size_t contarConjunto(const ConjuntoPistas* conjunto);
+void combinarConjuntos(ConjuntoPistas* destino, const ConjuntoPistas* a, const ConjuntoPistas* b,
+                       OperacaoConjunto operacao);
+void liberarConjunto(ConjuntoPistas* conjunto);
+void prepararMascaras(MascarasSuspeitos* mascaras, TabelaHash* tabela);
+size_t provasNoConjunto(const ConjuntoPistas* coletadas, const MascarasSuspeitos* mascaras, int suspeito);
+size_t pistasFaltando(const ConjuntoPistas* coletadas, const MascarasSuspeitos* mascaras, int suspeito);
+void liberarMascaras(MascarasSuspeitos* mascaras);
+
+// Funções do Índice Invertido (pontuação ponderada e ranking)
+void construirIndice(IndicePistas* indice, Caso* caso);
+size_t melhoresSuspeitos(const int64_t* pontos, size_t quantidade, size_t k, int* saida);
+void liberarIndice(IndicePistas* indice);
+
+// Funções do Índice de Nomes (acusação e sugestões)
+size_t normalizarNome(const char* nome, char* destino, size_t limite);
+void construirIndiceNomes(IndiceNomes* indice, TabelaHash* tabela);
+size_t faixaDoPrefixo(const IndiceNomes* indice, const char* prefixo, size_t tamanho, size_t* primeiro);
+int resolverSuspeito(const IndiceNomes* indice, TabelaHash* tabela, const char* entrada,
+                     size_t* primeiro, size_t* quantidade);
+void listarSugestoes(const IndiceNomes* indice, TabelaHash* tabela, size_t primeiro, size_t quantidade);
+void liberarIndiceNomes(IndiceNomes* indice);
 
 // Funções auxiliares
+static PistaNode* proximoEmOrdem(PistaNode** cursor);
 void exibirPistas(PistaNode* raiz);
-void liberarMapa(Sala* raiz);
-void liberarPistas(PistaNode* raiz);
-void liberarHash(HashNode* tabela[]);
-int contarPistasSuspeito(PistaNode* raiz, HashNode* tabela[], char* suspeitoAlvo);
+int contarPistasSuspeito(PistaNode* raiz, TabelaHash* tabela, char* suspeitoAlvo);
+int indiceDoSuspeito(TabelaHash* tabela, int suspeito);
+uint64_t funcaoHash(const char* chave);
+void* realocarOuSair(void* ptr, size_t bytes);
+void* alocarZeradoOuSair(size_t quantidade, size_t tamanho);
+void iniciarHash(TabelaHash* tabela);
+int usarGabaritoFixo(TabelaHash* tabela, const GabaritoFixo* gabarito);
+void reservarHash(TabelaHash* tabela, size_t quantidade);
+void liberarHash(TabelaHash* tabela);
+
+// Funções de Texto Vetorizadas (só o hash, com escolha da CPU)
+typedef enum { SIMD_ESCALAR, SIMD_SSE2, SIMD_AVX2 } NivelSimd;
+NivelSimd detectarSimd(void);
+NivelSimd escolherSimd(NivelSimd nivel);
+uint64_t hashTexto(const char* texto, size_t tamanho);
+
+// Funções da Tabela de Símbolos
+int internar(const char* texto);
+int internarExterno(const char* texto);
+void reservarSimbolos(size_t quantidade);
+int buscarSimbolo(const char* texto);
+const char* textoSimbolo(int id);
+void liberarSimbolos(void);
+
+// Funções do Renderizador de Saída
+void escrever(const char* formato, ...);
+void escreverTexto(const char* texto);
+void decorar(const char* formato, ...);
+void descarregarSaida(void);
+
+// Funções da Arena do Caso
+void arenaIniciar(ArenaCaso* arena);
+void poolIniciar(Pool* pool, size_t tamanhoNo);
+void* poolAlocar(Pool* pool);
+void poolResetar(Pool* pool);
+void poolDestruir(Pool* pool);
+void arenaResetar(ArenaCaso* arena);
+void arenaDestruir(ArenaCaso* arena);
+void arenaRelatorio(ArenaCaso* arena);
+
+// Arena de onde criarSala e inserirPista tiram seus nós.
+ArenaCaso arenaCaso;
+
+// Textos do caso: nomes de cômodos, pistas e suspeitos.
+TabelaSimbolos simbolos;
+
+// Saída do jogo (explorarSalas, relatório e julgamento).
+Renderizador saida;
+
+// Rotas pré-calculadas do caso em jogo (consultadas por explorarSalas).
+Perito perito;
+
+// Caminho da partida atual desde a entrada (para gravar a sessão).
+Trajeto trajeto;
+
+// Diário da partida atual (--diario/--recuperar; inativo sem eles).
+Diario diario;
+
+// Pedidos de memória ao sistema feitos pelas estruturas (realocarOuSair e
+// alocarZeradoOuSair: vetores, blocos dos pools, slots da tabela). Usado
+// pelos benchmarks (aloc/op).
+atomic_size_t alocacoesSistema;
+
+// Funções dos Casos (mansão padrão e arquivos)
+void montarCasoPadrao(Caso* caso);
+void montarGabaritoDinamico(TabelaHash* tabela);
+int gerarGabaritoFixo(const ParGabarito* pares, size_t n, const char* const* elenco, size_t k);
+int executarGeradorGabarito(Caso* caso);
+int carregarCaso(Caso* caso, const char* arquivo);
+int carregarCasoTexto(Caso* caso, const char* arquivo);
+int carregarCasoBinario(Caso* caso, const char* arquivo);
+int compilarCaso(Caso* caso, const char* destino);
+int64_t limiarDoCaso(const Caso* caso);
+void liberarCaso(Caso* caso);
+
+// Funções da Mansão Compacta (mesmas operações de navegação da Sala)
+int compactarMansao(Sala* raiz, size_t quantidade, MansaoCompacta* compacta);
+static inline uint32_t compactaEsquerda(const MansaoCompacta* m, uint32_t sala);
+static inline uint32_t compactaDireita(const MansaoCompacta* m, uint32_t sala);
+static inline int compactaEhFolha(const MansaoCompacta* m, uint32_t sala);
+void liberarMansaoCompacta(MansaoCompacta* compacta);
+
+// Funções do Mapa da Mansão (grafo, rotas e exploração)
+int construirMapa(MapaSalas* mapa, Caso* caso);
+void iniciarBusca(BuscaMapa* busca, size_t quantidade);
+uint32_t buscarRota(const MapaSalas* mapa, BuscaMapa* busca, uint32_t origem, uint32_t destino, int nomeDestino);
+void explorarMapa(MapaSalas* mapa, Inventario* inventario);
+void liberarBusca(BuscaMapa* busca);
+void liberarMapaSalas(MapaSalas* mapa);
+
+// Funções do Perito
+int prepararPerito(Perito* perito, Caso* caso, const IndicePistas* indice);
+int64_t evidenciasAlcancaveis(const Perito* perito, uint32_t sala, int suspeito);
+size_t rotaDoPerito(const Perito* perito, uint32_t sala, int suspeito, char* destino, size_t limite);
+void liberarPerito(Perito* perito);
+int executarPerito(Caso* caso);
+
+// Funções da Sessão Gravada
+uint64_t impressaoDoCaso(TabelaHash* tabela);
+void registrarMovimento(char movimento);
+int gravarSessao(const char* destino, Inventario* inventario, TabelaHash* tabela);
+int carregarSessao(const char* arquivo, Caso* caso, Inventario* inventario,
+                   Sala** salaAtual, SessaoCarregada* carregada);
+void liberarSessaoCarregada(SessaoCarregada* carregada);
+
+// Funções do Diário de Movimentos
+int abrirDiario(Diario* diario, const char* arquivo, TabelaHash* tabela);
+int recuperarDiario(Diario* diario, const char* arquivo, Caso* caso, Inventario* inventario, Sala** salaAtual);
+void anotarDiario(Diario* diario, char tipo, int32_t pista);
+int confirmarDiario(Diario* diario, int sincronizar);
+void fecharDiario(Diario* diario);
+
+// Funções do Modo Lote
+void iniciarRepetidor(Repetidor* repetidor, const MansaoCompacta* mansao,
+                      const IndicePistas* indice, TabelaHash* tabela);
+void repetirSessao(Repetidor* repetidor, const char* movimentos, size_t tamanho,
+                   ResultadoSessao* resultado);
+int64_t placarDaSessao(Repetidor* repetidor, int suspeito);
+void liberarRepetidor(Repetidor* repetidor);
+int executarLote(Caso* caso, const char* arquivo);
+
+// Funções do Simulador de Sessões
+void* simularSessoes(void* argumento);
+int executarSimulacao(Caso* caso, const char* sessoes, int threads);
+
+// Funções da Tabela Concorrente
+void iniciarTabelaConcorrente(TabelaConcorrente* tabela, size_t quantidade);
+int registrarParticipante(TabelaConcorrente* tabela);
+void inserirConcorrente(TabelaConcorrente* tabela, int participante, int pista, int suspeito);
+int buscarConcorrente(TabelaConcorrente* tabela, int participante, int pista);
+size_t quantidadeConcorrente(TabelaConcorrente* tabela);
+void copiarTabelaConcorrente(TabelaHash* destino, TabelaConcorrente* tabela);
+void liberarTabelaConcorrente(TabelaConcorrente* tabela);
+
+// Funções do Servidor de Sessões
+int executarServidor(Caso* caso, const char* caminho);
+
+// Funções do Gerador de Casos
+void parametrosPadrao(ParametrosCaso* parametros);
+int lerParametrosCaso(ParametrosCaso* parametros, int argc, char* argv[]);
+int gerarCaso(const char* destino, const ParametrosCaso* parametros);
+
+// Tempo e sorteio (também usados pelas medições em Ultimo_Caso_Benchmarks.c)
+double agoraSegundos(void);
+uint64_t aleatorio(uint64_t* estado);
+void gerarPistaSintetica(char* destino, size_t indice);
+
+#ifdef ESTATISTICAS
+// Estatísticas (só com -DESTATISTICAS)
+void iniciarEstatisticas(int argc, char** argv);
+void iniciarFase(FaseJogo fase);
+void encerrarFase(FaseJogo fase);
+void escreverEstatisticas(void);
+#endif
 
 // ============================================================================
 // FUNÇÃO PRINCIPAL
 // ============================================================================
 
-int main() {
-    // 1. Construção do Mapa da Mansão (Árvore Binária Fixa)
-    Sala* mansao = criarSala("Hall de Entrada", "Pegadas de lama no chão");
-    
-    mansao->esquerda = criarSala("Sala de Estar", "Relógio parado às 10h");
-    mansao->direita = criarSala("Cozinha", ""); // Cozinha sem pista
-    
-    mansao->esquerda->esquerda = criarSala("Biblioteca", "Livro de venenos aberto");
-    mansao->esquerda->direita = criarSala("Jardim de Inverno", "Terra revirada recente");
-    
-    mansao->direita->esquerda = criarSala("Sala de Jantar", "Taça de vinho quebrada");
-    mansao->direita->direita = criarSala("Porão", "Chave enferrujada antiga");
+// Ultimo_Caso_Benchmarks.c inclui este arquivo com a sua própria main.
+#ifndef ULTIMO_CASO_SEM_MAIN
+int main(int argc, char* argv[]) {
+    INICIAR_ESTATISTICAS(argc, argv); // Sem -DESTATISTICAS, nada
+    arenaIniciar(&arenaCaso);
+    escolherSimd(detectarSimd());
 
-    // 2. Inicialização da Árvore de Pistas (Inventário vazio)
-    PistaNode* inventarioPistas = NULL;
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) {
+        Caso caso;
+        if (argc < 3) {
+            printf("Uso: --lote <sessoes|-> [caso]\n");
+            return 1;
+        }
+        int ok = (argc >= 4) ? carregarCaso(&caso, argv[3]) : (montarCasoPadrao(&caso), 1);
+        INICIAR_FASE(FASE_REPETICAO);
+        ok = ok && executarLote(&caso, argv[2]);
+        ENCERRAR_FASE(FASE_REPETICAO);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
 
-    // 3. Inicialização e Configuração da Tabela Hash
-    HashNode* tabelaSuspeitos[TAM_HASH] = {NULL};
-    
-    // Configuração das pistas e suspeitos (Gabarito do Jogo)
-    // Jardineiro
-    inserirNaHash(tabelaSuspeitos, "Pegadas de lama no chão", "Jardineiro");
-    inserirNaHash(tabelaSuspeitos, "Terra revirada recente", "Jardineiro");
-    // Mordomo
-    inserirNaHash(tabelaSuspeitos, "Relógio parado às 10h", "Mordomo");
-    inserirNaHash(tabelaSuspeitos, "Taça de vinho quebrada", "Mordomo");
-    // Governanta
-    inserirNaHash(tabelaSuspeitos, "Livro de venenos aberto", "Governanta");
-    inserirNaHash(tabelaSuspeitos, "Chave enferrujada antiga", "Governanta");
-
-    printf("=========================================\n");
-    printf("      DETECTIVE QUEST: O ÚLTIMO CASO     \n");
-    printf("=========================================\n");
-    printf("Você entrou na mansão. Explore os cômodos e colete evidências.\n");
-
-    // 4. Início da Exploração
-    explorarSalas(mansao, &inventarioPistas);
-
-    // 5. Relatório Final
-    printf("\n=========================================\n");
-    printf("      RELATÓRIO FINAL DO DETETIVE        \n");
-    printf("=========================================\n");
-    printf("Pistas coletadas (Ordem Alfabética):\n\n");
+    if (argc >= 2 && strcmp(argv[1], "--perito") == 0) {
+        Caso caso;
+        int ok = (argc >= 3) ? carregarCaso(&caso, argv[2]) : (montarCasoPadrao(&caso), 1);
+        ok = ok && executarPerito(&caso);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--simular") == 0) {
+        Caso caso;
+        if (argc < 3) {
+            printf("Uso: --simular <n|sessoes> [threads] [caso]\n");
+            return 1;
+        }
+        int threads = (argc >= 4) ? atoi(argv[3]) : 0;
+        int ok = (argc >= 5) ? carregarCaso(&caso, argv[4]) : (montarCasoPadrao(&caso), 1);
+        INICIAR_FASE(FASE_REPETICAO);
+        ok = ok && executarSimulacao(&caso, argv[2], threads);
+        ENCERRAR_FASE(FASE_REPETICAO);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--gerar-gabarito") == 0) {
+        Caso caso;
+        int ok = (argc >= 3) ? carregarCaso(&caso, argv[2]) : 1;
+        ok = ok && executarGeradorGabarito((argc >= 3) ? &caso : NULL);
+        liberarSimbolos();
+        if (argc >= 3) liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--compilar") == 0) {
+        Caso caso;
+        if (argc < 4) {
+            printf("Uso: --compilar <caso.txt> <caso.dqc>\n");
+            return 1;
+        }
+        int ok = carregarCasoTexto(&caso, argv[2]) && compilarCaso(&caso, argv[3]);
+        if (ok) printf("Caso compilado: %zu salas -> %s\n", caso.quantidadeSalas, argv[3]);
+        liberarCaso(&caso);
+        liberarSimbolos();
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--gerar-caso") == 0) {
+        ParametrosCaso parametros;
+        if (argc < 3) {
+            printf("Uso: --gerar-caso <caso.txt> [salas=n forma=completa|aleatoria inclinacao=%% densidade=%%\n"
+                   "                  suspeitos=k colisao=bits implica=%% portas=n semente=n]\n");
+            return 1;
+        }
+        parametrosPadrao(&parametros);
+        int ok = lerParametrosCaso(&parametros, argc - 3, argv + 3) && gerarCaso(argv[2], &parametros);
+        if (ok) printf("Caso gerado: %zu salas -> %s\n", parametros.salas, argv[2]);
+        liberarSimbolos();
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--servidor") == 0) {
+        Caso caso;
+        if (argc < 3) {
+            printf("Uso: --servidor <socket> [caso]\n");
+            return 1;
+        }
+        int ok = (argc >= 4) ? carregarCaso(&caso, argv[3]) : (montarCasoPadrao(&caso), 1);
+        ok = ok && executarServidor(&caso, argv[2]);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return ok ? 0 : 1;
+    }
+
+    const char* arquivoSessao = NULL;
+    const char* arquivoDiario = NULL;
+    int modoMapa = 0, recuperar = 0;
+    for (int trocou = 1; trocou && argc >= 2;) {
+        trocou = 0;
+        if (strcmp(argv[1], "-q") == 0 || strcmp(argv[1], "--mapa") == 0) {
+            if (argv[1][1] == 'q') saida.silencioso = 1;
+            else modoMapa = 1;
+            argc--;
+            argv++;
+            trocou = 1;
+        } else if (argc >= 3 && strcmp(argv[1], "--continuar") == 0) {
+            arquivoSessao = argv[2];
+            argc -= 2;
+            argv += 2;
+            trocou = 1;
+        } else if (argc >= 3 && (strcmp(argv[1], "--diario") == 0 || strcmp(argv[1], "--recuperar") == 0)) {
+            recuperar = (argv[1][2] == 'r');
+            arquivoDiario = argv[2];
+            argc -= 2;
+            argv += 2;
+            trocou = 1;
+        }
+    }
+    if (arquivoDiario != NULL && (modoMapa || arquivoSessao != NULL)) {
+        printf("Erro: o diário segue a árvore desde a entrada; não vale com --mapa nem --continuar.\n");
+        return 1;
+    }
+    if (modoMapa && arquivoSessao != NULL) {
+        printf("Erro: sessões gravadas seguem a árvore; --continuar não vale com --mapa.\n");
+        return 1;
+    }
+    atexit(descarregarSaida); // Inclusive nas saídas por erro crítico
+
+    // 1. Construção do Mapa da Mansão e do Gabarito (fixos ou lidos de arquivo)
+    Caso caso;
+    if (argc >= 2) {
+        if (!carregarCaso(&caso, argv[1])) {
+            liberarSimbolos();
+            liberarCaso(&caso);
+            arenaDestruir(&arenaCaso);
+            return 1;
+        }
+    } else {
+        montarCasoPadrao(&caso);
+    }
+    TabelaHash* tabelaSuspeitos = &caso.tabela;
+
+    // 2. Inicialização do Inventário (Árvore de Pistas vazia e placar zerado,
+    //    ou os da sessão gravada). O placar soma os pesos do índice invertido
+    //    a cada pista nova
+    Inventario inventario;
+    IndicePistas indice;
+    Sala* salaInicial = caso.mansao;
+    SessaoCarregada sessaoCarregada = {0};
+    construirIndice(&indice, &caso);
+    iniciarInventario(&inventario, &indice);
+    if (arquivoSessao != NULL &&
+        !carregarSessao(arquivoSessao, &caso, &inventario, &salaInicial, &sessaoCarregada)) {
+        liberarInventario(&inventario);
+        liberarIndice(&indice);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return 1;
+    }
+
+    // 2b. Diário de movimentos: novo, ou refeito até o último lote inteiro
+    double inicioDiario = agoraSegundos();
+    if (arquivoDiario != NULL &&
+        !(recuperar ? recuperarDiario(&diario, arquivoDiario, &caso, &inventario, &salaInicial)
+                    : abrirDiario(&diario, arquivoDiario, tabelaSuspeitos))) {
+        liberarInventario(&inventario);
+        liberarIndice(&indice);
+        free(trajeto.movimentos);
+        liberarSimbolos();
+        liberarCaso(&caso);
+        arenaDestruir(&arenaCaso);
+        return 1;
+    }
+    if (recuperar) {
+        escrever(saida.silencioso ? "recuperado\t%zu\t%zu\t%zu\n"
+                                  : "[Diário] %zu movimento(s) e %zu pista(s) refeitos (%zu byte(s) "
+                                    "incompletos descartados) em %.1f ms.\n",
+                 diario.movimentos, diario.pistas, diario.descartados, (agoraSegundos() - inicioDiario) * 1e3);
+    }
+
+    decorar("=========================================\n"
+            "      DETECTIVE QUEST: O ÚLTIMO CASO     \n"
+            "=========================================\n"
+            "Você entrou na mansão. Explore os cômodos e colete evidências.\n");
+
+    if (modoMapa) {
+        // 3-4. Exploração pelo grafo de portas (volta permitida, rotas com [r])
+        MapaSalas mapa;
+        INICIAR_FASE(FASE_MAPA);
+        int montado = construirMapa(&mapa, &caso);
+        ENCERRAR_FASE(FASE_MAPA);
+        INICIAR_FASE(FASE_EXPLORACAO);
+        if (montado) explorarMapa(&mapa, &inventario);
+        ENCERRAR_FASE(FASE_EXPLORACAO);
+        liberarMapaSalas(&mapa);
+    } else {
+        // 3. Rotas do perito (uma passada pela mansão; sem elas, não há opção [p])
+        INICIAR_FASE(FASE_MAPA);
+        prepararPerito(&perito, &caso, &indice);
+        ENCERRAR_FASE(FASE_MAPA);
+
+        // 4. Início da Exploração
+        INICIAR_FASE(FASE_EXPLORACAO);
+        explorarSalas(salaInicial, &inventario, tabelaSuspeitos);
+        ENCERRAR_FASE(FASE_EXPLORACAO);
+        liberarPerito(&perito);
+    }
+
+    // 5. Relatório Final (montado inteiro no buffer, sai num write só).
+    //    Os pontos já estão no placar do inventário
+    INICIAR_FASE(FASE_VEREDITO);
+    const int64_t* pontos = inventario.placar;
+
+    decorar("\n=========================================\n"
+            "      RELATÓRIO FINAL DO DETETIVE        \n"
+            "=========================================\n"
+            "Pistas coletadas (Ordem Alfabética):\n\n");
     
-    if (inventarioPistas == NULL) {
-        printf("- Nenhuma pista foi coletada.\n");
+    if (inventario.raiz == NULL) {
+        decorar("- Nenhuma pista foi coletada.\n");
     } else {
-        exibirPistas(inventarioPistas);
+        exibirPistas(inventario.raiz);
+
+        // Só os RANKING_EXIBIDO primeiros, por um heap (sem ordenar o elenco).
+        // O que ficou para trás sai das máscaras: popcount(gabarito & ~coletadas)
+        MascarasSuspeitos mascaras;
+        prepararMascaras(&mascaras, tabelaSuspeitos);
+        int ordem[RANKING_EXIBIDO];
+        size_t total = melhoresSuspeitos(pontos, tabelaSuspeitos->quantidadeSuspeitos, RANKING_EXIBIDO, ordem);
+        decorar("\nPlacar de evidências:\n");
+        for (size_t i = 0; i < total; i++) {
+            const char* nome = textoSimbolo(tabelaSuspeitos->suspeitos[ordem[i]]);
+            size_t faltando = pistasFaltando(&inventario.coletadas, &mascaras, ordem[i]);
+            escrever(saida.silencioso ? "placar\t%lld\t%s\n" : "  %lld ponto(s) -> %s",
+                     (long long)pontos[ordem[i]], nome);
+            if (saida.silencioso) escrever("faltam\t%zu\t%s\n", faltando, nome);
+            else escrever(" (%zu pista(s) do caso não encontrada(s))\n", faltando);
+        }
+        if (total < tabelaSuspeitos->quantidadeSuspeitos) {
+            decorar("  ... e mais %zu suspeito(s).\n", tabelaSuspeitos->quantidadeSuspeitos - total);
+        }
+        liberarMascaras(&mascaras);
+        if (total > 0 && pontos[ordem[0]] > 0) {
+            escrever(saida.silencioso ? "mais_citado\t%s\n" : "Suspeito mais citado: %s\n",
+                     textoSimbolo(tabelaSuspeitos->suspeitos[ordem[0]]));
+        }
     }
-    printf("=========================================\n");
+    decorar("=========================================\n");
 
-    // 6. Fase de Acusação
-    char acusado[50];
-    printf("\nQuem é o culpado? (Jardineiro / Mordomo / Governanta): ");
-    scanf(" %[^\n]s", acusado); // Lê string com espaços
+    // 6. Fase de Acusação: aceita o começo do nome, sem caixa nem acento;
+    //    se servir a mais de um suspeito, mostra as sugestões e pergunta de novo
+    char acusado[TAM_NOME_ACUSADO] = "";
+    const char* nomeAcusado = acusado;
+    IndiceNomes nomes;
+    construirIndiceNomes(&nomes, tabelaSuspeitos);
+    size_t listados = tabelaSuspeitos->quantidadeSuspeitos;
+    if (!saida.silencioso && listados > NOMES_SUGERIDOS) listados = NOMES_SUGERIDOS;
+    escreverTexto(saida.silencioso ? "acusar" : "\nQuem é o culpado? (");
+    for (size_t i = 0; i < listados; i++) {
+        escreverTexto(saida.silencioso ? "\t" : (i > 0) ? " / " : "");
+        escreverTexto(textoSimbolo(tabelaSuspeitos->suspeitos[i]));
+    }
+    if (listados < tabelaSuspeitos->quantidadeSuspeitos) {
+        escrever(" / ... e mais %zu; basta o começo do nome", tabelaSuspeitos->quantidadeSuspeitos - listados);
+    }
+    escreverTexto(saida.silencioso ? "\n" : "): ");
+    for (;;) {
+        size_t primeiro, quantidade;
+        descarregarSaida();
+        if (scanf(" %255[^\n]", acusado) != 1) break; // Lê string com espaços
+        int suspeito = resolverSuspeito(&nomes, tabelaSuspeitos, acusado, &primeiro, &quantidade);
+        if (suspeito >= 0) {
+            nomeAcusado = textoSimbolo(tabelaSuspeitos->suspeitos[suspeito]);
+            break;
+        }
+        if (quantidade < 2) break; // Ninguém com esse nome: o julgamento segue sem provas
+        listarSugestoes(&nomes, tabelaSuspeitos, primeiro, quantidade);
+    }
 
-    verificarSuspeitoFinal(inventarioPistas, tabelaSuspeitos, acusado);
+    verificarSuspeitoFinal(pontos, tabelaSuspeitos, nomeAcusado, limiarDoCaso(&caso));
+    ENCERRAR_FASE(FASE_VEREDITO);
+    if (arquivoDiario != NULL) {
+        fecharDiario(&diario);
+        unlink(arquivoDiario); // Partida julgada: nada mais a recuperar
+    }
+    descarregarSaida();
+    liberarIndiceNomes(&nomes);
 
     // 7. Limpeza de Memória
-    liberarMapa(mansao);
-    liberarPistas(inventarioPistas);
-    liberarHash(tabelaSuspeitos);
-    printf("\nMemória liberada. Caso encerrado.\n");
+    // Mapa e pistas vivem na arena: destruí-la descarta tudo de uma vez.
+#ifdef ESTATISTICAS
+    if (!saida.silencioso) arenaRelatorio(&arenaCaso);
+#endif
+    arenaDestruir(&arenaCaso);
+    liberarInventario(&inventario);
+    liberarIndice(&indice);
+    liberarSessaoCarregada(&sessaoCarregada);
+    free(trajeto.movimentos);
+    liberarSimbolos(); // Antes do caso: textos podem apontar para o arquivo mapeado
+    liberarCaso(&caso);
+    decorar("\nMemória liberada. Caso encerrado.\n");
 
     return 0;
 }
+#endif
 
 // ============================================================================
 // IMPLEMENTAÇÃO DAS FUNÇÕES
 // ============================================================================
 
+// --- Tempo e sorteio (perito, simulador, gerador, servidor, diário) ---
+
+double agoraSegundos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Gerador xorshift64: determinístico para que as rodadas sejam comparáveis.
+uint64_t aleatorio(uint64_t* estado) {
+    uint64_t x = *estado;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *estado = x;
+}
+
+// Pista sintética com o mesmo formato/tamanho das pistas do jogo.
+// O índice tem largura fixa: a ordem alfabética coincide com a numérica.
+void gerarPistaSintetica(char* destino, size_t indice) {
+    sprintf(destino, "Pista %09zu encontrada no comodo", indice);
+}
+
 /*
  * criarSala() – cria dinamicamente um cômodo.
- * Aloca memória para uma nova sala, define seu nome e a pista associada.
+ * Tira uma nova sala do pool da arena, define seu nome e a pista associada.
  */
 Sala* criarSala(char* nome, char* pista) {
-    Sala* nova = (Sala*)malloc(sizeof(Sala));
-    if (nova == NULL) {
-        printf("Erro crítico: Falha na alocação de memória.\n");
-        exit(1);
-    }
-    strcpy(nova->nome, nome);
+    Sala* nova = (Sala*)poolAlocar(&arenaCaso.salas);
+    nova->nome = internar(nome);
     
-    if (pista != NULL) {
-        strcpy(nova->pista, pista);
+    if (pista != NULL && pista[0] != '\0') {
+        nova->pista = internar(pista);
     } else {
-        nova->pista[0] = '\0';
+        nova->pista = SEM_SIMBOLO;
     }
     
     nova->esquerda = NULL;
@@ -170,202 +1392,4657 @@ Sala* criarSala(char* nome, char* pista) {
     return nova;
 }
 
+// --- Funções da Árvore de Pistas (AVL) ---
+
+static int alturaPista(PistaNode* no) {
+    return (no != NULL) ? no->altura : 0;
+}
+
+static void atualizarAltura(PistaNode* no) {
+    int alturaEsq = alturaPista(no->esquerda);
+    int alturaDir = alturaPista(no->direita);
+    no->altura = 1 + (alturaEsq > alturaDir ? alturaEsq : alturaDir);
+}
+
+static PistaNode* rotacionarDireita(PistaNode* no) {
+    PistaNode* filho = no->esquerda;
+    no->esquerda = filho->direita;
+    filho->direita = no;
+    atualizarAltura(no);
+    atualizarAltura(filho);
+    ESTATISTICA_SOMAR(rotacoesPistas, 1);
+    return filho;
+}
+
+static PistaNode* rotacionarEsquerda(PistaNode* no) {
+    PistaNode* filho = no->direita;
+    no->direita = filho->esquerda;
+    filho->esquerda = no;
+    atualizarAltura(no);
+    atualizarAltura(filho);
+    ESTATISTICA_SOMAR(rotacoesPistas, 1);
+    return filho;
+}
+
+// Recalcula a altura do nó e aplica a rotação simples ou dupla necessária.
+static PistaNode* balancearPista(PistaNode* no) {
+    atualizarAltura(no);
+    int fator = alturaPista(no->esquerda) - alturaPista(no->direita);
+
+    if (fator > 1) {
+        if (alturaPista(no->esquerda->esquerda) < alturaPista(no->esquerda->direita)) {
+            no->esquerda = rotacionarEsquerda(no->esquerda);
+        }
+        return rotacionarDireita(no);
+    }
+    if (fator < -1) {
+        if (alturaPista(no->direita->direita) < alturaPista(no->direita->esquerda)) {
+            no->direita = rotacionarDireita(no->direita);
+        }
+        return rotacionarEsquerda(no);
+    }
+    return no;
+}
+
 /*
  * inserirPista() – insere a pista coletada na árvore de pistas.
- * Utiliza a lógica de BST (Binary Search Tree) para manter as pistas
- * ordenadas alfabeticamente.
+ * Mantém as pistas em ordem alfabética e a árvore balanceada (AVL), de modo
+ * que pistas chegando já ordenadas não transformam a árvore numa lista.
+ * A descida é iterativa: guarda os ponteiros percorridos e, na volta,
+ * rebalanceia até encontrar uma subárvore cuja altura não mudou.
+ * Repetição é detectada pelo id; o texto só é comparado para decidir o lado.
+ * Se 'inserida' não for NULL, recebe 1 quando a pista era nova.
  */
-PistaNode* inserirPista(PistaNode* raiz, char* conteudo) {
-    if (raiz == NULL) {
-        PistaNode* novo = (PistaNode*)malloc(sizeof(PistaNode));
-        if (novo) {
-            strcpy(novo->conteudo, conteudo);
-            novo->esquerda = NULL;
-            novo->direita = NULL;
-        }
-        return novo;
+static PistaNode* inserirPistaAvl(PistaNode* raiz, int conteudo, int* inserida) {
+    PistaNode** caminho[ALTURA_MAXIMA_AVL];
+    int profundidade = 0;
+    PistaNode** ligacao = &raiz;
+    const char* texto = textoSimbolo(conteudo);
+
+    if (inserida != NULL) *inserida = 0;
+    while (*ligacao != NULL) {
+        if (conteudo == (*ligacao)->conteudo) return raiz; // Pista repetida: não duplica
+        int cmp = strcmp(texto, textoSimbolo((*ligacao)->conteudo));
+
+        caminho[profundidade++] = ligacao;
+        ligacao = (cmp < 0) ? &(*ligacao)->esquerda : &(*ligacao)->direita;
     }
 
-    int cmp = strcmp(conteudo, raiz->conteudo);
+    ESTATISTICA_SOMAR(insercoesPistas, 1);
+    ESTATISTICA_MAIOR(profundidadePistas, (size_t)profundidade + 1);
+    PistaNode* novo = (PistaNode*)poolAlocar(&arenaCaso.pistas);
+    novo->conteudo = conteudo;
+    novo->altura = 1;
+    novo->esquerda = NULL;
+    novo->direita = NULL;
+    *ligacao = novo;
+    if (inserida != NULL) *inserida = 1;
 
-    if (cmp < 0) {
-        raiz->esquerda = inserirPista(raiz->esquerda, conteudo);
-    } else if (cmp > 0) {
-        raiz->direita = inserirPista(raiz->direita, conteudo);
+    while (profundidade > 0) {
+        PistaNode** atual = caminho[--profundidade];
+        int alturaAnterior = (*atual)->altura;
+
+        *atual = balancearPista(*atual);
+        if ((*atual)->altura == alturaAnterior) break; // Ancestrais não mudam
     }
     return raiz;
 }
 
+PistaNode* inserirPista(PistaNode* raiz, int conteudo) {
+    return inserirPistaAvl(raiz, conteudo, NULL);
+}
+
 /*
  * explorarSalas() – navega pela árvore e ativa o sistema de pistas.
  * Permite ao usuário escolher caminhos (esquerda/direita) e coleta pistas automaticamente.
  */
-void explorarSalas(Sala* salaAtual, PistaNode** raizPistas) {
+void explorarSalas(Sala* salaAtual, Inventario* inventario, TabelaHash* tabela) {
     char opcao;
+    int silencioso = saida.silencioso;
+    uint32_t indice = 0; // Mesma sala na mansão compacta do perito
+
+    // Sessão retomada: a sala atual é o fim do trajeto gravado
+    for (size_t i = 0; perito.pronto && i < trajeto.passos; i++) {
+        indice = (trajeto.movimentos[i] == 'e') ? compactaEsquerda(&perito.mansao, indice)
+                                                : compactaDireita(&perito.mansao, indice);
+    }
     
     while (salaAtual != NULL) {
-        printf("\n-----------------------------------------\n");
-        printf("LOCAL ATUAL: %s\n", salaAtual->nome);
+        decorar("\n-----------------------------------------\n");
+        escrever(silencioso ? "sala\t%s\n" : "LOCAL ATUAL: %s\n", textoSimbolo(salaAtual->nome));
         
         // Coleta de Pista
-        if (strlen(salaAtual->pista) > 0) {
-            printf("[!] Pista encontrada: \"%s\"\n", salaAtual->pista);
-            printf("    -> Adicionando ao caderno de anotações...\n");
-            *raizPistas = inserirPista(*raizPistas, salaAtual->pista);
+        if (salaAtual->pista != SEM_SIMBOLO) {
+            escrever(silencioso ? "pista\t%s\n" : "[!] Pista encontrada: \"%s\"\n",
+                     textoSimbolo(salaAtual->pista));
+            decorar("    -> Adicionando ao caderno de anotações...\n");
+            if (coletarPista(inventario, salaAtual->pista)) anotarDiario(&diario, 'p', salaAtual->pista);
         } else {
-            printf("(Nenhuma pista visível neste cômodo)\n");
+            decorar("(Nenhuma pista visível neste cômodo)\n");
         }
-        printf("-----------------------------------------\n");
+        decorar("-----------------------------------------\n");
 
         if (salaAtual->esquerda == NULL && salaAtual->direita == NULL) {
-            printf("Este cômodo não tem mais saídas. Fim da linha para este caminho.\n");
+            escreverTexto(silencioso ? "fim\tsem_saida\n"
+                                     : "Este cômodo não tem mais saídas. Fim da linha para este caminho.\n");
             break; 
         }
 
-        printf("Para onde deseja ir?\n");
-        if (salaAtual->esquerda) 
-            printf(" [e] Esquerda (%s)\n", salaAtual->esquerda->nome);
-        
-        if (salaAtual->direita) 
-            printf(" [d] Direita (%s)\n", salaAtual->direita->nome);
-        
-        printf(" [s] Sair da Mansão (Encerrar exploração)\n");
-        
-        printf("Sua escolha: ");
-        scanf(" %c", &opcao);
+        if (silencioso) {
+            escrever("saidas\t%s%s%sg\n", salaAtual->esquerda ? "e" : "", salaAtual->direita ? "d" : "",
+                     perito.pronto ? "p" : "");
+        } else {
+            escreverTexto("Para onde deseja ir?\n");
+            if (salaAtual->esquerda) 
+                escrever(" [e] Esquerda (%s)\n", textoSimbolo(salaAtual->esquerda->nome));
+            
+            if (salaAtual->direita) 
+                escrever(" [d] Direita (%s)\n", textoSimbolo(salaAtual->direita->nome));
+            
+            if (perito.pronto) escreverTexto(" [p] Consultar o perito\n");
+            escreverTexto(" [g] Gravar a sessão (" ARQUIVO_SESSAO ")\n");
+            escreverTexto(" [s] Sair da Mansão (Encerrar exploração)\n");
+            escreverTexto("Sua escolha: ");
+        }
+        descarregarSaida(); // Uma escrita por passo, antes de esperar o jogador
+        confirmarDiario(&diario, 1); // O passo vai para o disco antes da espera
+        if (scanf(" %c", &opcao) != 1) opcao = 's'; // Fim da entrada encerra
 
         if (opcao == 'e' || opcao == 'E') {
-            if (salaAtual->esquerda) salaAtual = salaAtual->esquerda;
-            else printf("\n[!] Caminho bloqueado.\n");
+            if (salaAtual->esquerda) {
+                salaAtual = salaAtual->esquerda;
+                registrarMovimento('e');
+                anotarDiario(&diario, 'e', 0);
+                if (perito.pronto) indice = compactaEsquerda(&perito.mansao, indice);
+            }
+            else escreverTexto(silencioso ? "erro\tcaminho_bloqueado\n" : "\n[!] Caminho bloqueado.\n");
         } else if (opcao == 'd' || opcao == 'D') {
-            if (salaAtual->direita) salaAtual = salaAtual->direita;
-            else printf("\n[!] Caminho bloqueado.\n");
+            if (salaAtual->direita) {
+                salaAtual = salaAtual->direita;
+                registrarMovimento('d');
+                anotarDiario(&diario, 'd', 0);
+                if (perito.pronto) indice = compactaDireita(&perito.mansao, indice);
+            }
+            else escreverTexto(silencioso ? "erro\tcaminho_bloqueado\n" : "\n[!] Caminho bloqueado.\n");
+        } else if ((opcao == 'p' || opcao == 'P') && perito.pronto) {
+            // Para cada suspeito: pontos atuais (placar do inventário, com
+            // os pesos) + ainda alcançáveis, em O(1)
+            char rota[41];
+            decorar("\n[Perito] Máximo de pontos ainda possível por suspeito:\n");
+            for (size_t s = 0; s < tabela->quantidadeSuspeitos; s++) {
+                int64_t atual = pontosSuspeito(inventario, (int)s);
+                int64_t maximo = atual + evidenciasAlcancaveis(&perito, indice, (int)s);
+                size_t passos = rotaDoPerito(&perito, indice, (int)s, rota, sizeof(rota));
+                escrever(silencioso ? "perito\t%s\t%lld\t%lld\t%s%s\n"
+                                    : "  %s: %lld de %lld possível(is)  [caminho: %s%s]\n",
+                         textoSimbolo(tabela->suspeitos[s]), (long long)atual, (long long)maximo,
+                         passos > 0 ? rota : (silencioso ? "" : "-"), passos >= sizeof(rota) - 1 ? "..." : "");
+            }
+            decorar("(Condenação exige ao menos %lld pontos.)\n", (long long)perito.limiar);
+        } else if (opcao == 'g' || opcao == 'G') {
+            if (gravarSessao(ARQUIVO_SESSAO, inventario, tabela)) {
+                escreverTexto(silencioso ? "gravada\t" ARQUIVO_SESSAO "\n"
+                                         : "\n[g] Sessão gravada em " ARQUIVO_SESSAO ".\n");
+            } else {
+                escreverTexto(silencioso ? "erro\tgravacao\n" : "\n[!] Não foi possível gravar a sessão.\n");
+            }
         } else if (opcao == 's' || opcao == 'S') {
-            printf("\nVocê decidiu encerrar a investigação por agora.\n");
+            escreverTexto(silencioso ? "fim\tsaiu\n" : "\nVocê decidiu encerrar a investigação por agora.\n");
             break;
         } else {
-            printf("\n[!] Opção inválida.\n");
+            escreverTexto(silencioso ? "erro\topcao_invalida\n" : "\n[!] Opção inválida.\n");
         }
     }
+    confirmarDiario(&diario, 1); // Fim da exploração: tudo no disco
 }
 
-// --- Funções da Tabela Hash ---
+// --- Funções de Texto Vetorizadas ---
+
+// O hash lê o texto em blocos de 32 bytes, como quatro palavras de 64 bits
+// independentes: acumulador[j] += palavra + lo32(palavra ^ k) * hi32(palavra ^ k),
+// com a chave k mudando a cada bloco (a ordem dos blocos altera o resultado).
+// SSE2 faz duas palavras por instrução, AVX2 as quatro, e a versão escalar
+// uma por vez; todas dão o mesmo valor, então os hashes guardados (impressão
+// digital da sessão gravada) não dependem do processador.
+#define BLOCO_HASH 32
+#define PASSO_CHAVE_HASH 0x9E3779B97F4A7C15ULL
 
-int funcaoHash(char* chave) {
-    int soma = 0;
-    for (int i = 0; chave[i] != '\0'; i++) {
-        soma += chave[i];
+static const uint64_t chavesHash[4] = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL};
+
+typedef void (*AcumularBlocos)(uint64_t acumulador[4], const unsigned char* dados, size_t blocos,
+                               uint64_t primeiroBloco);
+
+static void acumularBlocosEscalar(uint64_t acumulador[4], const unsigned char* dados, size_t blocos,
+                                  uint64_t primeiroBloco) {
+    for (size_t b = 0; b < blocos; b++, dados += BLOCO_HASH) {
+        uint64_t passo = (primeiroBloco + b) * PASSO_CHAVE_HASH;
+        for (int j = 0; j < 4; j++) {
+            uint64_t palavra, chave;
+            memcpy(&palavra, dados + 8 * j, 8);
+            chave = palavra ^ (chavesHash[j] + passo);
+            acumulador[j] += palavra + (chave & 0xFFFFFFFFu) * (chave >> 32);
+        }
     }
-    return soma % TAM_HASH;
 }
 
-/*
- * inserirNaHash() – insere associação pista/suspeito na tabela hash.
- * Cria um novo nó e o insere na lista encadeada correspondente ao índice hash.
- */
-void inserirNaHash(HashNode* tabela[], char* pista, char* suspeito) {
-    int indice = funcaoHash(pista);
-    HashNode* novo = (HashNode*)malloc(sizeof(HashNode));
-    if (novo) {
-        strcpy(novo->pista, pista);
-        strcpy(novo->suspeito, suspeito);
-        novo->proximo = tabela[indice];
-        tabela[indice] = novo;
+#ifdef TEXTOS_X86
+__attribute__((target("sse2")))
+static void acumularBlocosSse2(uint64_t acumulador[4], const unsigned char* dados, size_t blocos,
+                               uint64_t primeiroBloco) {
+    uint64_t passo = primeiroBloco * PASSO_CHAVE_HASH;
+    __m128i acc0 = _mm_loadu_si128((const __m128i*)acumulador);
+    __m128i acc1 = _mm_loadu_si128((const __m128i*)(acumulador + 2));
+    __m128i deslocamento = _mm_set1_epi64x((long long)passo);
+    __m128i chave0 = _mm_add_epi64(_mm_loadu_si128((const __m128i*)chavesHash), deslocamento);
+    __m128i chave1 = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(chavesHash + 2)), deslocamento);
+    __m128i incremento = _mm_set1_epi64x((long long)PASSO_CHAVE_HASH);
+
+    for (size_t b = 0; b < blocos; b++, dados += BLOCO_HASH) {
+        __m128i palavra0 = _mm_loadu_si128((const __m128i*)dados);
+        __m128i palavra1 = _mm_loadu_si128((const __m128i*)(dados + 16));
+        __m128i misturada0 = _mm_xor_si128(palavra0, chave0);
+        __m128i misturada1 = _mm_xor_si128(palavra1, chave1);
+        __m128i produto0 = _mm_mul_epu32(misturada0, _mm_srli_epi64(misturada0, 32));
+        __m128i produto1 = _mm_mul_epu32(misturada1, _mm_srli_epi64(misturada1, 32));
+        acc0 = _mm_add_epi64(acc0, _mm_add_epi64(palavra0, produto0));
+        acc1 = _mm_add_epi64(acc1, _mm_add_epi64(palavra1, produto1));
+        chave0 = _mm_add_epi64(chave0, incremento);
+        chave1 = _mm_add_epi64(chave1, incremento);
+    }
+    _mm_storeu_si128((__m128i*)acumulador, acc0);
+    _mm_storeu_si128((__m128i*)(acumulador + 2), acc1);
+}
+
+__attribute__((target("avx2")))
+static void acumularBlocosAvx2(uint64_t acumulador[4], const unsigned char* dados, size_t blocos,
+                               uint64_t primeiroBloco) {
+    uint64_t passo = primeiroBloco * PASSO_CHAVE_HASH;
+    __m256i acc = _mm256_loadu_si256((const __m256i*)acumulador);
+    __m256i chave = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)chavesHash),
+                                     _mm256_set1_epi64x((long long)passo));
+    __m256i incremento = _mm256_set1_epi64x((long long)PASSO_CHAVE_HASH);
+
+    for (size_t b = 0; b < blocos; b++, dados += BLOCO_HASH) {
+        __m256i palavra = _mm256_loadu_si256((const __m256i*)dados);
+        __m256i misturada = _mm256_xor_si256(palavra, chave);
+        __m256i produto = _mm256_mul_epu32(misturada, _mm256_srli_epi64(misturada, 32));
+        acc = _mm256_add_epi64(acc, _mm256_add_epi64(palavra, produto));
+        chave = _mm256_add_epi64(chave, incremento);
     }
+    _mm256_storeu_si256((__m256i*)acumulador, acc);
+}
+
+#endif
+
+// popcount(a[i] & (b[i] ^ inverter)) somado: inverter = 0 conta a ∩ b,
+// inverter = ~0 conta a \ b (mapas de bits do ConjuntoPistas). A versão
+// com a instrução POPCNT também é escolhida por escolherSimd.
+typedef size_t (*ContarBits)(const uint64_t* a, const uint64_t* b, size_t palavras, uint64_t inverter);
+
+static size_t contarBitsEscalar(const uint64_t* a, const uint64_t* b, size_t palavras, uint64_t inverter) {
+    size_t total = 0;
+    for (size_t i = 0; i < palavras; i++) total += (size_t)__builtin_popcountll(a[i] & (b[i] ^ inverter));
+    return total;
+}
+
+#ifdef TEXTOS_X86
+__attribute__((target("popcnt")))
+static size_t contarBitsPopcnt(const uint64_t* a, const uint64_t* b, size_t palavras, uint64_t inverter) {
+    size_t total = 0;
+    for (size_t i = 0; i < palavras; i++) total += (size_t)__builtin_popcountll(a[i] & (b[i] ^ inverter));
+    return total;
 }
+#endif
+
+// Rotinas em uso (escolhidas por escolherSimd; escalar até lá).
+static AcumularBlocos acumularBlocos = acumularBlocosEscalar;
+static ContarBits contarBits = contarBitsEscalar;
 
 /*
- * encontrarSuspeito() – consulta o suspeito correspondente a uma pista.
- * Busca na tabela hash pela pista fornecida e retorna o nome do suspeito.
+ * detectarSimd() – melhor nível suportado pelo processador em execução.
  */
-char* encontrarSuspeito(HashNode* tabela[], char* pista) {
-    int indice = funcaoHash(pista);
-    HashNode* atual = tabela[indice];
-    
-    while (atual != NULL) {
-        if (strcmp(atual->pista, pista) == 0) {
-            return atual->suspeito;
-        }
-        atual = atual->proximo;
-    }
-    return NULL;
+NivelSimd detectarSimd(void) {
+#ifdef TEXTOS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_ESCALAR;
 }
 
-// Função auxiliar recursiva para contar pistas de um suspeito na BST
-int contarPistasSuspeito(PistaNode* raiz, HashNode* tabela[], char* suspeitoAlvo) {
-    if (raiz == NULL) return 0;
-    
-    int contador = 0;
-    char* suspeitoDaPista = encontrarSuspeito(tabela, raiz->conteudo);
-    
-    // Verifica se a pista atual aponta para o suspeito alvo
-    if (suspeitoDaPista != NULL && strcmp(suspeitoDaPista, suspeitoAlvo) == 0) {
-        contador = 1;
-    }
-    
-    return contador + 
-           contarPistasSuspeito(raiz->esquerda, tabela, suspeitoAlvo) + 
-           contarPistasSuspeito(raiz->direita, tabela, suspeitoAlvo);
+/*
+ * escolherSimd() – passa a usar as rotinas do nível pedido (limitado ao que
+ * o processador suporta) e devolve o nível efetivo. Chamada no início do
+ * programa, antes de qualquer thread.
+ */
+NivelSimd escolherSimd(NivelSimd nivel) {
+    NivelSimd suportado = detectarSimd();
+    if (nivel > suportado) nivel = suportado;
+
+    acumularBlocos = acumularBlocosEscalar;
+    contarBits = contarBitsEscalar;
+#ifdef TEXTOS_X86
+    if (nivel >= SIMD_SSE2 && __builtin_cpu_supports("popcnt")) contarBits = contarBitsPopcnt;
+    if (nivel == SIMD_SSE2) acumularBlocos = acumularBlocosSse2;
+    if (nivel == SIMD_AVX2) acumularBlocos = acumularBlocosAvx2;
+#endif
+    return nivel;
 }
 
 /*
- * verificarSuspeitoFinal() – conduz à fase de julgamento final.
- * Verifica se há provas suficientes (>= 2 pistas) contra o acusado.
+ * hashTexto() – hash de 64 bits dos 'tamanho' bytes do texto. Os blocos
+ * completos são lidos no próprio texto; o resto vai para um bloco zerado,
+ * e o tamanho entra na mistura final (textos que só diferem por zeros no fim
+ * não colidem).
  */
-void verificarSuspeitoFinal(PistaNode* raizPistas, HashNode* tabela[], char* suspeitoAcusado) {
-    printf("\n--- JULGAMENTO FINAL ---\n");
-    printf("Acusado: %s\n", suspeitoAcusado);
-    printf("Analisando evidências coletadas...\n");
-    
-    int qtdProvas = contarPistasSuspeito(raizPistas, tabela, suspeitoAcusado);
-    
-    printf("Provas encontradas contra %s: %d\n", suspeitoAcusado, qtdProvas);
-    
-    if (qtdProvas >= 2) {
-        printf("\n[VEREDITO] CULPADO!\n");
-        printf("Parabéns, detetive! Você reuniu provas suficientes (%d) para prender o %s.\n", qtdProvas, suspeitoAcusado);
-        printf("O mistério da mansão foi resolvido.\n");
-    } else {
-        printf("\n[VEREDITO] INOCENTE (por falta de provas)!\n");
-        printf("Você apresentou apenas %d prova(s). O tribunal exige no mínimo 2 evidências concretas.\n", qtdProvas);
-        printf("O %s foi liberado e o verdadeiro culpado fugiu.\n", suspeitoAcusado);
-        printf("GAME OVER.\n");
+uint64_t hashTexto(const char* texto, size_t tamanho) {
+    uint64_t acumulador[4] = {0, 0, 0, 0};
+    size_t blocos = tamanho / BLOCO_HASH;
+    size_t resto = tamanho % BLOCO_HASH;
+
+    acumularBlocos(acumulador, (const unsigned char*)texto, blocos, 0);
+    if (resto != 0) {
+        unsigned char ultimo[BLOCO_HASH] = {0};
+        memcpy(ultimo, texto + blocos * BLOCO_HASH, resto);
+        acumularBlocos(acumulador, ultimo, 1, blocos);
+    }
+
+    uint64_t hash = tamanho * PASSO_CHAVE_HASH;
+    for (int j = 0; j < 4; j++) {
+        hash ^= acumulador[j];
+        hash = (hash << 23) | (hash >> 41); // Cada palavra numa posição diferente
     }
+    hash ^= hash >> 33; // Finalizador de 64 bits (MurmurHash3)
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
-// --- Funções Auxiliares e de Limpeza ---
+// --- Funções da Tabela Hash ---
 
-void exibirPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        exibirPistas(raiz->esquerda);
-        printf("- %s\n", raiz->conteudo);
-        exibirPistas(raiz->direita);
-    }
+/*
+ * funcaoHash() – hash de 64 bits do texto (ver hashTexto).
+ * Ao contrário da soma ASCII, a ordem dos caracteres altera o resultado,
+ * então pistas com as mesmas letras não caem no mesmo índice.
+ */
+uint64_t funcaoHash(const char* chave) {
+    return hashTexto(chave, strlen(chave));
 }
 
-void liberarMapa(Sala* raiz) {
-    if (raiz != NULL) {
-        liberarMapa(raiz->esquerda);
-        liberarMapa(raiz->direita);
-        free(raiz);
-    }
+// Espalha um id inteiro pelos bits altos (hash multiplicativo de Fibonacci).
+static size_t hashId(int id, size_t mascara) {
+    return (size_t)(((uint64_t)(uint32_t)id * 11400714819323198485ULL) >> 32) & mascara;
 }
 
-void liberarPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
+static void alocarSlots(TabelaHash* tabela) {
+    tabela->slots = realocarOuSair(NULL, tabela->capacidade * sizeof(HashNode));
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        tabela->slots[i].pista = SEM_SIMBOLO;
     }
 }
 
-void liberarHash(HashNode* tabela[]) {
-    for (int i = 0; i < TAM_HASH; i++) {
-        HashNode* atual = tabela[i];
-        while (atual != NULL) {
-            HashNode* temp = atual;
-            atual = atual->proximo;
-            free(temp);
-        }
+void iniciarHash(TabelaHash* tabela) {
+    tabela->fixo = NULL;
+    tabela->capacidade = CAPACIDADE_INICIAL_HASH;
+    tabela->quantidade = 0;
+    alocarSlots(tabela);
+    tabela->suspeitos = NULL;
+    tabela->quantidadeSuspeitos = 0;
+    tabela->capacidadeSuspeitos = 0;
+    tabela->indiceSuspeito = NULL;
+    tabela->capacidadeIndiceSuspeito = 0;
+}
+
+/*
+ * indiceDoSuspeito() – posição do suspeito (id do nome) no elenco, ou -1.
+ */
+int indiceDoSuspeito(TabelaHash* tabela, int suspeito) {
+    if (suspeito < 0 || (size_t)suspeito >= tabela->capacidadeIndiceSuspeito) return -1;
+    return tabela->indiceSuspeito[suspeito];
+}
+
+// Cadastra o suspeito no elenco (se ainda não estiver) e devolve seu índice.
+static int registrarSuspeito(TabelaHash* tabela, int suspeito) {
+    int indice = indiceDoSuspeito(tabela, suspeito);
+    if (indice >= 0) return indice;
+
+    if ((size_t)suspeito >= tabela->capacidadeIndiceSuspeito) {
+        size_t capacidade = tabela->capacidadeIndiceSuspeito ? tabela->capacidadeIndiceSuspeito : 64;
+        while (capacidade <= (size_t)suspeito) capacidade *= 2;
+        tabela->indiceSuspeito = realocarOuSair(tabela->indiceSuspeito, capacidade * sizeof(int));
+        for (size_t i = tabela->capacidadeIndiceSuspeito; i < capacidade; i++) {
+            tabela->indiceSuspeito[i] = -1;
+        }
+        tabela->capacidadeIndiceSuspeito = capacidade;
+    }
+    if (tabela->quantidadeSuspeitos == tabela->capacidadeSuspeitos) {
+        tabela->capacidadeSuspeitos = tabela->capacidadeSuspeitos ? tabela->capacidadeSuspeitos * 2 : 8;
+        tabela->suspeitos = realocarOuSair(tabela->suspeitos, tabela->capacidadeSuspeitos * sizeof(int));
+    }
+
+    indice = (int)tabela->quantidadeSuspeitos++;
+    tabela->suspeitos[indice] = suspeito;
+    tabela->indiceSuspeito[suspeito] = indice;
+    return indice;
+}
+
+// Posição única do hash num gabarito gerado.
+static size_t posicaoFixa(const GabaritoFixo* gabarito, uint64_t hash) {
+    return (size_t)(((hash ^ gabarito->semente) * 0x9E3779B97F4A7C15ULL) >> (64 - gabarito->bits));
+}
+
+/*
+ * usarGabaritoFixo() – monta a tabela sobre um gabarito gerado, sem alocar
+ * slots nem inserir associação por associação: só interna os textos (sem
+ * copiar; são literais) e anota os ids nos slots estáticos (graváveis: os
+ * ids dos símbolos só existem ao executar). Devolve 0 se a tabela gerada não
+ * confere com funcaoHash (foi gerada com outro hash) – aí a tabela não é
+ * tocada e o chamador usa a dinâmica, mas os textos lidos até a falha já
+ * ficaram internados e os slots até ela já foram escritos; a dinâmica não
+ * usa esses slots, e uma nova chamada os reescreve por inteiro.
+ */
+int usarGabaritoFixo(TabelaHash* tabela, const GabaritoFixo* gabarito) {
+    size_t capacidade = (size_t)1 << gabarito->bits;
+
+    for (size_t i = 0; i < capacidade; i++) {
+        const EntradaGabarito* entrada = &gabarito->entradas[i];
+        if (entrada->pista == NULL) {
+            gabarito->slots[i].pista = SEM_SIMBOLO;
+            continue;
+        }
+        int pista = internarExterno(entrada->pista);
+        if (simbolos.hashes[pista] != entrada->hash || posicaoFixa(gabarito, entrada->hash) != i) return 0;
+        gabarito->slots[i].pista = pista;
+        gabarito->slots[i].suspeito = entrada->suspeito;
+    }
+
+    tabela->fixo = gabarito;
+    tabela->slots = gabarito->slots;
+    tabela->capacidade = capacidade;
+    tabela->quantidade = gabarito->quantidade;
+    tabela->suspeitos = NULL;
+    tabela->quantidadeSuspeitos = 0;
+    tabela->capacidadeSuspeitos = 0;
+    tabela->indiceSuspeito = NULL;
+    tabela->capacidadeIndiceSuspeito = 0;
+    for (size_t s = 0; s < gabarito->quantidadeSuspeitos; s++) {
+        registrarSuspeito(tabela, internarExterno(gabarito->elenco[s]));
+    }
+    return 1;
+}
+
+// Devolve a posição da pista na tabela, ou a posição livre onde ela entraria.
+static HashNode* localizarSlot(TabelaHash* tabela, int pista) {
+    size_t mascara = tabela->capacidade - 1;
+    size_t i = hashId(pista, mascara);
+
+    size_t sondagens = 1;
+    while (tabela->slots[i].pista != SEM_SIMBOLO && tabela->slots[i].pista != pista) {
+        i = (i + 1) & mascara;
+        sondagens++;
+    }
+    ESTATISTICA_SONDAGENS(gabarito, sondagens);
+    return &tabela->slots[i];
+}
+
+// Troca o vetor por um de 'capacidade' posições e reposiciona as associações.
+static void reconstruirHash(TabelaHash* tabela, size_t capacidade) {
+    HashNode* antigos = tabela->slots;
+    size_t capacidadeAntiga = tabela->capacidade;
+
+    tabela->capacidade = capacidade;
+    alocarSlots(tabela);
+
+    for (size_t k = 0; k < capacidadeAntiga; k++) {
+        if (antigos[k].pista != SEM_SIMBOLO) {
+            *localizarSlot(tabela, antigos[k].pista) = antigos[k];
+        }
+    }
+    free(antigos);
+}
+
+// Gabarito gerado recebendo associações: copia os slots estáticos para um
+// vetor dinâmico (que pode crescer) e deixa de usar a posição fixa.
+static void materializarHash(TabelaHash* tabela, size_t quantidade) {
+    HashNode* fixos = tabela->slots;
+    size_t capacidadeFixa = tabela->capacidade;
+
+    tabela->fixo = NULL;
+    tabela->capacidade = CAPACIDADE_INICIAL_HASH;
+    while (quantidade * 4 > tabela->capacidade * 3) tabela->capacidade *= 2;
+    alocarSlots(tabela);
+    for (size_t k = 0; k < capacidadeFixa; k++) {
+        if (fixos[k].pista != SEM_SIMBOLO) *localizarSlot(tabela, fixos[k].pista) = fixos[k];
+    }
+}
+
+// Dobra a capacidade.
+static void redimensionarHash(TabelaHash* tabela) {
+    reconstruirHash(tabela, tabela->capacidade * 2);
+}
+
+/*
+ * reservarHash() – garante espaço para 'quantidade' associações sem crescer.
+ */
+void reservarHash(TabelaHash* tabela, size_t quantidade) {
+    if (tabela->fixo != NULL) materializarHash(tabela, quantidade);
+    size_t capacidade = tabela->capacidade;
+    while (quantidade * 4 > capacidade * 3) capacidade *= 2;
+    if (capacidade != tabela->capacidade) reconstruirHash(tabela, capacidade);
+}
+
+/*
+ * inserirNaHash() – insere associação pista/suspeito na tabela hash.
+ * Os dois textos são internados; a tabela guarda só os ids.
+ * Se a pista já estiver cadastrada, o suspeito é atualizado.
+ */
+void inserirNaHash(TabelaHash* tabela, char* pista, char* suspeito) {
+    inserirNaHashIds(tabela, internar(pista), internar(suspeito));
+}
+
+// Mesma inserção, para textos já internados (carregamento de arquivos).
+void inserirNaHashIds(TabelaHash* tabela, int pista, int suspeito) {
+    if (tabela->fixo != NULL) materializarHash(tabela, tabela->quantidade + 1);
+    if ((tabela->quantidade + 1) * 4 > tabela->capacidade * 3) {
+        redimensionarHash(tabela);
+    }
+
+    HashNode* slot = localizarSlot(tabela, pista);
+
+    if (slot->pista == SEM_SIMBOLO) {
+        slot->pista = pista;
+        tabela->quantidade++;
+    }
+    slot->suspeito = registrarSuspeito(tabela, suspeito);
+}
+
+/*
+ * encontrarSuspeitoId() – consulta por id: só comparações de inteiros.
+ * Devolve o id do suspeito ou SEM_SIMBOLO.
+ */
+int encontrarSuspeitoId(TabelaHash* tabela, int pista) {
+    if (pista == SEM_SIMBOLO) return SEM_SIMBOLO;
+    if (tabela->fixo != NULL) { // Uma posição só: a pista está nela ou não existe
+        HashNode* slot = &tabela->slots[posicaoFixa(tabela->fixo, simbolos.hashes[pista])];
+        ESTATISTICA_SONDAGENS(gabarito, 1);
+        return (slot->pista == pista) ? tabela->suspeitos[slot->suspeito] : SEM_SIMBOLO;
+    }
+
+    HashNode* slot = localizarSlot(tabela, pista);
+    return (slot->pista != SEM_SIMBOLO) ? tabela->suspeitos[slot->suspeito] : SEM_SIMBOLO;
+}
+
+/*
+ * encontrarSuspeito() – consulta o suspeito correspondente a uma pista.
+ * Busca na tabela hash pela pista fornecida e retorna o nome do suspeito.
+ */
+const char* encontrarSuspeito(TabelaHash* tabela, char* pista) {
+    if (tabela->fixo != NULL) { // Uma sondagem e uma comparação, sem a tabela de símbolos
+        uint64_t hash = funcaoHash(pista);
+        const EntradaGabarito* entrada = &tabela->fixo->entradas[posicaoFixa(tabela->fixo, hash)];
+        if (entrada->pista == NULL || entrada->hash != hash || strcmp(entrada->pista, pista) != 0) {
+            return NULL;
+        }
+        return tabela->fixo->elenco[entrada->suspeito];
+    }
+    int suspeito = encontrarSuspeitoId(tabela, buscarSimbolo(pista));
+    return (suspeito != SEM_SIMBOLO) ? textoSimbolo(suspeito) : NULL;
+}
+
+// Libera o vetor da tabela e o elenco de suspeitos.
+void liberarHash(TabelaHash* tabela) {
+    free(tabela->suspeitos);
+    free(tabela->indiceSuspeito);
+    if (tabela->fixo == NULL) free(tabela->slots); // Os do gabarito gerado são estáticos
+    tabela->fixo = NULL;
+    tabela->slots = NULL;
+    tabela->capacidade = 0;
+    tabela->quantidade = 0;
+    tabela->suspeitos = NULL; // Pode ser chamada de novo (liberarCaso após falha)
+    tabela->quantidadeSuspeitos = 0;
+    tabela->capacidadeSuspeitos = 0;
+    tabela->indiceSuspeito = NULL;
+    tabela->capacidadeIndiceSuspeito = 0;
+}
+
+// Recontagem completa: percorre a BST consultando a hash em cada pista.
+// O jogo usa o placar do inventário; esta versão serve de referência.
+static int contarPistasSuspeitoId(PistaNode* raiz, TabelaHash* tabela, int suspeitoAlvo) {
+    int contador = 0;
+    PistaNode* cursor = raiz;
+    PistaNode* no;
+
+    // Verifica se cada pista aponta para o suspeito alvo (percurso sem pilha)
+    while ((no = proximoEmOrdem(&cursor)) != NULL) {
+        contador += (encontrarSuspeitoId(tabela, no->conteudo) == suspeitoAlvo);
+    }
+    return contador;
+}
+
+// O nome do suspeito é resolvido uma vez; o percurso só compara inteiros.
+int contarPistasSuspeito(PistaNode* raiz, TabelaHash* tabela, char* suspeitoAlvo) {
+    int alvo = buscarSimbolo(suspeitoAlvo);
+    if (alvo == SEM_SIMBOLO) return 0; // Nome que não aparece no caso
+    return contarPistasSuspeitoId(raiz, tabela, alvo);
+}
+
+/*
+ * verificarSuspeitoFinal() – conduz à fase de julgamento final.
+ * Verifica se os pontos do acusado (placar ponderado, por índice no elenco)
+ * atingem o limiar do caso (2 provas, se o caso não define outro).
+ */
+void verificarSuspeitoFinal(const int64_t* pontos, TabelaHash* tabela, const char* suspeitoAcusado, int64_t limiar) {
+    int indice = indiceDoSuspeito(tabela, buscarSimbolo(suspeitoAcusado));
+    long long qtdProvas = (indice >= 0) ? (long long)pontos[indice] : 0;
+
+    if (saida.silencioso) {
+        escrever("veredito\t%s\t%s\t%lld\n", (qtdProvas >= limiar) ? "CULPADO" : "INOCENTE",
+                 suspeitoAcusado, qtdProvas);
+        return;
+    }
+
+    escrever("\n--- JULGAMENTO FINAL ---\n"
+             "Acusado: %s\n"
+             "Analisando evidências coletadas...\n"
+             "Provas encontradas contra %s: %lld\n", suspeitoAcusado, suspeitoAcusado, qtdProvas);
+    
+    if (qtdProvas >= limiar) {
+        escrever("\n[VEREDITO] CULPADO!\n"
+                 "Parabéns, detetive! Você reuniu provas suficientes (%lld) para prender o %s.\n"
+                 "O mistério da mansão foi resolvido.\n", qtdProvas, suspeitoAcusado);
+    } else {
+        escrever("\n[VEREDITO] INOCENTE (por falta de provas)!\n"
+                 "Você apresentou apenas %lld prova(s). O tribunal exige no mínimo %lld evidências concretas.\n"
+                 "O %s foi liberado e o verdadeiro culpado fugiu.\n"
+                 "GAME OVER.\n", qtdProvas, (long long)limiar, suspeitoAcusado);
+    }
+}
+
+// --- Funções do Inventário ---
+
+/*
+ * iniciarInventario() – inventário vazio, com o placar zerado para os
+ * suspeitos do índice (sem índice, só a árvore e o mapa de bits).
+ */
+void iniciarInventario(Inventario* inventario, const IndicePistas* indice) {
+    inventario->raiz = NULL;
+    iniciarConjunto(&inventario->coletadas);
+    inventario->indice = indice;
+    inventario->placar = NULL;
+    inventario->totalPistas = 0;
+    if (indice != NULL) {
+        inventario->placar = alocarZeradoOuSair(indice->quantidadeSuspeitos + 1, sizeof(int64_t));
+    }
+}
+
+// Soma ao placar os pesos da lista da pista no índice (os mesmos do veredito).
+static void somarAoPlacar(Inventario* inventario, int pista) {
+    const IndicePistas* indice = inventario->indice;
+    if (indice == NULL || (size_t)pista >= indice->universo) return; // Pista sem suspeito associado
+    for (size_t e = indice->inicio[pista]; e < indice->inicio[pista + 1]; e++) {
+        inventario->placar[indice->entradas[e].suspeito] += indice->entradas[e].peso;
+    }
+}
+
+/*
+ * coletarPista() – insere a pista na BST e, se ela for nova, soma os seus
+ * pesos ao placar. O(log n + pesos da pista). Devolve 1 quando a pista era
+ * nova.
+ */
+int coletarPista(Inventario* inventario, int pista) {
+    if (!marcarPista(&inventario->coletadas, pista)) return 0; // Repetida: nem desce a árvore
+    inventario->raiz = inserirPistaAvl(inventario->raiz, pista, NULL);
+    inventario->totalPistas++;
+    somarAoPlacar(inventario, pista);
+    return 1;
+}
+
+// Pontos do suspeito pelo índice no elenco (0 se está fora do placar).
+static int64_t pontosSuspeito(const Inventario* inventario, int suspeito) {
+    if (inventario->indice == NULL || suspeito < 0 || (size_t)suspeito >= inventario->indice->quantidadeSuspeitos) {
+        return 0;
+    }
+    return inventario->placar[suspeito];
+}
+
+/*
+ * evidenciasContra() – pontos contra o suspeito (pelo nome), em O(1).
+ */
+int64_t evidenciasContra(Inventario* inventario, TabelaHash* tabela, const char* suspeito) {
+    return pontosSuspeito(inventario, indiceDoSuspeito(tabela, buscarSimbolo(suspeito)));
+}
+
+// Libera o placar e o mapa de bits (os nós da BST pertencem à arena do caso).
+void liberarInventario(Inventario* inventario) {
+    free(inventario->placar);
+    liberarConjunto(&inventario->coletadas);
+    iniciarInventario(inventario, NULL);
+}
+
+// --- Funções do Conjunto de Pistas ---
+
+void iniciarConjunto(ConjuntoPistas* conjunto) {
+    conjunto->palavras = NULL;
+    conjunto->quantidadePalavras = 0;
+}
+
+// Garante palavras até a do id (novas zeradas), dobrando o vetor.
+static void reservarConjunto(ConjuntoPistas* conjunto, size_t palavras) {
+    if (palavras <= conjunto->quantidadePalavras) return;
+    size_t capacidade = conjunto->quantidadePalavras ? conjunto->quantidadePalavras : 4;
+    while (capacidade < palavras) capacidade *= 2;
+    conjunto->palavras = realocarOuSair(conjunto->palavras, capacidade * sizeof(uint64_t));
+    memset(conjunto->palavras + conjunto->quantidadePalavras, 0,
+           (capacidade - conjunto->quantidadePalavras) * sizeof(uint64_t));
+    conjunto->quantidadePalavras = capacidade;
+}
+
+/*
+ * marcarPista() – liga o bit da pista. Devolve 1 se ela ainda não estava.
+ */
+int marcarPista(ConjuntoPistas* conjunto, int pista) {
+    size_t palavra = (size_t)pista / 64;
+    uint64_t bit = 1ULL << ((size_t)pista % 64);
+    reservarConjunto(conjunto, palavra + 1);
+    if (conjunto->palavras[palavra] & bit) return 0;
+    conjunto->palavras[palavra] |= bit;
+    return 1;
+}
+
+int contemPista(const ConjuntoPistas* conjunto, int pista) {
+    size_t palavra = (size_t)pista / 64;
+    return palavra < conjunto->quantidadePalavras && (conjunto->palavras[palavra] >> ((size_t)pista % 64)) & 1;
+}
+
+size_t contarConjunto(const ConjuntoPistas* conjunto) {
+    return contarBits(conjunto->palavras, conjunto->palavras, conjunto->quantidadePalavras, 0);
+}
+
+/*
+ * combinarConjuntos() – destino = a ∪ b, a ∩ b ou a \ b, uma palavra por vez
+ * (palavras que faltam no menor conjunto valem zero). 'destino' pode ser
+ * um dos operandos.
+ */
+void combinarConjuntos(ConjuntoPistas* destino, const ConjuntoPistas* a, const ConjuntoPistas* b,
+                       OperacaoConjunto operacao) {
+    size_t palavrasA = a->quantidadePalavras, palavrasB = b->quantidadePalavras;
+    size_t palavras = (palavrasA > palavrasB) ? palavrasA : palavrasB;
+    reservarConjunto(destino, palavras);
+    const uint64_t* pa = a->palavras; // Releitura depois de reservar (destino pode ser a ou b)
+    const uint64_t* pb = b->palavras;
+
+    for (size_t i = 0; i < palavras; i++) {
+        uint64_t x = (i < palavrasA) ? pa[i] : 0;
+        uint64_t y = (i < palavrasB) ? pb[i] : 0;
+        destino->palavras[i] = (operacao == CONJUNTO_UNIAO) ? (x | y)
+                             : (operacao == CONJUNTO_INTERSECAO) ? (x & y) : (x & ~y);
+    }
+    for (size_t i = palavras; i < destino->quantidadePalavras; i++) destino->palavras[i] = 0;
+}
+
+void liberarConjunto(ConjuntoPistas* conjunto) {
+    free(conjunto->palavras);
+    iniciarConjunto(conjunto);
+}
+
+/*
+ * prepararMascaras() – uma máscara por suspeito do elenco com as pistas do
+ * gabarito contra ele, cobrindo todos os ids já internados.
+ */
+void prepararMascaras(MascarasSuspeitos* mascaras, TabelaHash* tabela) {
+    size_t palavras = simbolos.quantidade / 64 + 1;
+    size_t k = tabela->quantidadeSuspeitos;
+
+    mascaras->palavras = palavras;
+    mascaras->quantidadeSuspeitos = k;
+    mascaras->bits = realocarOuSair(NULL, (k * palavras + 1) * sizeof(uint64_t));
+    memset(mascaras->bits, 0, (k * palavras + 1) * sizeof(uint64_t));
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        HashNode* slot = &tabela->slots[i];
+        if (slot->pista == SEM_SIMBOLO) continue;
+        uint64_t* mascara = mascaras->bits + (size_t)slot->suspeito * palavras;
+        mascara[(size_t)slot->pista / 64] |= 1ULL << ((size_t)slot->pista % 64);
+    }
+}
+
+/*
+ * provasNoConjunto() – pistas do conjunto contra o suspeito:
+ * popcount(coletadas & máscara), 64 pistas por palavra.
+ */
+size_t provasNoConjunto(const ConjuntoPistas* coletadas, const MascarasSuspeitos* mascaras, int suspeito) {
+    if (suspeito < 0 || (size_t)suspeito >= mascaras->quantidadeSuspeitos) return 0;
+    size_t palavras = (coletadas->quantidadePalavras < mascaras->palavras) ? coletadas->quantidadePalavras
+                                                                           : mascaras->palavras;
+    return contarBits(coletadas->palavras, mascaras->bits + (size_t)suspeito * mascaras->palavras, palavras, 0);
+}
+
+/*
+ * pistasFaltando() – pistas do gabarito contra o suspeito que ainda não
+ * estão no conjunto: popcount(máscara & ~coletadas).
+ */
+size_t pistasFaltando(const ConjuntoPistas* coletadas, const MascarasSuspeitos* mascaras, int suspeito) {
+    if (suspeito < 0 || (size_t)suspeito >= mascaras->quantidadeSuspeitos) return 0;
+    const uint64_t* mascara = mascaras->bits + (size_t)suspeito * mascaras->palavras;
+    size_t comuns = (coletadas->quantidadePalavras < mascaras->palavras) ? coletadas->quantidadePalavras
+                                                                         : mascaras->palavras;
+    size_t faltando = contarBits(mascara, coletadas->palavras, comuns, ~0ULL);
+    return faltando + contarBits(mascara + comuns, mascara + comuns, mascaras->palavras - comuns, 0);
+}
+
+void liberarMascaras(MascarasSuspeitos* mascaras) {
+    free(mascaras->bits);
+    mascaras->bits = NULL;
+    mascaras->palavras = 0;
+    mascaras->quantidadeSuspeitos = 0;
+}
+
+// --- Funções do Índice Invertido ---
+
+/*
+ * construirIndice() – junta o gabarito (peso 1) e as implicações do caso
+ * num índice em CSR: conta as entradas de cada pista, acumula as contagens
+ * em posições de início e distribui as entradas (ordenação por contagem).
+ */
+void construirIndice(IndicePistas* indice, Caso* caso) {
+    TabelaHash* tabela = &caso->tabela;
+    size_t universo = simbolos.quantidade;
+
+    // Contagem em inicio[p + 2]: depois da soma, inicio[p + 1] é o começo de
+    // p e serve de cursor; ao fim da distribuição, vira o fim de p
+    size_t* inicio = alocarZeradoOuSair(universo + 2, sizeof(size_t));
+    PesoSuspeito* entradas = realocarOuSair(NULL, (tabela->quantidade + caso->quantidadeImplicacoes + 1) *
+                                                  sizeof(PesoSuspeito));
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        if (tabela->slots[i].pista != SEM_SIMBOLO) inicio[(size_t)tabela->slots[i].pista + 2]++;
+    }
+    for (size_t i = 0; i < caso->quantidadeImplicacoes; i++) {
+        inicio[(size_t)caso->implicacoes[i].pista + 2]++;
+    }
+    for (size_t p = 0; p < universo; p++) inicio[p + 1] += inicio[p];
+
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        HashNode* slot = &tabela->slots[i];
+        if (slot->pista == SEM_SIMBOLO) continue;
+        PesoSuspeito* entrada = &entradas[inicio[(size_t)slot->pista + 1]++];
+        entrada->suspeito = slot->suspeito;
+        entrada->peso = 1;
+    }
+    for (size_t i = 0; i < caso->quantidadeImplicacoes; i++) {
+        const Implicacao* implicacao = &caso->implicacoes[i];
+        PesoSuspeito* entrada = &entradas[inicio[(size_t)implicacao->pista + 1]++];
+        entrada->suspeito = indiceDoSuspeito(tabela, implicacao->suspeito);
+        entrada->peso = implicacao->peso;
+    }
+
+    indice->inicio = inicio;
+    indice->entradas = entradas;
+    indice->universo = universo;
+    indice->quantidadeSuspeitos = tabela->quantidadeSuspeitos;
+}
+
+// 'a' fica abaixo de 'b' no ranking: menos pontos ou, no empate, cadastrado depois.
+static int abaixoNoRanking(const int64_t* pontos, int a, int b) {
+    return pontos[a] < pontos[b] || (pontos[a] == pontos[b] && a > b);
+}
+
+// Desce heap[i] no heap de mínimo (o pior colocado fica na raiz).
+static void descerNoHeap(int* heap, size_t tamanho, size_t i, const int64_t* pontos) {
+    for (;;) {
+        size_t pior = i, esquerda = 2 * i + 1, direita = 2 * i + 2;
+        if (esquerda < tamanho && abaixoNoRanking(pontos, heap[esquerda], heap[pior])) pior = esquerda;
+        if (direita < tamanho && abaixoNoRanking(pontos, heap[direita], heap[pior])) pior = direita;
+        if (pior == i) return;
+        int troca = heap[i];
+        heap[i] = heap[pior];
+        heap[pior] = troca;
+        i = pior;
+    }
+}
+
+/*
+ * melhoresSuspeitos() – os k suspeitos de mais pontos, do primeiro ao
+ * k-ésimo (empate: vence o cadastrado primeiro). Um heap de mínimo com os
+ * k melhores até agora: O(n log k), sem ordenar os n. Devolve min(k, n).
+ */
+size_t melhoresSuspeitos(const int64_t* pontos, size_t quantidade, size_t k, int* saida) {
+    if (k > quantidade) k = quantidade;
+    if (k == 0) return 0;
+
+    for (size_t i = 0; i < k; i++) saida[i] = (int)i;
+    for (size_t i = k / 2; i-- > 0;) descerNoHeap(saida, k, i, pontos);
+    for (size_t i = k; i < quantidade; i++) {
+        if (abaixoNoRanking(pontos, saida[0], (int)i)) {
+            saida[0] = (int)i;
+            descerNoHeap(saida, k, 0, pontos);
+        }
+    }
+
+    // Retira o pior para o fim até esvaziar: fica do melhor para o pior
+    for (size_t fim = k; fim-- > 1;) {
+        int troca = saida[0];
+        saida[0] = saida[fim];
+        saida[fim] = troca;
+        descerNoHeap(saida, fim, 0, pontos);
+    }
+    return k;
+}
+
+void liberarIndice(IndicePistas* indice) {
+    free(indice->inicio);
+    free(indice->entradas);
+    indice->inicio = NULL;
+    indice->entradas = NULL;
+    indice->universo = 0;
+    indice->quantidadeSuspeitos = 0;
+}
+
+// --- Funções do Índice de Nomes ---
+
+// Letra base de cada caractere U+00C0..U+00FF (segundo byte 0x80..0xBF do
+// UTF-8 "\xC3.."); '_' = sem letra base (×, ÷, Þ, þ), mantido como está.
+static const char letrasSemAcento[65] =
+    "aaaaaaaceeeeiiiidnooooo_ouuuuy_s"
+    "aaaaaaaceeeeiiiidnooooo_ouuuuy_y";
+
+/*
+ * normalizarNome() – copia o nome em minúsculas, sem acentos (Latin-1 em
+ * UTF-8) e com os espaços das pontas removidos e os do meio reduzidos a um.
+ * Nunca aumenta o texto; devolve o tamanho escrito (sem o '\0').
+ */
+size_t normalizarNome(const char* nome, char* destino, size_t limite) {
+    size_t n = 0;
+    int espaco = 0;
+
+    for (const unsigned char* c = (const unsigned char*)nome; *c != '\0' && n + 2 < limite; c++) {
+        unsigned char letra = *c;
+        if (isspace(letra)) {
+            espaco = (n > 0);
+            continue;
+        }
+        if (letra == 0xC3 && c[1] >= 0x80 && c[1] <= 0xBF && letrasSemAcento[c[1] - 0x80] != '_') {
+            letra = (unsigned char)letrasSemAcento[*++c - 0x80];
+        } else if (letra < 0x80) {
+            letra = (unsigned char)tolower(letra);
+        }
+        if (espaco) destino[n++] = ' ';
+        espaco = 0;
+        destino[n++] = (char)letra;
+    }
+    destino[n] = '\0';
+    return n;
+}
+
+static const IndiceNomes* indiceNomesOrdenacao; // Chaves usadas pela comparação do qsort
+
+static int compararChavesNomes(const void* a, const void* b) {
+    int sa = *(const int32_t*)a, sb = *(const int32_t*)b;
+    int diferenca = strcmp(indiceNomesOrdenacao->chaves + indiceNomesOrdenacao->deslocamento[sa],
+                           indiceNomesOrdenacao->chaves + indiceNomesOrdenacao->deslocamento[sb]);
+    return diferenca ? diferenca : sa - sb; // Nomes iguais após normalizar: ordem do elenco
+}
+
+static const char* chaveNaPosicao(const IndiceNomes* indice, size_t posicao) {
+    return indice->chaves + indice->deslocamento[posicao];
+}
+
+/*
+ * construirIndiceNomes() – normaliza os nomes do elenco num só bloco e
+ * ordena as posições pela chave (O(k log k), uma vez por partida).
+ */
+void construirIndiceNomes(IndiceNomes* indice, TabelaHash* tabela) {
+    size_t k = tabela->quantidadeSuspeitos, bytes = 0;
+    for (size_t s = 0; s < k; s++) bytes += strlen(textoSimbolo(tabela->suspeitos[s])) + 1;
+
+    indice->chaves = realocarOuSair(NULL, bytes + 1);
+    indice->deslocamento = realocarOuSair(NULL, (k + 1) * sizeof(size_t));
+    indice->suspeito = realocarOuSair(NULL, (k + 1) * sizeof(int32_t));
+    indice->quantidade = k;
+
+    size_t usados = 0;
+    for (size_t s = 0; s < k; s++) {
+        const char* nome = textoSimbolo(tabela->suspeitos[s]);
+        indice->deslocamento[s] = usados;
+        indice->suspeito[s] = (int32_t)s;
+        usados += normalizarNome(nome, indice->chaves + usados, strlen(nome) + 2) + 1;
+    }
+
+    // Ordena os suspeitos pela chave e refaz 'deslocamento' na nova ordem
+    indiceNomesOrdenacao = indice;
+    qsort(indice->suspeito, k, sizeof(int32_t), compararChavesNomes);
+    size_t* porSuspeito = indice->deslocamento;
+    indice->deslocamento = realocarOuSair(NULL, (k + 1) * sizeof(size_t));
+    for (size_t i = 0; i < k; i++) indice->deslocamento[i] = porSuspeito[indice->suspeito[i]];
+    free(porSuspeito);
+}
+
+/*
+ * faixaDoPrefixo() – nomes cuja chave começa com o prefixo (já
+ * normalizado): duas buscas binárias pela primeira chave >= prefixo e pela
+ * primeira > prefixo nos 'tamanho' primeiros bytes. Devolve quantos são.
+ */
+size_t faixaDoPrefixo(const IndiceNomes* indice, const char* prefixo, size_t tamanho, size_t* primeiro) {
+    size_t baixo = 0, alto = indice->quantidade;
+    while (baixo < alto) {
+        size_t meio = baixo + (alto - baixo) / 2;
+        if (strncmp(chaveNaPosicao(indice, meio), prefixo, tamanho) < 0) baixo = meio + 1;
+        else alto = meio;
+    }
+    *primeiro = baixo;
+
+    alto = indice->quantidade;
+    while (baixo < alto) {
+        size_t meio = baixo + (alto - baixo) / 2;
+        if (strncmp(chaveNaPosicao(indice, meio), prefixo, tamanho) == 0) baixo = meio + 1;
+        else alto = meio;
+    }
+    return baixo - *primeiro;
+}
+
+/*
+ * resolverSuspeito() – índice no elenco do suspeito que a entrada aponta:
+ * o nome exato; senão o único nome igual a ela sem caixa e sem acento;
+ * senão o único que começa com ela. Devolve -1 se nenhum ou mais de um
+ * servir; 'primeiro' e 'quantidade' dão a faixa de nomes que começam com a
+ * entrada (as sugestões).
+ */
+int resolverSuspeito(const IndiceNomes* indice, TabelaHash* tabela, const char* entrada,
+                     size_t* primeiro, size_t* quantidade) {
+    char chave[TAM_NOME_ACUSADO];
+    *primeiro = 0;
+    *quantidade = 0;
+
+    int exato = indiceDoSuspeito(tabela, buscarSimbolo(entrada));
+    if (exato >= 0) {
+        *quantidade = 1;
+        return exato;
+    }
+
+    size_t tamanho = normalizarNome(entrada, chave, sizeof(chave));
+    if (tamanho == 0) return -1;
+    *quantidade = faixaDoPrefixo(indice, chave, tamanho, primeiro);
+    if (*quantidade == 1) return indice->suspeito[*primeiro];
+
+    // "ana" entre "Ana" e "Ana Maria": vale o nome completo, se só um for igual
+    if (*quantidade > 1 && strcmp(chaveNaPosicao(indice, *primeiro), chave) == 0 &&
+        strcmp(chaveNaPosicao(indice, *primeiro + 1), chave) != 0) {
+        return indice->suspeito[*primeiro];
+    }
+    return -1;
+}
+
+/*
+ * listarSugestoes() – os primeiros NOMES_SUGERIDOS nomes da faixa, em
+ * ordem alfabética (sem caixa nem acento), para completar a acusação.
+ */
+void listarSugestoes(const IndiceNomes* indice, TabelaHash* tabela, size_t primeiro, size_t quantidade) {
+    size_t listados = (quantidade < NOMES_SUGERIDOS) ? quantidade : NOMES_SUGERIDOS;
+    escreverTexto(saida.silencioso ? "sugestoes" : "Mais de um suspeito serve: ");
+    for (size_t i = 0; i < listados; i++) {
+        escreverTexto(saida.silencioso ? "\t" : (i > 0) ? " / " : "");
+        escreverTexto(textoSimbolo(tabela->suspeitos[indice->suspeito[primeiro + i]]));
+    }
+    if (listados < quantidade) {
+        escrever(saida.silencioso ? "\t+%zu" : " (e mais %zu)", quantidade - listados);
+    }
+    escreverTexto(saida.silencioso ? "\n" : "\nDigite mais do nome: ");
+}
+
+void liberarIndiceNomes(IndiceNomes* indice) {
+    free(indice->chaves);
+    free(indice->deslocamento);
+    free(indice->suspeito);
+    indice->chaves = NULL;
+    indice->deslocamento = NULL;
+    indice->suspeito = NULL;
+    indice->quantidade = 0;
+}
+
+// --- Funções da Tabela de Símbolos ---
+
+// Sem memória: o que o jogo já montou sai antes do aviso, e o processo termina.
+static void sairSemMemoria(void) {
+    escreverTexto("Erro crítico: Falha na alocação de memória.\n");
+    descarregarSaida();
+    exit(1);
+}
+
+void* realocarOuSair(void* ptr, size_t bytes) {
+    void* novo = realloc(ptr, bytes);
+    atomic_fetch_add_explicit(&alocacoesSistema, 1, memory_order_relaxed);
+    if (novo == NULL) sairSemMemoria();
+    return novo;
+}
+
+// Como realocarOuSair, para um bloco novo já zerado (calloc).
+void* alocarZeradoOuSair(size_t quantidade, size_t tamanho) {
+    void* novo = calloc(quantidade, tamanho);
+    atomic_fetch_add_explicit(&alocacoesSistema, 1, memory_order_relaxed);
+    if (novo == NULL) sairSemMemoria();
+    return novo;
+}
+
+// Copia o texto para o bloco atual (ou para um novo, se não couber).
+static const char* copiarTexto(const char* texto, size_t tamanho) {
+    BlocoTexto* bloco = simbolos.blocos;
+
+    if (bloco == NULL || bloco->usados + tamanho > bloco->capacidade) {
+        size_t capacidade = (tamanho > TAM_BLOCO_TEXTO) ? tamanho : TAM_BLOCO_TEXTO;
+        bloco = (BlocoTexto*)realocarOuSair(NULL, sizeof(BlocoTexto) + capacidade);
+        bloco->usados = 0;
+        bloco->capacidade = capacidade;
+        bloco->proximo = simbolos.blocos;
+        simbolos.blocos = bloco;
+    }
+
+    char* destino = bloco->dados + bloco->usados;
+    memcpy(destino, texto, tamanho);
+    bloco->usados += tamanho;
+    return destino;
+}
+
+static int internarTexto(const char* texto, int copiar);
+
+// Posição do texto no índice, ou a posição livre onde ele entraria.
+static size_t localizarSimbolo(const char* texto, uint64_t hash) {
+    size_t mascara = simbolos.capacidadeIndice - 1;
+    size_t i = (size_t)hash & mascara;
+    size_t sondagens = 1;
+
+    while (simbolos.indice[i] != SEM_SIMBOLO) {
+        int id = simbolos.indice[i];
+        if (simbolos.hashes[id] == hash && strcmp(simbolos.textos[id], texto) == 0) break;
+        i = (i + 1) & mascara;
+        sondagens++;
+    }
+    ESTATISTICA_SONDAGENS(simbolos, sondagens);
+    return i;
+}
+
+// Troca o índice por um de 'capacidade' posições e reinsere os ids com os
+// hashes guardados.
+static void reconstruirIndiceSimbolos(size_t capacidade) {
+    free(simbolos.indice);
+    simbolos.indice = (int32_t*)realocarOuSair(NULL, capacidade * sizeof(int32_t));
+    simbolos.capacidadeIndice = capacidade;
+    for (size_t i = 0; i < capacidade; i++) simbolos.indice[i] = SEM_SIMBOLO;
+
+    for (size_t id = 0; id < simbolos.quantidade; id++) {
+        size_t i = (size_t)simbolos.hashes[id] & (capacidade - 1);
+        while (simbolos.indice[i] != SEM_SIMBOLO) i = (i + 1) & (capacidade - 1);
+        simbolos.indice[i] = (int32_t)id;
+    }
+}
+
+// Dobra o índice (ou cria o inicial).
+static void redimensionarIndiceSimbolos(void) {
+    reconstruirIndiceSimbolos(simbolos.capacidadeIndice ? simbolos.capacidadeIndice * 2 : 64);
+}
+
+/*
+ * reservarSimbolos() – prepara espaço para 'quantidade' textos de uma vez,
+ * evitando os redimensionamentos sucessivos em cargas grandes.
+ */
+void reservarSimbolos(size_t quantidade) {
+    if (quantidade > simbolos.capacidadeTextos) {
+        simbolos.capacidadeTextos = quantidade;
+        simbolos.textos = realocarOuSair(simbolos.textos, quantidade * sizeof(char*));
+        simbolos.hashes = realocarOuSair(simbolos.hashes, quantidade * sizeof(uint64_t));
+    }
+    size_t capacidade = simbolos.capacidadeIndice ? simbolos.capacidadeIndice : 64;
+    while (quantidade * 4 > capacidade * 3) capacidade *= 2;
+    if (capacidade != simbolos.capacidadeIndice) reconstruirIndiceSimbolos(capacidade);
+}
+
+/*
+ * buscarSimbolo() – id de um texto já internado, ou SEM_SIMBOLO.
+ */
+int buscarSimbolo(const char* texto) {
+    if (simbolos.capacidadeIndice == 0) return SEM_SIMBOLO;
+    return simbolos.indice[localizarSimbolo(texto, funcaoHash(texto))];
+}
+
+/*
+ * internar() – devolve o id do texto, cadastrando-o na primeira vez.
+ * Cada texto distinto é copiado uma única vez para a tabela de símbolos.
+ */
+int internar(const char* texto) {
+    return internarTexto(texto, 1);
+}
+
+/*
+ * internarExterno() – como internar(), mas sem copiar: o texto (por exemplo,
+ * dentro de um arquivo mapeado) precisa viver mais que a tabela de símbolos.
+ */
+int internarExterno(const char* texto) {
+    return internarTexto(texto, 0);
+}
+
+static int internarTexto(const char* texto, int copiar) {
+    if ((simbolos.quantidade + 1) * 4 > simbolos.capacidadeIndice * 3) {
+        redimensionarIndiceSimbolos();
+    }
+
+    uint64_t hash = funcaoHash(texto);
+    size_t posicao = localizarSimbolo(texto, hash);
+    if (simbolos.indice[posicao] != SEM_SIMBOLO) return simbolos.indice[posicao];
+
+    if (simbolos.quantidade == simbolos.capacidadeTextos) {
+        simbolos.capacidadeTextos = simbolos.capacidadeTextos ? simbolos.capacidadeTextos * 2 : 64;
+        simbolos.textos = realocarOuSair(simbolos.textos, simbolos.capacidadeTextos * sizeof(char*));
+        simbolos.hashes = realocarOuSair(simbolos.hashes, simbolos.capacidadeTextos * sizeof(uint64_t));
+    }
+
+    int id = (int)simbolos.quantidade++;
+    simbolos.textos[id] = copiar ? copiarTexto(texto, strlen(texto) + 1) : texto;
+    simbolos.hashes[id] = hash;
+    simbolos.indice[posicao] = id;
+    return id;
+}
+
+const char* textoSimbolo(int id) {
+    return simbolos.textos[id];
+}
+
+void liberarSimbolos(void) {
+    while (simbolos.blocos != NULL) {
+        BlocoTexto* temp = simbolos.blocos;
+        simbolos.blocos = temp->proximo;
+        free(temp);
+    }
+    free(simbolos.textos);
+    free(simbolos.hashes);
+    free(simbolos.indice);
+    memset(&simbolos, 0, sizeof(simbolos));
+}
+
+// --- Funções do Renderizador de Saída ---
+
+// write() até o fim, repetindo em escritas parciais ou interrompidas.
+static void escreverTudo(const char* dados, size_t tamanho) {
+    size_t enviados = 0;
+    while (enviados < tamanho) {
+        ssize_t n = write(STDOUT_FILENO, dados + enviados, tamanho - enviados);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break; // Saída fechada: descarta o resto
+        enviados += (size_t)n;
+    }
+    saida.descargas++;
+}
+
+/*
+ * descarregarSaida() – entrega o buffer ao sistema. Limpa o stdio antes,
+ * para que mensagens impressas com printf não fiquem fora de ordem.
+ */
+void descarregarSaida(void) {
+    fflush(stdout);
+    if (saida.usados > 0) escreverTudo(saida.dados, saida.usados);
+    saida.usados = 0;
+}
+
+// Copia um texto já pronto (sem interpretar formato).
+void escreverTexto(const char* texto) {
+    size_t tamanho = strlen(texto);
+    if (saida.usados + tamanho > TAM_BUFFER_SAIDA) {
+        descarregarSaida();
+        if (tamanho > TAM_BUFFER_SAIDA) { // Maior que o buffer: vai direto
+            escreverTudo(texto, tamanho);
+            return;
+        }
+    }
+    memcpy(saida.dados + saida.usados, texto, tamanho);
+    saida.usados += tamanho;
+}
+
+static void escreverFormatado(const char* formato, va_list argumentos) {
+    va_list copia;
+    va_copy(copia, argumentos);
+    size_t livre = TAM_BUFFER_SAIDA - saida.usados;
+    int tamanho = vsnprintf(saida.dados + saida.usados, livre, formato, argumentos);
+
+    if (tamanho >= 0 && (size_t)tamanho >= livre) {
+        // Não coube: descarrega e formata de novo no buffer vazio
+        descarregarSaida();
+        if ((size_t)tamanho < TAM_BUFFER_SAIDA) {
+            vsnprintf(saida.dados, TAM_BUFFER_SAIDA, formato, copia);
+        } else {
+            char* grande = realocarOuSair(NULL, (size_t)tamanho + 1);
+            vsnprintf(grande, (size_t)tamanho + 1, formato, copia);
+            escreverTexto(grande);
+            free(grande);
+            tamanho = 0;
+        }
+    }
+    if (tamanho > 0) saida.usados += (size_t)tamanho;
+    va_end(copia);
+}
+
+/*
+ * escrever() – como printf, mas no buffer do renderizador.
+ */
+void escrever(const char* formato, ...) {
+    va_list argumentos;
+    va_start(argumentos, formato);
+    escreverFormatado(formato, argumentos);
+    va_end(argumentos);
+}
+
+/*
+ * decorar() – banners, molduras e frases de ambientação: somem no modo
+ * silencioso, onde só ficam as linhas com dados.
+ */
+void decorar(const char* formato, ...) {
+    if (saida.silencioso) return;
+    va_list argumentos;
+    va_start(argumentos, formato);
+    escreverFormatado(formato, argumentos);
+    va_end(argumentos);
+}
+
+// --- Funções Auxiliares ---
+
+/*
+ * proximoEmOrdem() – um passo do percurso em-ordem de Morris: devolve o
+ * próximo nó (NULL no fim) sem recursão nem pilha. Ao descer à esquerda, o
+ * predecessor do nó ganha um fio temporário de volta a ele; o fio é desfeito
+ * quando o nó é visitado. A árvore só volta ao original se o percurso for
+ * até o fim.
+ */
+static PistaNode* proximoEmOrdem(PistaNode** cursor) {
+    PistaNode* atual = *cursor;
+
+    while (atual != NULL) {
+        if (atual->esquerda == NULL) {
+            *cursor = atual->direita;
+            return atual;
+        }
+        PistaNode* predecessor = atual->esquerda;
+        while (predecessor->direita != NULL && predecessor->direita != atual) {
+            predecessor = predecessor->direita;
+        }
+        if (predecessor->direita == NULL) {
+            predecessor->direita = atual; // Fio de volta
+            atual = atual->esquerda;
+        } else {
+            predecessor->direita = NULL;  // Subárvore esquerda concluída
+            *cursor = atual->direita;
+            return atual;
+        }
+    }
+    *cursor = NULL;
+    return NULL;
+}
+
+/*
+ * exibirPistas() – lista as pistas em ordem alfabética. Iterativa (Morris):
+ * memória extra constante mesmo numa árvore degenerada de milhões de nós.
+ */
+void exibirPistas(PistaNode* raiz) {
+    const char* marcador = saida.silencioso ? "coletada\t" : "- ";
+    PistaNode* cursor = raiz;
+    PistaNode* no;
+
+    while ((no = proximoEmOrdem(&cursor)) != NULL) {
+        escreverTexto(marcador);
+        escreverTexto(textoSimbolo(no->conteudo));
+        escreverTexto("\n");
+    }
+}
+
+// --- Funções da Arena do Caso ---
+
+void poolIniciar(Pool* pool, size_t tamanhoNo) {
+    // Arredonda o tamanho para manter cada nó alinhado dentro do bloco
+    // (os nós do jogo só contêm inteiros e ponteiros).
+    size_t alinhamento = _Alignof(void*);
+    pool->tamanhoNo = (tamanhoNo + alinhamento - 1) / alinhamento * alinhamento;
+    pool->primeiro = NULL;
+    pool->atual = NULL;
+    pool->alocacoes = 0;
+    pool->blocos = 0;
+}
+
+/*
+ * arenaIniciar() – prepara os pools tipados do caso.
+ */
+void arenaIniciar(ArenaCaso* arena) {
+    poolIniciar(&arena->salas, sizeof(Sala));
+    poolIniciar(&arena->pistas, sizeof(PistaNode));
+}
+
+/*
+ * poolAlocar() – entrega um nó do pool.
+ * Avança no bloco atual; quando ele enche, reaproveita o próximo bloco
+ * (sobra de um reset) ou pede um novo ao sistema.
+ */
+void* poolAlocar(Pool* pool) {
+    BlocoPool* bloco = pool->atual;
+
+    if (bloco == NULL || bloco->usados == NOS_POR_BLOCO) {
+        BlocoPool* proximo = (bloco != NULL) ? bloco->proximo : pool->primeiro;
+
+        if (proximo == NULL) {
+            proximo = realocarOuSair(NULL, sizeof(BlocoPool) + NOS_POR_BLOCO * pool->tamanhoNo);
+            proximo->proximo = NULL;
+            if (bloco != NULL) bloco->proximo = proximo;
+            else pool->primeiro = proximo;
+            pool->blocos++;
+        }
+        proximo->usados = 0;
+        pool->atual = bloco = proximo;
+    }
+
+    pool->alocacoes++;
+    return bloco->dados + (bloco->usados++) * pool->tamanhoNo;
+}
+
+/*
+ * arenaResetar() – descarta todos os nós do caso em O(1).
+ * Substitui os percursos liberarMapa/liberarPistas: os blocos
+ * continuam reservados e serão reaproveitados pelo próximo caso.
+ */
+void arenaResetar(ArenaCaso* arena) {
+    Pool* pools[] = { &arena->salas, &arena->pistas };
+
+    for (int i = 0; i < 2; i++) {
+        poolResetar(pools[i]);
+    }
+}
+
+// Descarta os nós de um pool só (ex.: as pistas de uma sessão, mantendo as salas).
+void poolResetar(Pool* pool) {
+    pool->atual = NULL;
+    pool->alocacoes = 0;
+}
+
+/*
+ * arenaDestruir() – devolve os blocos ao sistema (um free por bloco, não por nó).
+ */
+void arenaDestruir(ArenaCaso* arena) {
+    Pool* pools[] = { &arena->salas, &arena->pistas };
+
+    for (int i = 0; i < 2; i++) {
+        poolDestruir(pools[i]);
+    }
+}
+
+void poolDestruir(Pool* pool) {
+    BlocoPool* bloco = pool->primeiro;
+    while (bloco != NULL) {
+        BlocoPool* temp = bloco;
+        bloco = bloco->proximo;
+        free(temp);
+    }
+    poolIniciar(pool, pool->tamanhoNo);
+}
+
+/*
+ * arenaRelatorio() – mostra quantos nós e bytes cada pool entregou
+ * e quantos mallocs foram realmente feitos para isso.
+ */
+void arenaRelatorio(ArenaCaso* arena) {
+    const char* nomes[] = { "Salas", "Pistas" };
+    Pool* pools[] = { &arena->salas, &arena->pistas };
+    size_t totalNos = 0, totalBytes = 0, totalBlocos = 0;
+
+    escreverTexto("\n--- USO DA ARENA DO CASO ---\n");
+    for (int i = 0; i < 2; i++) {
+        size_t bytes = pools[i]->alocacoes * pools[i]->tamanhoNo;
+        escrever("%8zu nós  %10zu bytes  %4zu bloco(s)  -> %s\n",
+                 pools[i]->alocacoes, bytes, pools[i]->blocos, nomes[i]);
+        totalNos += pools[i]->alocacoes;
+        totalBytes += bytes;
+        totalBlocos += pools[i]->blocos;
+    }
+    escrever("Total: %zu nós em %zu bytes, com %zu malloc(s) em vez de %zu.\n",
+             totalNos, totalBytes, totalBlocos, totalNos);
+
+    size_t bytesTexto = 0;
+    for (BlocoTexto* bloco = simbolos.blocos; bloco != NULL; bloco = bloco->proximo) {
+        bytesTexto += bloco->usados;
+    }
+    escrever("Textos internados: %zu distintos em %zu bytes.\n", simbolos.quantidade, bytesTexto);
+}
+
+// ============================================================================
+// CASOS: MANSÃO PADRÃO E ARQUIVOS
+// ============================================================================
+
+// Gabarito da mansão padrão (fonte da tabela gerada logo abaixo).
+static const ParGabarito gabaritoOriginal[] = {
+    // Jardineiro
+    {"Pegadas de lama no chão", "Jardineiro"},
+    {"Terra revirada recente", "Jardineiro"},
+    // Mordomo
+    {"Relógio parado às 10h", "Mordomo"},
+    {"Taça de vinho quebrada", "Mordomo"},
+    // Governanta
+    {"Livro de venenos aberto", "Governanta"},
+    {"Chave enferrujada antiga", "Governanta"},
+};
+#define PARES_GABARITO_ORIGINAL (sizeof(gabaritoOriginal) / sizeof(gabaritoOriginal[0]))
+
+// --- Tabela gerada por "./Ultimo_Caso --gerar-gabarito" (não editar) ---
+// Ao mudar gabaritoOriginal ou funcaoHash, gere de novo e cole aqui; até lá
+// montarCasoPadrao recusa a tabela antiga e usa a dinâmica.
+static const EntradaGabarito entradasGabaritoPadrao[8] = {
+    [0] = {"Taça de vinho quebrada", 1, 0x12F003946524C2B6ULL},
+    [1] = {"Pegadas de lama no chão", 0, 0x9072FAD20D72A42EULL},
+    [2] = {"Relógio parado às 10h", 1, 0xCBE4BC41CAA15EBFULL},
+    [3] = {"Chave enferrujada antiga", 2, 0xE6D2FAA28F608D95ULL},
+    [4] = {"Livro de venenos aberto", 2, 0xBBF54AE86EC0DFD1ULL},
+    [7] = {"Terra revirada recente", 0, 0xDB4B609B1D4FDB4FULL},
+};
+static HashNode slotsGabaritoPadrao[8];
+static const char* const elencoGabaritoPadrao[3] = {"Jardineiro", "Mordomo", "Governanta"};
+static const GabaritoFixo gabaritoPadrao = {
+    entradasGabaritoPadrao, slotsGabaritoPadrao, elencoGabaritoPadrao, 6, 3, 3, 0xFE5DEFE9C5610885ULL};
+// --- Fim da tabela gerada ---
+
+// Confere a tabela gerada contra gabaritoOriginal (mesmos pares, nenhum a mais).
+static int gabaritoFixoConfere(TabelaHash* tabela) {
+    if (tabela->quantidade != PARES_GABARITO_ORIGINAL) return 0;
+    for (size_t i = 0; i < PARES_GABARITO_ORIGINAL; i++) {
+        const char* suspeito = encontrarSuspeito(tabela, (char*)gabaritoOriginal[i].pista);
+        if (suspeito == NULL || strcmp(suspeito, gabaritoOriginal[i].suspeito) != 0) return 0;
+    }
+    return 1;
+}
+
+/*
+ * montarGabaritoDinamico() – o gabarito padrão inserido par a par numa
+ * tabela dinâmica (reserva quando a tabela gerada não confere).
+ */
+void montarGabaritoDinamico(TabelaHash* tabela) {
+    iniciarHash(tabela);
+    for (size_t i = 0; i < PARES_GABARITO_ORIGINAL; i++) {
+        inserirNaHash(tabela, (char*)gabaritoOriginal[i].pista, (char*)gabaritoOriginal[i].suspeito);
+    }
+}
+
+/*
+ * montarCasoPadrao() – a mansão e o gabarito originais do jogo.
+ */
+void montarCasoPadrao(Caso* caso) {
+    INICIAR_FASE(FASE_CARGA);
+
+    // Mapa da Mansão (Árvore Binária Fixa)
+    Sala* mansao = criarSala("Hall de Entrada", "Pegadas de lama no chão");
+    
+    mansao->esquerda = criarSala("Sala de Estar", "Relógio parado às 10h");
+    mansao->direita = criarSala("Cozinha", ""); // Cozinha sem pista
+    
+    mansao->esquerda->esquerda = criarSala("Biblioteca", "Livro de venenos aberto");
+    mansao->esquerda->direita = criarSala("Jardim de Inverno", "Terra revirada recente");
+    
+    mansao->direita->esquerda = criarSala("Sala de Jantar", "Taça de vinho quebrada");
+    mansao->direita->direita = criarSala("Porão", "Chave enferrujada antiga");
+
+    caso->mansao = mansao;
+    caso->quantidadeSalas = 7;
+    caso->implicacoes = NULL; // Sem pesos extras: cada pista vale 1 ponto
+    caso->quantidadeImplicacoes = 0;
+    caso->capacidadeImplicacoes = 0;
+    caso->limiar = 0;
+    caso->portas = NULL;
+    caso->quantidadePortas = 0;
+    caso->mapeamento = NULL;
+    caso->tamanhoMapeamento = 0;
+
+    // Configuração das pistas e suspeitos (Gabarito do Jogo): a tabela
+    // gerada, se conferir com gabaritoOriginal; senão, a dinâmica
+    if (!usarGabaritoFixo(&caso->tabela, &gabaritoPadrao) || !gabaritoFixoConfere(&caso->tabela)) {
+        if (caso->tabela.fixo != NULL) liberarHash(&caso->tabela);
+        montarGabaritoDinamico(&caso->tabela);
+    }
+    ENCERRAR_FASE(FASE_CARGA);
+}
+
+// Escreve o texto como literal de C (UTF-8 passa como está).
+static void escreverLiteralC(const char* texto) {
+    putchar('"');
+    for (const unsigned char* c = (const unsigned char*)texto; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') printf("\\%c", *c);
+        else if (*c < 0x20) printf("\\%03o", *c);
+        else putchar(*c);
+    }
+    putchar('"');
+}
+
+/*
+ * gerarGabaritoFixo() – procura bits e semente com que os n pares caiam em
+ * posições distintas (posicaoFixa) e escreve a tabela em C na saída padrão.
+ * Começa com a menor potência de 2 >= n e dobra a cada 2^16 sementes sem
+ * sucesso; a tabela cresce ~n², então só serve a gabaritos pequenos.
+ */
+int gerarGabaritoFixo(const ParGabarito* pares, size_t n, const char* const* elenco, size_t k) {
+    uint64_t* hashes = realocarOuSair(NULL, (n + 1) * sizeof(uint64_t));
+    int* suspeitoDoPar = realocarOuSair(NULL, (n + 1) * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        hashes[i] = funcaoHash(pares[i].pista);
+        suspeitoDoPar[i] = -1;
+        for (size_t s = 0; s < k; s++) {
+            if (strcmp(elenco[s], pares[i].suspeito) == 0) suspeitoDoPar[i] = (int)s;
+        }
+    }
+
+    GabaritoFixo gabarito = {0};
+    size_t* posicao = NULL;
+    uint64_t semente = 88172645463325252ULL;
+    int achou = 0;
+    gabarito.bits = 1;
+    while (((size_t)1 << gabarito.bits) < n) gabarito.bits++;
+    for (; !achou && gabarito.bits <= 20; gabarito.bits++) {
+        size_t capacidade = (size_t)1 << gabarito.bits;
+        posicao = realocarOuSair(posicao, capacidade * sizeof(size_t));
+        for (int tentativa = 0; !achou && tentativa < (1 << 16); tentativa++) {
+            gabarito.semente = aleatorio(&semente);
+            memset(posicao, 0xFF, capacidade * sizeof(size_t));
+            achou = 1;
+            for (size_t i = 0; i < n && achou; i++) {
+                size_t p = posicaoFixa(&gabarito, hashes[i]);
+                achou = (posicao[p] == SIZE_MAX);
+                posicao[p] = i;
+            }
+        }
+        if (achou) break;
+    }
+
+    if (achou) {
+        size_t capacidade = (size_t)1 << gabarito.bits;
+        printf("static const EntradaGabarito entradasGabaritoPadrao[%zu] = {\n", capacidade);
+        for (size_t p = 0; p < capacidade; p++) {
+            size_t i = posicao[p];
+            if (i == SIZE_MAX) continue;
+            printf("    [%zu] = {", p);
+            escreverLiteralC(pares[i].pista);
+            printf(", %d, 0x%016llXULL},\n", suspeitoDoPar[i], (unsigned long long)hashes[i]);
+        }
+        printf("};\nstatic HashNode slotsGabaritoPadrao[%zu];\n", capacidade);
+        printf("static const char* const elencoGabaritoPadrao[%zu] = {", k ? k : 1);
+        for (size_t s = 0; s < k; s++) {
+            if (s > 0) printf(", ");
+            escreverLiteralC(elenco[s]);
+        }
+        printf("};\nstatic const GabaritoFixo gabaritoPadrao = {\n");
+        printf("    entradasGabaritoPadrao, slotsGabaritoPadrao, elencoGabaritoPadrao, %zu, %zu, %u, 0x%016llXULL};\n",
+               n, k, gabarito.bits, (unsigned long long)gabarito.semente);
+    } else {
+        printf("Erro: %zu pistas não cabem numa tabela sem colisões de até 2^20 posições.\n", n);
+    }
+
+    free(posicao);
+    free(suspeitoDoPar);
+    free(hashes);
+    return achou;
+}
+
+/*
+ * executarGeradorGabarito() – modo "--gerar-gabarito": sem caso, usa
+ * gabaritoOriginal (elenco na ordem em que os suspeitos aparecem, como na
+ * tabela dinâmica); com caso, as associações e o elenco carregados.
+ */
+int executarGeradorGabarito(Caso* caso) {
+    const char** elenco = NULL;
+    size_t k = 0;
+
+    if (caso == NULL) {
+        elenco = realocarOuSair(NULL, PARES_GABARITO_ORIGINAL * sizeof(char*));
+        for (size_t i = 0; i < PARES_GABARITO_ORIGINAL; i++) {
+            size_t s = 0;
+            while (s < k && strcmp(elenco[s], gabaritoOriginal[i].suspeito) != 0) s++;
+            if (s == k) elenco[k++] = gabaritoOriginal[i].suspeito;
+        }
+        int ok = gerarGabaritoFixo(gabaritoOriginal, PARES_GABARITO_ORIGINAL, elenco, k);
+        free(elenco);
+        return ok;
+    }
+
+    TabelaHash* tabela = &caso->tabela;
+    ParGabarito* pares = realocarOuSair(NULL, (tabela->quantidade + 1) * sizeof(ParGabarito));
+    size_t n = 0;
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        HashNode* slot = &tabela->slots[i];
+        if (slot->pista == SEM_SIMBOLO) continue;
+        pares[n].pista = textoSimbolo(slot->pista);
+        pares[n++].suspeito = textoSimbolo(tabela->suspeitos[slot->suspeito]);
+    }
+    k = tabela->quantidadeSuspeitos;
+    elenco = realocarOuSair(NULL, (k + 1) * sizeof(char*));
+    for (size_t s = 0; s < k; s++) elenco[s] = textoSimbolo(tabela->suspeitos[s]);
+    int ok = gerarGabaritoFixo(pares, n, elenco, k);
+    free(elenco);
+    free(pares);
+    return ok;
+}
+
+// Remove espaços e quebras de linha das pontas (altera a string).
+static char* aparar(char* texto) {
+    while (isspace((unsigned char)*texto)) texto++;
+    char* fim = texto + strlen(texto);
+    while (fim > texto && isspace((unsigned char)fim[-1])) *--fim = '\0';
+    return texto;
+}
+
+// Conta as salas alcançáveis a partir da entrada, percorrendo em largura
+// (sem recursão). Supõe que nenhuma sala tem duas salas de origem.
+static size_t contarSalasAlcancaveis(Sala* raiz, size_t quantidade) {
+    Sala** fila = realocarOuSair(NULL, quantidade * sizeof(Sala*));
+    size_t inicio = 0, fim = 0;
+
+    fila[fim++] = raiz;
+    while (inicio < fim) {
+        Sala* sala = fila[inicio++];
+        if (sala->esquerda) fila[fim++] = sala->esquerda;
+        if (sala->direita) fila[fim++] = sala->direita;
+    }
+    free(fila);
+    return fim;
+}
+
+// Acrescenta uma implicação (ids já internados; suspeito já no elenco).
+static void adicionarImplicacao(Caso* caso, int pista, int suspeito, int32_t peso) {
+    if (caso->quantidadeImplicacoes == caso->capacidadeImplicacoes) {
+        caso->capacidadeImplicacoes = caso->capacidadeImplicacoes ? caso->capacidadeImplicacoes * 2 : 16;
+        caso->implicacoes = realocarOuSair(caso->implicacoes, caso->capacidadeImplicacoes * sizeof(Implicacao));
+    }
+    Implicacao* implicacao = &caso->implicacoes[caso->quantidadeImplicacoes++];
+    implicacao->pista = pista;
+    implicacao->suspeito = suspeito;
+    implicacao->peso = peso;
+}
+
+/*
+ * carregarCasoTexto() – lê um caso no formato texto:
+ *
+ *   # comentário
+ *   sala <id> <esquerda> <direita> <nome> | <pista>
+ *   suspeito <pista> | <suspeito>
+ *   implica <pista> | <suspeito> | <peso>
+ *   limiar <pontos>
+ *   porta <id> <id>
+ *
+ * Os ids das salas vão de 0 (entrada) a n-1; -1 indica que não há saída.
+ * A pista da sala é opcional. "suspeito" é o suspeito principal da pista
+ * (vale 1 ponto); "implica" soma mais um peso contra outro suspeito (ou o
+ * mesmo). "limiar" troca os pontos exigidos para condenar (padrão: 2).
+ * "porta" liga duas salas nos dois sentidos, fora da árvore (só no modo
+ * mapa; pode fechar ciclos). Devolve 1 em caso de sucesso.
+ */
+int carregarCasoTexto(Caso* caso, const char* arquivo) {
+    memset(caso, 0, sizeof(*caso)); // Seguro para liberarCaso() mesmo se falhar
+    FILE* entrada = fopen(arquivo, "r");
+    if (entrada == NULL) {
+        printf("Erro: não foi possível abrir o caso '%s'.\n", arquivo);
+        return 0;
+    }
+
+    iniciarHash(&caso->tabela);
+
+    // Salas por id, e os filhos de cada uma (ligados depois da leitura)
+    Sala** salas = NULL;
+    long (*filhos)[2] = NULL;
+    long (*portas)[2] = NULL; // Ids do arquivo, trocados pela ordem em largura no fim
+    size_t capacidade = 0, capacidadePortas = 0;
+    char linha[1024];
+    int numeroLinha = 0, ok = 1;
+
+    while (ok && fgets(linha, sizeof(linha), entrada) != NULL) {
+        char* texto = aparar(linha);
+        long id, esquerda, direita;
+        int lidos = 0;
+        numeroLinha++;
+
+        if (texto[0] == '\0' || texto[0] == '#') continue;
+
+        if (sscanf(texto, "sala %ld %ld %ld %n", &id, &esquerda, &direita, &lidos) == 3 && lidos > 0) {
+            char* nome = texto + lidos;
+            char* pista = strchr(nome, '|');
+            if (pista != NULL) *pista++ = '\0';
+
+            if (id < 0 || id > INT32_MAX - 1) {
+                ok = 0;
+                break;
+            }
+            if ((size_t)id >= capacidade) {
+                size_t nova = capacidade ? capacidade : 64;
+                while (nova <= (size_t)id) nova *= 2;
+                salas = realocarOuSair(salas, nova * sizeof(Sala*));
+                filhos = realocarOuSair(filhos, nova * sizeof(*filhos));
+                memset(salas + capacidade, 0, (nova - capacidade) * sizeof(Sala*));
+                capacidade = nova;
+            }
+            if (salas[id] != NULL) {
+                ok = 0;
+                break;
+            }
+            salas[id] = criarSala(aparar(nome), pista ? aparar(pista) : NULL);
+            filhos[id][0] = esquerda;
+            filhos[id][1] = direita;
+            if ((size_t)id + 1 > caso->quantidadeSalas) caso->quantidadeSalas = (size_t)id + 1;
+        } else if (strncmp(texto, "suspeito ", 9) == 0 && strchr(texto, '|') != NULL) {
+            char* pista = texto + 9;
+            char* suspeito = strchr(pista, '|');
+            *suspeito++ = '\0';
+            inserirNaHash(&caso->tabela, aparar(pista), aparar(suspeito));
+        } else if (strncmp(texto, "implica ", 8) == 0 && strchr(texto, '|') != NULL) {
+            char* pista = texto + 8;
+            char* suspeito = strchr(pista, '|');
+            *suspeito++ = '\0';
+            char* peso = strchr(suspeito, '|');
+            char* fimPeso = NULL;
+            long valor = 0;
+            if (peso != NULL) {
+                *peso++ = '\0';
+                valor = strtol(peso, &fimPeso, 10);
+            }
+            pista = aparar(pista);
+            suspeito = aparar(suspeito);
+            if (peso == NULL || fimPeso == peso || *aparar(fimPeso) != '\0' || valor < 1 || valor > INT32_MAX ||
+                pista[0] == '\0' || suspeito[0] == '\0') {
+                ok = 0;
+            } else {
+                int idSuspeito = internar(suspeito);
+                registrarSuspeito(&caso->tabela, idSuspeito);
+                adicionarImplicacao(caso, internar(pista), idSuspeito, (int32_t)valor);
+            }
+        } else if (sscanf(texto, "limiar %ld %n", &id, &lidos) == 1 && lidos > 0 && texto[lidos] == '\0') {
+            if (id < 1) ok = 0;
+            else caso->limiar = id;
+        } else if (sscanf(texto, "porta %ld %ld %n", &esquerda, &direita, &lidos) == 2 && lidos > 0 &&
+                   texto[lidos] == '\0') {
+            if (esquerda < 0 || direita < 0 || esquerda == direita) {
+                ok = 0;
+                break;
+            }
+            if (caso->quantidadePortas == capacidadePortas) {
+                capacidadePortas = capacidadePortas ? capacidadePortas * 2 : 16;
+                portas = realocarOuSair(portas, capacidadePortas * sizeof(*portas));
+            }
+            portas[caso->quantidadePortas][0] = esquerda;
+            portas[caso->quantidadePortas++][1] = direita;
+        } else {
+            ok = 0;
+        }
+    }
+    fclose(entrada);
+
+    if (!ok) {
+        printf("Erro: linha %d inválida em '%s'.\n", numeroLinha, arquivo);
+    }
+
+    for (size_t i = 0; ok && i < caso->quantidadeSalas; i++) {
+        if (salas[i] == NULL) {
+            printf("Erro: a sala %zu não foi definida em '%s'.\n", i, arquivo);
+            ok = 0;
+        }
+    }
+
+    // Liga os caminhos; cada sala só pode ter uma sala de origem
+    unsigned char* temOrigem = alocarZeradoOuSair(caso->quantidadeSalas + 1, 1);
+    for (size_t i = 0; ok && i < caso->quantidadeSalas; i++) {
+        for (int lado = 0; lado < 2 && ok; lado++) {
+            long filho = filhos[i][lado];
+            if (filho < 0) continue;
+            if ((size_t)filho >= caso->quantidadeSalas || filho == 0 || temOrigem[filho]) {
+                printf("Erro: caminho inválido da sala %zu para a sala %ld.\n", i, filho);
+                ok = 0;
+                break;
+            }
+            temOrigem[filho] = 1;
+            if (lado == 0) salas[i]->esquerda = salas[filho];
+            else salas[i]->direita = salas[filho];
+        }
+    }
+    free(temOrigem);
+
+    if (ok && caso->quantidadeSalas == 0) {
+        printf("Erro: o caso '%s' não tem salas.\n", arquivo);
+        ok = 0;
+    }
+    if (ok && contarSalasAlcancaveis(salas[0], caso->quantidadeSalas) != caso->quantidadeSalas) {
+        printf("Erro: as salas de '%s' não formam uma árvore a partir da sala 0.\n", arquivo);
+        ok = 0;
+    }
+    if (ok) caso->mansao = salas[0];
+
+    // Portas: ids do arquivo -> posição em largura (a mesma ordem de
+    // compactarMansao e do .dqc, filho esquerdo antes do direito)
+    if (ok && caso->quantidadePortas > 0) {
+        size_t n = caso->quantidadeSalas;
+        uint32_t* ordem = realocarOuSair(NULL, n * sizeof(uint32_t));
+        long* fila = realocarOuSair(NULL, n * sizeof(long));
+        size_t fim = 0;
+        fila[fim++] = 0;
+        for (size_t i = 0; i < fim; i++) {
+            ordem[fila[i]] = (uint32_t)i;
+            if (filhos[fila[i]][0] >= 0) fila[fim++] = filhos[fila[i]][0];
+            if (filhos[fila[i]][1] >= 0) fila[fim++] = filhos[fila[i]][1];
+        }
+        caso->portas = realocarOuSair(NULL, caso->quantidadePortas * sizeof(PortaMapa));
+        for (size_t i = 0; ok && i < caso->quantidadePortas; i++) {
+            if ((size_t)portas[i][0] >= n || (size_t)portas[i][1] >= n) {
+                printf("Erro: porta entre salas inexistentes (%ld, %ld) em '%s'.\n", portas[i][0], portas[i][1],
+                       arquivo);
+                ok = 0;
+                break;
+            }
+            caso->portas[i].a = ordem[portas[i][0]];
+            caso->portas[i].b = ordem[portas[i][1]];
+        }
+        free(ordem);
+        free(fila);
+    }
+
+    free(salas);
+    free(filhos);
+    free(portas);
+    if (!ok) liberarCaso(caso);
+    return ok;
+}
+
+/*
+ * compilarCaso() – grava o caso no formato binário (.dqc).
+ * As salas são numeradas em largura; cada registro tem o layout de Sala,
+ * com os filhos guardados como índice + 1 no lugar dos ponteiros.
+ */
+int compilarCaso(Caso* caso, const char* destino) {
+    CabecalhoCaso cabecalho;
+    size_t n = caso->quantidadeSalas;
+    Sala** fila = realocarOuSair(NULL, n * sizeof(Sala*));
+    Sala* registros = realocarOuSair(NULL, n * sizeof(Sala));
+    size_t inicio = 0, fim = 0;
+
+    fila[fim++] = caso->mansao;
+    while (inicio < fim) {
+        Sala* sala = fila[inicio];
+        Sala* registro = &registros[inicio++];
+        registro->nome = sala->nome;
+        registro->pista = sala->pista;
+        registro->esquerda = NULL;
+        registro->direita = NULL;
+        if (sala->esquerda) {
+            registro->esquerda = (Sala*)(uintptr_t)(fim + 1);
+            fila[fim++] = sala->esquerda;
+        }
+        if (sala->direita) {
+            registro->direita = (Sala*)(uintptr_t)(fim + 1);
+            fila[fim++] = sala->direita;
+        }
+    }
+    free(fila);
+
+    // Textos: tabela de deslocamentos seguida do conteúdo
+    uint64_t* deslocamentos = realocarOuSair(NULL, (simbolos.quantidade + 1) * sizeof(uint64_t));
+    uint64_t bytesTextos = 0;
+    for (size_t id = 0; id < simbolos.quantidade; id++) {
+        deslocamentos[id] = bytesTextos;
+        bytesTextos += strlen(simbolos.textos[id]) + 1;
+    }
+
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_CASO, 4);
+    cabecalho.versao = VERSAO_CASO;
+    cabecalho.quantidadeSimbolos = simbolos.quantidade;
+    cabecalho.quantidadeSalas = n;
+    cabecalho.quantidadeAssociacoes = caso->tabela.quantidade;
+    cabecalho.deslocamentoTextos = sizeof(CabecalhoCaso);
+    uint64_t fimTextos = cabecalho.deslocamentoTextos + simbolos.quantidade * sizeof(uint64_t) + bytesTextos;
+    cabecalho.deslocamentoSalas = (fimTextos + 7) / 8 * 8;
+    cabecalho.deslocamentoAssociacoes = cabecalho.deslocamentoSalas + n * sizeof(Sala);
+    cabecalho.quantidadeSuspeitos = caso->tabela.quantidadeSuspeitos;
+    cabecalho.deslocamentoElenco = cabecalho.deslocamentoAssociacoes + caso->tabela.quantidade * 2 * sizeof(int32_t);
+    cabecalho.quantidadeImplicacoes = caso->quantidadeImplicacoes;
+    cabecalho.deslocamentoImplicacoes = cabecalho.deslocamentoElenco +
+                                        caso->tabela.quantidadeSuspeitos * sizeof(int32_t);
+    cabecalho.limiar = caso->limiar;
+    cabecalho.quantidadePortas = caso->quantidadePortas;
+    cabecalho.deslocamentoPortas = cabecalho.deslocamentoImplicacoes +
+                                   caso->quantidadeImplicacoes * sizeof(Implicacao);
+    cabecalho.tamanhoArquivo = cabecalho.deslocamentoPortas + caso->quantidadePortas * sizeof(PortaMapa);
+
+    FILE* saida = fopen(destino, "wb");
+    if (saida == NULL) {
+        printf("Erro: não foi possível criar '%s'.\n", destino);
+        free(deslocamentos);
+        free(registros);
+        return 0;
+    }
+
+    static const char zeros[8] = {0};
+    fwrite(&cabecalho, sizeof(cabecalho), 1, saida);
+    fwrite(deslocamentos, sizeof(uint64_t), simbolos.quantidade, saida);
+    for (size_t id = 0; id < simbolos.quantidade; id++) {
+        fwrite(simbolos.textos[id], 1, strlen(simbolos.textos[id]) + 1, saida);
+    }
+    fwrite(zeros, 1, cabecalho.deslocamentoSalas - fimTextos, saida);
+    fwrite(registros, sizeof(Sala), n, saida);
+
+    // Associações agrupadas por suspeito (ordenação por contagem)
+    TabelaHash* tabela = &caso->tabela;
+    size_t* inicioGrupo = alocarZeradoOuSair(tabela->quantidadeSuspeitos + 1, sizeof(size_t));
+    int32_t* pares = realocarOuSair(NULL, (tabela->quantidade + 1) * 2 * sizeof(int32_t));
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        if (tabela->slots[i].pista != SEM_SIMBOLO) inicioGrupo[tabela->slots[i].suspeito + 1]++;
+    }
+    for (size_t k = 0; k < tabela->quantidadeSuspeitos; k++) inicioGrupo[k + 1] += inicioGrupo[k];
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        HashNode* slot = &tabela->slots[i];
+        if (slot->pista == SEM_SIMBOLO) continue;
+        size_t posicao = inicioGrupo[slot->suspeito]++;
+        pares[2 * posicao] = slot->pista;
+        pares[2 * posicao + 1] = tabela->suspeitos[slot->suspeito];
+    }
+    fwrite(pares, 2 * sizeof(int32_t), tabela->quantidade, saida);
+    free(inicioGrupo);
+    free(pares);
+
+    // Elenco na ordem do caso (inclui suspeitos só de implicações) e os pesos
+    for (size_t k = 0; k < tabela->quantidadeSuspeitos; k++) {
+        int32_t id = tabela->suspeitos[k];
+        fwrite(&id, sizeof(int32_t), 1, saida);
+    }
+    if (caso->quantidadeImplicacoes > 0) {
+        fwrite(caso->implicacoes, sizeof(Implicacao), caso->quantidadeImplicacoes, saida);
+    }
+    if (caso->quantidadePortas > 0) fwrite(caso->portas, sizeof(PortaMapa), caso->quantidadePortas, saida);
+
+    int ok = (ferror(saida) == 0);
+    ok = (fclose(saida) == 0) && ok;
+    if (!ok) printf("Erro: falha ao gravar '%s'.\n", destino);
+
+    free(deslocamentos);
+    free(registros);
+    return ok;
+}
+
+/*
+ * carregarCasoBinario() – mapeia um .dqc e usa as salas no próprio lugar.
+ * O mapeamento é privado (copy-on-write): os índices dos filhos são trocados
+ * por ponteiros e os ids dos textos são ajustados à tabela de símbolos atual,
+ * sem nenhuma alocação por sala. Essas escritas sujam todas as páginas das
+ * salas, que o kernel copia para o processo (a memória delas é a de uma
+ * alocação comum); só os textos, apenas lidos, ficam compartilhados com o
+ * cache do arquivo e não são copiados.
+ */
+int carregarCasoBinario(Caso* caso, const char* arquivo) {
+    memset(caso, 0, sizeof(*caso)); // Seguro para liberarCaso() mesmo se falhar
+    int fd = open(arquivo, O_RDONLY);
+    struct stat info;
+
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CabecalhoCaso)) {
+        printf("Erro: não foi possível abrir o caso '%s'.\n", arquivo);
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+
+    size_t tamanho = (size_t)info.st_size;
+    unsigned char* base = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Erro: não foi possível mapear o caso '%s'.\n", arquivo);
+        return 0;
+    }
+
+    CabecalhoCaso* cabecalho = (CabecalhoCaso*)base;
+    uint64_t nSimbolos = cabecalho->quantidadeSimbolos;
+    uint64_t nSalas = cabecalho->quantidadeSalas;
+    uint64_t nAssociacoes = cabecalho->quantidadeAssociacoes;
+    uint64_t nSuspeitos = cabecalho->quantidadeSuspeitos;
+    uint64_t nImplicacoes = cabecalho->quantidadeImplicacoes;
+    uint64_t nPortas = cabecalho->quantidadePortas;
+    // Deslocamentos limitados ao arquivo antes de qualquer conta: com eles e
+    // as quantidades abaixo de 'tamanho', as somas não dão a volta no uint64
+    int valido = memcmp(cabecalho->magica, MAGICA_CASO, 4) == 0 &&
+                 cabecalho->versao == VERSAO_CASO &&
+                 cabecalho->tamanhoArquivo == tamanho &&
+                 cabecalho->deslocamentoTextos == sizeof(CabecalhoCaso) &&
+                 cabecalho->deslocamentoSalas <= tamanho && cabecalho->deslocamentoAssociacoes <= tamanho &&
+                 cabecalho->deslocamentoElenco <= tamanho && cabecalho->deslocamentoImplicacoes <= tamanho &&
+                 cabecalho->deslocamentoPortas <= tamanho &&
+                 nSimbolos < INT32_MAX && nSalas > 0 && nSalas < INT32_MAX &&
+                 nAssociacoes <= tamanho && nSuspeitos <= nSimbolos && nImplicacoes <= tamanho &&
+                 nPortas <= tamanho &&
+                 cabecalho->limiar >= 0 &&
+                 cabecalho->deslocamentoTextos + nSimbolos * sizeof(uint64_t) <= cabecalho->deslocamentoSalas &&
+                 cabecalho->deslocamentoSalas % 8 == 0 &&
+                 cabecalho->deslocamentoSalas + nSalas * sizeof(Sala) == cabecalho->deslocamentoAssociacoes &&
+                 cabecalho->deslocamentoAssociacoes + nAssociacoes * 2 * sizeof(int32_t) ==
+                     cabecalho->deslocamentoElenco &&
+                 cabecalho->deslocamentoElenco + nSuspeitos * sizeof(int32_t) == cabecalho->deslocamentoImplicacoes &&
+                 cabecalho->deslocamentoImplicacoes + nImplicacoes * sizeof(Implicacao) ==
+                     cabecalho->deslocamentoPortas &&
+                 cabecalho->deslocamentoPortas + nPortas * sizeof(PortaMapa) == tamanho;
+    if (!valido) {
+        printf("Erro: '%s' não é um caso compilado válido (versão %d).\n", arquivo, VERSAO_CASO);
+        munmap(base, tamanho);
+        return 0;
+    }
+
+    // Textos: registrados sem cópia; 'ids' traduz id do arquivo -> id atual
+    const uint64_t* deslocamentos = (const uint64_t*)(base + cabecalho->deslocamentoTextos);
+    const char* textos = (const char*)(deslocamentos + nSimbolos);
+    uint64_t bytesTextos = cabecalho->deslocamentoSalas - (uint64_t)((const unsigned char*)textos - base);
+    int* ids = realocarOuSair(NULL, (nSimbolos + 1) * sizeof(int));
+    reservarSimbolos(simbolos.quantidade + nSimbolos);
+    for (uint64_t i = 0; i < nSimbolos && valido; i++) {
+        valido = deslocamentos[i] < bytesTextos &&
+                 memchr(textos + deslocamentos[i], '\0', bytesTextos - deslocamentos[i]) != NULL;
+        if (valido) ids[i] = internarExterno(textos + deslocamentos[i]);
+    }
+
+    // Salas: índice + 1 -> ponteiro dentro do próprio mapeamento. Como no
+    // formato texto, cada sala tem no máximo uma sala de origem e todas
+    // precisam ser alcançáveis da sala 0
+    Sala* salas = (Sala*)(base + cabecalho->deslocamentoSalas);
+    unsigned char* temOrigem = alocarZeradoOuSair(nSalas + 1, 1);
+    for (uint64_t i = 0; i < nSalas && valido; i++) {
+        uintptr_t esquerda = (uintptr_t)salas[i].esquerda;
+        uintptr_t direita = (uintptr_t)salas[i].direita;
+        valido = salas[i].nome >= 0 && (uint64_t)salas[i].nome < nSimbolos &&
+                 salas[i].pista >= SEM_SIMBOLO && salas[i].pista < (int64_t)nSimbolos &&
+                 esquerda <= nSalas && direita <= nSalas &&
+                 (esquerda == 0 || esquerda - 1 > i) && (direita == 0 || direita - 1 > i) &&
+                 (esquerda == 0 || !temOrigem[esquerda - 1]) && (direita == 0 || !temOrigem[direita - 1]) &&
+                 (esquerda == 0 || esquerda != direita);
+        if (!valido) break;
+        if (esquerda) temOrigem[esquerda - 1] = 1;
+        if (direita) temOrigem[direita - 1] = 1;
+        salas[i].nome = ids[salas[i].nome];
+        if (salas[i].pista != SEM_SIMBOLO) salas[i].pista = ids[salas[i].pista];
+        salas[i].esquerda = esquerda ? &salas[esquerda - 1] : NULL;
+        salas[i].direita = direita ? &salas[direita - 1] : NULL;
+    }
+    free(temOrigem);
+    valido = valido && contarSalasAlcancaveis(&salas[0], nSalas) == nSalas;
+
+    // Elenco primeiro (mesma ordem do caso de origem), depois os pares
+    iniciarHash(&caso->tabela);
+    const int32_t* elenco = (const int32_t*)(base + cabecalho->deslocamentoElenco);
+    for (uint64_t i = 0; i < nSuspeitos && valido; i++) {
+        valido = elenco[i] >= 0 && (uint64_t)elenco[i] < nSimbolos &&
+                 indiceDoSuspeito(&caso->tabela, ids[elenco[i]]) < 0;
+        if (valido) registrarSuspeito(&caso->tabela, ids[elenco[i]]);
+    }
+    reservarHash(&caso->tabela, nAssociacoes);
+    const int32_t* pares = (const int32_t*)(base + cabecalho->deslocamentoAssociacoes);
+    for (uint64_t i = 0; i < nAssociacoes && valido; i++) {
+        valido = pares[2 * i] >= 0 && (uint64_t)pares[2 * i] < nSimbolos &&
+                 pares[2 * i + 1] >= 0 && (uint64_t)pares[2 * i + 1] < nSimbolos &&
+                 indiceDoSuspeito(&caso->tabela, ids[pares[2 * i + 1]]) >= 0;
+        if (valido) inserirNaHashIds(&caso->tabela, ids[pares[2 * i]], ids[pares[2 * i + 1]]);
+    }
+
+    // Implicações: copiadas com os ids traduzidos (o suspeito deve estar no elenco)
+    const Implicacao* implicacoes = (const Implicacao*)(base + cabecalho->deslocamentoImplicacoes);
+    for (uint64_t i = 0; i < nImplicacoes && valido; i++) {
+        Implicacao implicacao = implicacoes[i];
+        valido = implicacao.pista >= 0 && (uint64_t)implicacao.pista < nSimbolos &&
+                 implicacao.suspeito >= 0 && (uint64_t)implicacao.suspeito < nSimbolos && implicacao.peso >= 1 &&
+                 indiceDoSuspeito(&caso->tabela, ids[implicacao.suspeito]) >= 0;
+        if (valido) adicionarImplicacao(caso, ids[implicacao.pista], ids[implicacao.suspeito], implicacao.peso);
+    }
+    caso->limiar = cabecalho->limiar;
+    free(ids);
+
+    // Portas: já estão em índices em largura; só conferidas e copiadas
+    const PortaMapa* portas = (const PortaMapa*)(base + cabecalho->deslocamentoPortas);
+    if (valido && nPortas > 0) {
+        caso->portas = realocarOuSair(NULL, nPortas * sizeof(PortaMapa));
+        caso->quantidadePortas = nPortas;
+        for (uint64_t i = 0; i < nPortas && valido; i++) {
+            valido = portas[i].a < nSalas && portas[i].b < nSalas && portas[i].a != portas[i].b;
+            caso->portas[i] = portas[i];
+        }
+    }
+
+    if (!valido) {
+        // Os textos já registrados apontam para o arquivo: a tabela de
+        // símbolos é descartada junto com o mapeamento.
+        printf("Erro: conteúdo inválido no caso compilado '%s'.\n", arquivo);
+        liberarCaso(caso);
+        liberarSimbolos();
+        munmap(base, tamanho);
+        return 0;
+    }
+
+    caso->mansao = &salas[0];
+    caso->quantidadeSalas = nSalas;
+    caso->mapeamento = base;
+    caso->tamanhoMapeamento = tamanho;
+    return 1;
+}
+
+// Pontos exigidos para condenar no caso.
+int64_t limiarDoCaso(const Caso* caso) {
+    return (caso->limiar > 0) ? caso->limiar : PROVAS_PARA_CONDENAR;
+}
+
+/*
+ * carregarCaso() – escolhe o formato pela assinatura do arquivo.
+ */
+int carregarCaso(Caso* caso, const char* arquivo) {
+    char magica[4] = {0};
+    FILE* entrada = fopen(arquivo, "rb");
+
+    memset(caso, 0, sizeof(*caso));
+    if (entrada == NULL) {
+        printf("Erro: não foi possível abrir o caso '%s'.\n", arquivo);
+        return 0;
+    }
+    size_t lidos = fread(magica, 1, 4, entrada);
+    fclose(entrada);
+
+    INICIAR_FASE(FASE_CARGA);
+    int ok = (lidos == 4 && memcmp(magica, MAGICA_CASO, 4) == 0) ? carregarCasoBinario(caso, arquivo)
+                                                                   : carregarCasoTexto(caso, arquivo);
+    ENCERRAR_FASE(FASE_CARGA);
+    return ok;
+}
+
+/*
+ * liberarCaso() – libera a tabela, as implicações e as portas e desfaz o
+ * mapeamento do arquivo.
+ * As salas montadas na arena são descartadas pelo reset da arena.
+ * Se o caso veio de um .dqc, liberarSimbolos() deve ser chamada antes.
+ */
+void liberarCaso(Caso* caso) {
+    liberarHash(&caso->tabela);
+    free(caso->implicacoes);
+    caso->implicacoes = NULL;
+    caso->quantidadeImplicacoes = 0;
+    caso->capacidadeImplicacoes = 0;
+    free(caso->portas);
+    caso->portas = NULL;
+    caso->quantidadePortas = 0;
+    if (caso->mapeamento != NULL) {
+        munmap(caso->mapeamento, caso->tamanhoMapeamento);
+    }
+    caso->mansao = NULL;
+    caso->mapeamento = NULL;
+}
+
+// --- Funções da Mansão Compacta ---
+
+/*
+ * compactarMansao() – copia a árvore de salas para o layout em largura.
+ * A sala 0 é a entrada. Devolve 0 se a mansão passar do limite de índices.
+ */
+int compactarMansao(Sala* raiz, size_t quantidade, MansaoCompacta* compacta) {
+    if (quantidade > MAX_SALAS_COMPACTAS) {
+        escrever("Erro: mansão grande demais para o layout compacto.\n");
+        descarregarSaida(); // Também nos modos que escrevem com printf
+        return 0;
+    }
+
+    Sala** fila = realocarOuSair(NULL, quantidade * sizeof(Sala*));
+    compacta->quantidade = quantidade;
+    compacta->ligacoes = realocarOuSair(NULL, quantidade * sizeof(uint32_t));
+    compacta->pistas = realocarOuSair(NULL, quantidade * sizeof(int32_t));
+    compacta->nomes = realocarOuSair(NULL, quantidade * sizeof(int32_t));
+
+    // Em largura, os filhos entram na fila em posições consecutivas: a
+    // posição do primeiro filho é o tamanho da fila no momento.
+    size_t fim = 0;
+    fila[fim++] = raiz;
+    for (size_t i = 0; i < fim; i++) {
+        Sala* sala = fila[i];
+        uint32_t saidas = 0;
+        uint32_t primeiroFilho = (uint32_t)fim;
+
+        if (sala->esquerda) {
+            saidas |= SAIDA_ESQUERDA;
+            fila[fim++] = sala->esquerda;
+        }
+        if (sala->direita) {
+            saidas |= SAIDA_DIREITA;
+            fila[fim++] = sala->direita;
+        }
+        compacta->ligacoes[i] = (primeiroFilho << 2) | saidas;
+        compacta->pistas[i] = sala->pista;
+        compacta->nomes[i] = sala->nome;
+    }
+    free(fila);
+    return 1;
+}
+
+static inline uint32_t compactaEsquerda(const MansaoCompacta* m, uint32_t sala) {
+    uint32_t ligacao = m->ligacoes[sala];
+    return (ligacao & SAIDA_ESQUERDA) ? (ligacao >> 2) : SEM_SALA;
+}
+
+static inline uint32_t compactaDireita(const MansaoCompacta* m, uint32_t sala) {
+    uint32_t ligacao = m->ligacoes[sala];
+    return (ligacao & SAIDA_DIREITA) ? (ligacao >> 2) + (ligacao & SAIDA_ESQUERDA) : SEM_SALA;
+}
+
+static inline int compactaEhFolha(const MansaoCompacta* m, uint32_t sala) {
+    return (m->ligacoes[sala] & (SAIDA_ESQUERDA | SAIDA_DIREITA)) == 0;
+}
+
+void liberarMansaoCompacta(MansaoCompacta* compacta) {
+    free(compacta->ligacoes);
+    free(compacta->pistas);
+    free(compacta->nomes);
+    memset(compacta, 0, sizeof(*compacta));
+}
+
+// ============================================================================
+// PERITO (ROTAS PRÉ-CALCULADAS)
+// ============================================================================
+
+/*
+ * marcarPistasNovas() – para cada sala, a sua pista se ela for a primeira
+ * ocorrência daquela pista no caminho desde a entrada, ou SEM_SIMBOLO.
+ * Percurso em profundidade com pilha explícita (entrada e saída de cada
+ * sala) e um contador por pista dos que estão no caminho atual.
+ */
+static int32_t* marcarPistasNovas(const MansaoCompacta* mansao) {
+    size_t n = mansao->quantidade;
+    int32_t* contribui = realocarOuSair(NULL, n * sizeof(int32_t));
+    uint32_t* noCaminho = alocarZeradoOuSair(simbolos.quantidade + 1, sizeof(uint32_t));
+    uint32_t* pilha = realocarOuSair(NULL, (n + 1) * sizeof(uint32_t));
+    const uint32_t SAINDO = 1u << 31; // Sala já visitada: falta desempilhar o caminho
+    size_t topo = 0;
+    pilha[topo++] = 0;
+    while (topo > 0) {
+        uint32_t item = pilha[--topo];
+        uint32_t sala = item & ~SAINDO;
+        int32_t pista = mansao->pistas[sala];
+
+        if (item & SAINDO) {
+            if (pista != SEM_SIMBOLO) noCaminho[pista]--;
+            continue;
+        }
+        contribui[sala] = SEM_SIMBOLO;
+        if (pista != SEM_SIMBOLO && noCaminho[pista]++ == 0) contribui[sala] = pista;
+
+        // Cada sala ocupa no máximo um lugar na pilha por vez (entrada ou saída)
+        pilha[topo++] = sala | SAINDO;
+        uint32_t esquerda = compactaEsquerda(mansao, sala);
+        uint32_t direita = compactaDireita(mansao, sala);
+        if (direita != SEM_SALA) pilha[topo++] = direita;
+        if (esquerda != SEM_SALA) pilha[topo++] = esquerda;
+    }
+
+    free(pilha);
+    free(noCaminho);
+    return contribui;
+}
+
+/*
+ * prepararPerito() – uma passada de baixo para cima: no layout em largura os
+ * filhos vêm depois dos pais, então percorrer os índices do fim para o
+ * começo resolve cada sala depois das suas filhas; a pista nova da sala soma
+ * os pesos da sua lista no índice. O(salas * suspeitos + entradas).
+ */
+int prepararPerito(Perito* perito, Caso* caso, const IndicePistas* pesos) {
+    memset(perito, 0, sizeof(*perito));
+    size_t k = caso->tabela.quantidadeSuspeitos;
+    size_t n = caso->quantidadeSalas;
+
+    if (k == 0 || n == 0) return 0;
+    if (n > LIMITE_ENTRADAS_PERITO / k) {
+        escrever("Aviso: %zu salas x %zu suspeitos excede o limite do perito.\n", n, k);
+        descarregarSaida(); // Também nos modos que escrevem com printf
+        return 0;
+    }
+    if (!compactarMansao(caso->mansao, n, &perito->mansao)) return 0;
+
+    int32_t* contribui = marcarPistasNovas(&perito->mansao);
+
+    perito->quantidadeSuspeitos = k;
+    perito->limiar = limiarDoCaso(caso);
+    perito->melhor = realocarOuSair(NULL, n * k * sizeof(int64_t));
+    perito->direita = alocarZeradoOuSair((n * k + 7) / 8, 1);
+
+    for (size_t i = n; i-- > 0;) {
+        uint32_t esquerda = compactaEsquerda(&perito->mansao, (uint32_t)i);
+        uint32_t direita = compactaDireita(&perito->mansao, (uint32_t)i);
+        const int64_t* porEsquerda = (esquerda != SEM_SALA) ? perito->melhor + (size_t)esquerda * k : NULL;
+        const int64_t* porDireita = (direita != SEM_SALA) ? perito->melhor + (size_t)direita * k : NULL;
+        int64_t* melhor = perito->melhor + i * k;
+
+        for (size_t s = 0; s < k; s++) {
+            int64_t a = porEsquerda ? porEsquerda[s] : 0;
+            int64_t b = porDireita ? porDireita[s] : 0;
+            // Empate: esquerda, a não ser que ela não exista
+            if (b > a || (porEsquerda == NULL && porDireita != NULL)) {
+                perito->direita[(i * k + s) >> 3] |= (uint8_t)(1u << ((i * k + s) & 7));
+                melhor[s] = b;
+            } else {
+                melhor[s] = a;
+            }
+        }
+        int32_t pista = contribui[i];
+        if (pista == SEM_SIMBOLO) continue;
+        for (size_t e = pesos->inicio[pista]; e < pesos->inicio[pista + 1]; e++) {
+            melhor[pesos->entradas[e].suspeito] += pesos->entradas[e].peso;
+        }
+    }
+
+    free(contribui);
+    perito->pronto = 1;
+    return 1;
+}
+
+/*
+ * evidenciasAlcancaveis() – pontos contra o suspeito que ainda podem ser
+ * somados abaixo da sala (a pista da própria sala já foi coletada). O(1).
+ */
+int64_t evidenciasAlcancaveis(const Perito* perito, uint32_t sala, int suspeito) {
+    size_t k = perito->quantidadeSuspeitos;
+    uint32_t esquerda = compactaEsquerda(&perito->mansao, sala);
+    uint32_t direita = compactaDireita(&perito->mansao, sala);
+    int64_t a = (esquerda != SEM_SALA) ? perito->melhor[(size_t)esquerda * k + suspeito] : 0;
+    int64_t b = (direita != SEM_SALA) ? perito->melhor[(size_t)direita * k + suspeito] : 0;
+    return (a > b) ? a : b;
+}
+
+/*
+ * rotaDoPerito() – escreve em 'destino' os movimentos (e/d) que, a partir da
+ * sala, reúnem o máximo de pontos contra o suspeito; para quando nada mais
+ * há a ganhar. Devolve o número de movimentos escritos (até limite - 1).
+ */
+size_t rotaDoPerito(const Perito* perito, uint32_t sala, int suspeito, char* destino, size_t limite) {
+    size_t k = perito->quantidadeSuspeitos;
+    size_t passos = 0;
+
+    while (passos + 1 < limite && evidenciasAlcancaveis(perito, sala, suspeito) > 0) {
+        size_t posicao = (size_t)sala * k + suspeito;
+        if (perito->direita[posicao >> 3] & (1u << (posicao & 7))) {
+            destino[passos++] = 'd';
+            sala = compactaDireita(&perito->mansao, sala);
+        } else {
+            destino[passos++] = 'e';
+            sala = compactaEsquerda(&perito->mansao, sala);
+        }
+    }
+    if (limite > 0) destino[passos] = '\0';
+    return passos;
+}
+
+void liberarPerito(Perito* perito) {
+    liberarMansaoCompacta(&perito->mansao);
+    free(perito->melhor);
+    free(perito->direita);
+    memset(perito, 0, sizeof(*perito));
+}
+
+/*
+ * executarPerito() – modo "--perito": tabela do ponto de vista da entrada.
+ */
+int executarPerito(Caso* caso) {
+    Perito local;
+    IndicePistas indice;
+    double inicio = agoraSegundos();
+    construirIndice(&indice, caso);
+    int pronto = prepararPerito(&local, caso, &indice);
+    liberarIndice(&indice);
+    if (!pronto) return 0;
+    double decorrido = agoraSegundos() - inicio;
+
+    size_t k = local.quantidadeSuspeitos;
+    size_t limite = local.mansao.quantidade + 1;
+    char* rota = realocarOuSair(NULL, limite);
+    printf("Perito: %zu salas x %zu suspeitos em %.3f s\n", local.mansao.quantidade, k, decorrido);
+    printf("Pontos possíveis a partir da entrada (condenação com %lld):\n", (long long)local.limiar);
+    for (size_t s = 0; s < k; s++) {
+        int64_t maximo = local.melhor[s]; // Sala 0: inclui a pista da entrada
+        rotaDoPerito(&local, 0, (int)s, rota, limite);
+        printf("  %6lld  %s%s  [caminho: %s]\n", (long long)maximo, textoSimbolo(caso->tabela.suspeitos[s]),
+               (maximo >= local.limiar) ? " (condenável)" : "", rota[0] ? rota : "-");
+    }
+    free(rota);
+    liberarPerito(&local);
+    return 1;
+}
+
+// ============================================================================
+// MAPA DA MANSÃO (GRAFO DE SALAS E ROTAS)
+// ============================================================================
+
+/*
+ * construirMapa() – junta os caminhos da árvore (nos dois sentidos) e as
+ * portas do caso numa lista de vizinhos em CSR: conta o grau de cada sala,
+ * acumula e distribui, como no índice de pistas. O(salas + portas).
+ */
+int construirMapa(MapaSalas* mapa, Caso* caso) {
+    memset(mapa, 0, sizeof(*mapa));
+    if (!compactarMansao(caso->mansao, caso->quantidadeSalas, &mapa->mansao)) return 0;
+
+    const MansaoCompacta* mansao = &mapa->mansao;
+    size_t n = mansao->quantidade;
+    size_t ligacoes = 2 * (n - 1 + caso->quantidadePortas);
+    size_t* inicio = alocarZeradoOuSair(n + 2, sizeof(size_t));
+    uint32_t* vizinhos = realocarOuSair(NULL, (ligacoes + 1) * sizeof(uint32_t));
+
+    // Grau em inicio[s + 2]; depois da soma, inicio[s + 1] é o cursor de s
+    for (uint32_t s = 0; s < n; s++) {
+        uint32_t esquerda = compactaEsquerda(mansao, s), direita = compactaDireita(mansao, s);
+        if (esquerda != SEM_SALA) inicio[s + 2]++, inicio[esquerda + 2]++;
+        if (direita != SEM_SALA) inicio[s + 2]++, inicio[direita + 2]++;
+    }
+    for (size_t i = 0; i < caso->quantidadePortas; i++) {
+        inicio[caso->portas[i].a + 2]++;
+        inicio[caso->portas[i].b + 2]++;
+    }
+    for (size_t s = 0; s < n; s++) inicio[s + 1] += inicio[s];
+
+    // Em largura, a origem de cada sala vem antes dela: a volta é a 1ª saída
+    for (uint32_t s = 0; s < n; s++) {
+        uint32_t filhos[2] = {compactaEsquerda(mansao, s), compactaDireita(mansao, s)};
+        for (int lado = 0; lado < 2; lado++) {
+            if (filhos[lado] == SEM_SALA) continue;
+            vizinhos[inicio[s + 1]++] = filhos[lado];
+            vizinhos[inicio[filhos[lado] + 1]++] = s;
+        }
+    }
+    for (size_t i = 0; i < caso->quantidadePortas; i++) {
+        vizinhos[inicio[caso->portas[i].a + 1]++] = caso->portas[i].b;
+        vizinhos[inicio[caso->portas[i].b + 1]++] = caso->portas[i].a;
+    }
+
+    // Salas por nome, na ordem em largura dentro de cada nome (mesma contagem)
+    size_t universo = simbolos.quantidade;
+    size_t* inicioNome = alocarZeradoOuSair(universo + 2, sizeof(size_t));
+    uint32_t* salasPorNome = realocarOuSair(NULL, (n + 1) * sizeof(uint32_t));
+    for (size_t s = 0; s < n; s++) inicioNome[(size_t)mansao->nomes[s] + 2]++;
+    for (size_t i = 0; i < universo; i++) inicioNome[i + 1] += inicioNome[i];
+    for (uint32_t s = 0; s < n; s++) salasPorNome[inicioNome[(size_t)mansao->nomes[s] + 1]++] = s;
+
+    mapa->inicio = inicio;
+    mapa->vizinhos = vizinhos;
+    mapa->inicioNome = inicioNome;
+    mapa->salasPorNome = salasPorNome;
+    mapa->quantidadeNomes = universo;
+    return 1;
+}
+
+void iniciarBusca(BuscaMapa* busca, size_t quantidade) {
+    busca->anterior = realocarOuSair(NULL, (quantidade + 1) * sizeof(uint32_t));
+    busca->distancia = realocarOuSair(NULL, (quantidade + 1) * sizeof(uint32_t));
+    busca->fila = realocarOuSair(NULL, (quantidade + 1) * sizeof(uint32_t));
+    busca->carimbo = alocarZeradoOuSair(quantidade + 1, sizeof(uint32_t));
+    busca->quantidade = quantidade;
+    busca->rodada = 0;
+}
+
+/*
+ * buscarRota() – menor rota da origem até a sala 'destino' ou até a mais
+ * próxima chamada 'nomeDestino' (SEM_SALA / SEM_SIMBOLO para não usar um
+ * deles). Busca em largura pelos dois lados: a cada vez expande um nível
+ * inteiro do lado com a fronteira menor e para no nível em que os lados se
+ * encontram, visitando muito menos salas que a busca só a partir da origem.
+ * As salas com o nome saem do agrupamento montado por construirMapa.
+ * Devolve a sala alcançada, ou SEM_SALA; o caminho sai de busca->anterior,
+ * do destino até a origem.
+ */
+uint32_t buscarRota(const MapaSalas* mapa, BuscaMapa* busca, uint32_t origem, uint32_t destino, int nomeDestino) {
+    const int32_t* nomes = mapa->mansao.nomes;
+    size_t n = busca->quantidade;
+    uint32_t* fila = busca->fila;
+    uint32_t base = busca->rodada += 2;
+    if (base < 2) { // Carimbos deram a volta: zera tudo uma vez
+        memset(busca->carimbo, 0, n * sizeof(uint32_t));
+        base = busca->rodada = 2;
+    }
+
+    busca->anterior[origem] = SEM_SALA;
+    if (origem == destino || nomes[origem] == nomeDestino) return origem;
+
+    // Lado 0 (origem) em fila[0 ..]; lado 1 (destinos) em fila[n - 1 ..], para trás
+    size_t inicio[2] = {0, 0}, fim[2] = {0, 0};
+    busca->carimbo[origem] = base;
+    busca->distancia[origem] = 0;
+    fila[fim[0]++] = origem;
+    size_t primeiro = 0, ultimo = 0; // Faixa das salas com o nome em salasPorNome
+    if (nomeDestino >= 0 && (size_t)nomeDestino < mapa->quantidadeNomes) {
+        primeiro = mapa->inicioNome[nomeDestino];
+        ultimo = mapa->inicioNome[nomeDestino + 1];
+    }
+    for (size_t i = primeiro; i <= ultimo; i++) {
+        uint32_t s = (i < ultimo) ? mapa->salasPorNome[i] : destino; // A sala pedida por último
+        if (s == SEM_SALA || busca->carimbo[s] == base + 1) continue;
+        busca->carimbo[s] = base + 1;
+        busca->distancia[s] = 0;
+        busca->anterior[s] = SEM_SALA;
+        fila[n - 1 - fim[1]++] = s;
+    }
+
+    while (inicio[0] < fim[0] && inicio[1] < fim[1]) {
+        int lado = (fim[0] - inicio[0] <= fim[1] - inicio[1]) ? 0 : 1;
+        size_t fimNivel = fim[lado];
+        uint32_t melhor = UINT32_MAX, deOrigem = SEM_SALA, deDestino = SEM_SALA;
+
+        while (inicio[lado] < fimNivel) {
+            uint32_t sala = lado ? fila[n - 1 - inicio[1]++] : fila[inicio[0]++];
+            for (size_t e = mapa->inicio[sala]; e < mapa->inicio[sala + 1]; e++) {
+                uint32_t vizinho = mapa->vizinhos[e];
+                if (busca->carimbo[vizinho] == base + (uint32_t)lado) continue;
+                if (busca->carimbo[vizinho] == base + 1 - (uint32_t)lado) { // Os lados se encontram
+                    uint32_t total = busca->distancia[sala] + 1 + busca->distancia[vizinho];
+                    if (total < melhor) {
+                        melhor = total;
+                        deOrigem = lado ? vizinho : sala;
+                        deDestino = lado ? sala : vizinho;
+                    }
+                    continue;
+                }
+                busca->carimbo[vizinho] = base + (uint32_t)lado;
+                busca->distancia[vizinho] = busca->distancia[sala] + 1;
+                busca->anterior[vizinho] = sala;
+                if (lado) fila[n - 1 - fim[1]++] = vizinho;
+                else fila[fim[0]++] = vizinho;
+            }
+        }
+
+        if (melhor != UINT32_MAX) {
+            // Inverte o trecho do lado do destino: tudo passa a apontar para a origem
+            uint32_t vindoDe = deOrigem, sala = deDestino;
+            while (sala != SEM_SALA) {
+                uint32_t seguinte = busca->anterior[sala];
+                busca->anterior[sala] = vindoDe;
+                vindoDe = sala;
+                sala = seguinte;
+            }
+            return vindoDe;
+        }
+    }
+    return SEM_SALA;
+}
+
+// Salas mostradas de uma rota (as do fim são resumidas em "...").
+#define ROTA_EXIBIDA 64
+
+// Mostra a rota da origem até 'chegada' (já buscada): passos e cômodos.
+static void mostrarRota(const MapaSalas* mapa, const BuscaMapa* busca, uint32_t chegada) {
+    size_t passos = 0;
+    for (uint32_t sala = chegada; busca->anterior[sala] != SEM_SALA; sala = busca->anterior[sala]) passos++;
+
+    uint32_t* caminho = realocarOuSair(NULL, (passos + 1) * sizeof(uint32_t));
+    size_t posicao = passos;
+    for (uint32_t sala = chegada; sala != SEM_SALA; sala = busca->anterior[sala]) caminho[posicao--] = sala;
+
+    escrever(saida.silencioso ? "rota\t%zu" : "Rota (%zu passo(s)): ", passos);
+    for (size_t i = 0; i <= passos && i < ROTA_EXIBIDA; i++) {
+        escreverTexto(saida.silencioso ? "\t" : (i > 0) ? " -> " : "");
+        escreverTexto(textoSimbolo(mapa->mansao.nomes[caminho[i]]));
+    }
+    if (passos + 1 > ROTA_EXIBIDA) escreverTexto(saida.silencioso ? "\t..." : " -> ...");
+    escreverTexto("\n");
+    free(caminho);
+}
+
+/*
+ * explorarMapa() – exploração pelo grafo: cada sala mostra todas as suas
+ * portas (inclusive a de volta), o jogador escolhe pelo número e pode pedir
+ * a menor rota até um cômodo pelo nome. A pista de uma sala só é coletada
+ * na primeira visita.
+ */
+void explorarMapa(MapaSalas* mapa, Inventario* inventario) {
+    const MansaoCompacta* mansao = &mapa->mansao;
+    int silencioso = saida.silencioso;
+    uint8_t* visitada = alocarZeradoOuSair(mansao->quantidade + 1, 1);
+    BuscaMapa busca;
+    char comando[TAM_NOME_ACUSADO];
+    uint32_t sala = 0, mostrada = SEM_SALA; // Sala cujo cabeçalho já saiu
+    iniciarBusca(&busca, mansao->quantidade);
+
+    for (;;) {
+        if (sala != mostrada) {
+            decorar("\n-----------------------------------------\n");
+            escrever(silencioso ? "sala\t%s\n" : "LOCAL ATUAL: %s\n", textoSimbolo(mansao->nomes[sala]));
+            if (visitada[sala]) {
+                decorar("(Cômodo já visitado)\n");
+            } else if (mansao->pistas[sala] != SEM_SIMBOLO) {
+                escrever(silencioso ? "pista\t%s\n" : "[!] Pista encontrada: \"%s\"\n",
+                         textoSimbolo(mansao->pistas[sala]));
+                decorar("    -> Adicionando ao caderno de anotações...\n");
+                coletarPista(inventario, mansao->pistas[sala]);
+            } else {
+                decorar("(Nenhuma pista visível neste cômodo)\n");
+            }
+            visitada[sala] = 1;
+            decorar("-----------------------------------------\n");
+            mostrada = sala;
+        }
+
+        escreverTexto(silencioso ? "portas" : "Portas:\n");
+        for (size_t e = mapa->inicio[sala]; e < mapa->inicio[sala + 1]; e++) {
+            uint32_t vizinho = mapa->vizinhos[e];
+            if (silencioso) {
+                escrever("\t%s", textoSimbolo(mansao->nomes[vizinho]));
+            } else {
+                escrever(" [%zu] %s%s\n", e - mapa->inicio[sala] + 1, textoSimbolo(mansao->nomes[vizinho]),
+                         visitada[vizinho] ? " (visitada)" : "");
+            }
+        }
+        escreverTexto(silencioso ? "\n" : " [r <cômodo>] Menor caminho até um cômodo\n"
+                                         " [s] Sair da Mansão (Encerrar exploração)\n"
+                                         "Sua escolha: ");
+        descarregarSaida();
+        if (scanf(" %255[^\n]", comando) != 1) break; // Fim da entrada encerra
+        char* texto = aparar(comando);
+
+        if (isdigit((unsigned char)texto[0])) {
+            size_t porta = strtoull(texto, NULL, 10);
+            if (porta >= 1 && porta <= mapa->inicio[sala + 1] - mapa->inicio[sala]) {
+                sala = mapa->vizinhos[mapa->inicio[sala] + porta - 1];
+            } else {
+                escreverTexto(silencioso ? "erro\tporta_invalida\n" : "\n[!] Não há essa porta.\n");
+            }
+        } else if ((texto[0] == 'r' || texto[0] == 'R') && isspace((unsigned char)texto[1])) {
+            int nome = buscarSimbolo(aparar(texto + 1));
+            uint32_t chegada = (nome == SEM_SIMBOLO) ? SEM_SALA : buscarRota(mapa, &busca, sala, SEM_SALA, nome);
+            if (chegada != SEM_SALA) mostrarRota(mapa, &busca, chegada);
+            else escreverTexto(silencioso ? "erro\tsem_rota\n" : "\n[!] Nenhum cômodo com esse nome é alcançável.\n");
+        } else if ((texto[0] == 's' || texto[0] == 'S') && texto[1] == '\0') {
+            escreverTexto(silencioso ? "fim\tsaiu\n" : "\nVocê decidiu encerrar a investigação por agora.\n");
+            break;
+        } else {
+            escreverTexto(silencioso ? "erro\topcao_invalida\n" : "\n[!] Opção inválida.\n");
+        }
+    }
+
+    liberarBusca(&busca);
+    free(visitada);
+}
+
+void liberarBusca(BuscaMapa* busca) {
+    free(busca->anterior);
+    free(busca->distancia);
+    free(busca->fila);
+    free(busca->carimbo);
+    memset(busca, 0, sizeof(*busca));
+}
+
+void liberarMapaSalas(MapaSalas* mapa) {
+    liberarMansaoCompacta(&mapa->mansao);
+    free(mapa->inicio);
+    free(mapa->vizinhos);
+    free(mapa->inicioNome);
+    free(mapa->salasPorNome);
+    memset(mapa, 0, sizeof(*mapa));
+}
+
+// ============================================================================
+// SESSÃO GRAVADA (SALVAR E CONTINUAR)
+// ============================================================================
+
+/*
+ * impressaoDoCaso() – resumo de 64 bits dos textos (na ordem dos ids) e do
+ * gabarito. Se bater, os ids de pista gravados valem no caso carregado.
+ */
+uint64_t impressaoDoCaso(TabelaHash* tabela) {
+    uint64_t impressao = 14695981039346656037ULL;
+    for (size_t id = 0; id < simbolos.quantidade; id++) {
+        impressao = (impressao ^ simbolos.hashes[id]) * 1099511628211ULL;
+    }
+    impressao = (impressao ^ tabela->quantidade) * 1099511628211ULL;
+    return (impressao ^ tabela->quantidadeSuspeitos) * 1099511628211ULL;
+}
+
+void registrarMovimento(char movimento) {
+    if (trajeto.passos == trajeto.capacidade) {
+        trajeto.capacidade = trajeto.capacidade ? trajeto.capacidade * 2 : 64;
+        trajeto.movimentos = realocarOuSair(trajeto.movimentos, trajeto.capacidade);
+    }
+    trajeto.movimentos[trajeto.passos++] = movimento;
+}
+
+/*
+ * gravarSessao() – grava trajeto e árvore de pistas. Escreve num
+ * arquivo temporário e renomeia no fim: uma falha no meio não estraga a
+ * sessão gravada anteriormente.
+ */
+int gravarSessao(const char* destino, Inventario* inventario, TabelaHash* tabela) {
+    CabecalhoSessao cabecalho;
+    size_t n = inventario->totalPistas;
+
+    // Árvore em largura: os filhos de cada nó recebem as próximas posições
+    PistaNode** fila = realocarOuSair(NULL, (n + 1) * sizeof(PistaNode*));
+    PistaNode* registros = realocarOuSair(NULL, (n + 1) * sizeof(PistaNode));
+    size_t fim = 0;
+    if (inventario->raiz != NULL) fila[fim++] = inventario->raiz;
+    for (size_t i = 0; i < fim; i++) {
+        PistaNode* no = fila[i];
+        registros[i] = *no;
+        registros[i].esquerda = NULL;
+        registros[i].direita = NULL;
+        if (no->esquerda) {
+            registros[i].esquerda = (PistaNode*)(uintptr_t)(fim + 1);
+            fila[fim++] = no->esquerda;
+        }
+        if (no->direita) {
+            registros[i].direita = (PistaNode*)(uintptr_t)(fim + 1);
+            fila[fim++] = no->direita;
+        }
+    }
+    free(fila);
+
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_SESSAO, 4);
+    cabecalho.versao = VERSAO_SESSAO;
+    cabecalho.impressaoCaso = impressaoDoCaso(tabela);
+    cabecalho.quantidadeMovimentos = trajeto.passos;
+    cabecalho.quantidadePistas = fim;
+    uint64_t fimMovimentos = sizeof(CabecalhoSessao) + trajeto.passos;
+    cabecalho.deslocamentoPistas = (fimMovimentos + 7) / 8 * 8;
+    cabecalho.tamanhoArquivo = cabecalho.deslocamentoPistas + fim * sizeof(PistaNode);
+
+    char temporario[4096];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", destino);
+    FILE* arquivo = fopen(temporario, "wb");
+    int ok = (arquivo != NULL);
+    if (ok) {
+        static const char zeros[8] = {0};
+        fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo);
+        if (trajeto.passos > 0) fwrite(trajeto.movimentos, 1, trajeto.passos, arquivo);
+        fwrite(zeros, 1, cabecalho.deslocamentoPistas - fimMovimentos, arquivo);
+        fwrite(registros, sizeof(PistaNode), fim, arquivo);
+        ok = (ferror(arquivo) == 0);
+        ok = (fclose(arquivo) == 0) && ok;
+        ok = ok && rename(temporario, destino) == 0;
+        if (!ok) unlink(temporario);
+    }
+
+    free(registros);
+    return ok;
+}
+
+/*
+ * carregarSessao() – mapeia a sessão (MAP_PRIVATE) e usa os registros de
+ * pista no próprio lugar: cada "índice + 1" vira ponteiro, numa passada, sem
+ * inserirPista nem alocação por nó. Confere estrutura e alturas da AVL antes
+ * de entregar a árvore (uma árvore desbalanceada estouraria o caminho de
+ * inserção de inserirPistaAvl). Pistas coletadas depois vêm da arena.
+ */
+int carregarSessao(const char* arquivo, Caso* caso, Inventario* inventario,
+                   Sala** salaAtual, SessaoCarregada* carregada) {
+    int fd = open(arquivo, O_RDONLY);
+    struct stat info;
+
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(CabecalhoSessao)) {
+        printf("Erro: não foi possível abrir a sessão '%s'.\n", arquivo);
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+
+    size_t tamanho = (size_t)info.st_size;
+    unsigned char* base = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Erro: não foi possível mapear a sessão '%s'.\n", arquivo);
+        return 0;
+    }
+
+    CabecalhoSessao* cabecalho = (CabecalhoSessao*)base;
+    uint64_t nMovimentos = cabecalho->quantidadeMovimentos;
+    uint64_t n = cabecalho->quantidadePistas;
+    int valido = memcmp(cabecalho->magica, MAGICA_SESSAO, 4) == 0 &&
+                 cabecalho->versao == VERSAO_SESSAO &&
+                 cabecalho->tamanhoArquivo == tamanho &&
+                 nMovimentos < tamanho && n < INT32_MAX && cabecalho->deslocamentoPistas <= tamanho &&
+                 sizeof(CabecalhoSessao) + nMovimentos <= cabecalho->deslocamentoPistas &&
+                 cabecalho->deslocamentoPistas % 8 == 0 &&
+                 cabecalho->deslocamentoPistas + n * sizeof(PistaNode) == tamanho;
+    if (!valido) {
+        printf("Erro: '%s' não é uma sessão gravada válida (versão %d).\n", arquivo, VERSAO_SESSAO);
+        munmap(base, tamanho);
+        return 0;
+    }
+    if (cabecalho->impressaoCaso != impressaoDoCaso(&caso->tabela)) {
+        printf("Erro: a sessão '%s' foi gravada em outro caso.\n", arquivo);
+        munmap(base, tamanho);
+        return 0;
+    }
+
+    // Posição: refaz o trajeto desde a entrada
+    const char* movimentos = (const char*)(base + sizeof(CabecalhoSessao));
+    Sala* sala = caso->mansao;
+    for (uint64_t i = 0; i < nMovimentos && valido; i++) {
+        sala = (movimentos[i] == 'e') ? sala->esquerda : (movimentos[i] == 'd') ? sala->direita : NULL;
+        valido = (sala != NULL);
+    }
+
+    // Pistas: em largura, o próximo filho referenciado é sempre o próximo
+    // índice livre; assim cada nó tem um único pai e a árvore não tem ciclos
+    PistaNode* nos = (PistaNode*)(base + cabecalho->deslocamentoPistas);
+    uint64_t proximoFilho = 2; // Índice + 1 do primeiro filho da raiz
+    for (uint64_t i = 0; i < n && valido; i++) {
+        uintptr_t esquerda = (uintptr_t)nos[i].esquerda;
+        uintptr_t direita = (uintptr_t)nos[i].direita;
+        valido = nos[i].conteudo >= 0 && (size_t)nos[i].conteudo < simbolos.quantidade &&
+                 (esquerda == 0 || esquerda == proximoFilho);
+        if (esquerda != 0) proximoFilho++;
+        valido = valido && (direita == 0 || direita == proximoFilho);
+        if (direita != 0) proximoFilho++;
+        if (!valido) break;
+        nos[i].esquerda = esquerda ? &nos[esquerda - 1] : NULL;
+        nos[i].direita = direita ? &nos[direita - 1] : NULL;
+    }
+    valido = valido && (n == 0 || proximoFilho == n + 1);
+
+    // Alturas e balanço conferidos de baixo para cima (filhos vêm depois)
+    for (uint64_t i = n; valido && i-- > 0;) {
+        int altEsq = nos[i].esquerda ? nos[i].esquerda->altura : 0;
+        int altDir = nos[i].direita ? nos[i].direita->altura : 0;
+        valido = nos[i].altura == 1 + (altEsq > altDir ? altEsq : altDir) &&
+                 altEsq - altDir <= 1 && altDir - altEsq <= 1;
+    }
+
+    if (!valido) {
+        printf("Erro: conteúdo inválido na sessão '%s'.\n", arquivo);
+        munmap(base, tamanho);
+        return 0;
+    }
+
+    // Mapa de bits e placar (pesos do índice) refeitos na mesma passada pelos
+    // registros; a árvore continua no arquivo mapeado
+    inventario->raiz = n ? &nos[0] : NULL;
+    inventario->totalPistas = n;
+    for (uint64_t i = 0; i < n; i++) {
+        marcarPista(&inventario->coletadas, nos[i].conteudo);
+        somarAoPlacar(inventario, nos[i].conteudo);
+    }
+
+    trajeto.passos = 0;
+    for (uint64_t i = 0; i < nMovimentos; i++) registrarMovimento(movimentos[i]);
+
+    *salaAtual = sala;
+    carregada->mapeamento = base;
+    carregada->tamanho = tamanho;
+    return 1;
+}
+
+void liberarSessaoCarregada(SessaoCarregada* carregada) {
+    if (carregada->mapeamento != NULL) munmap(carregada->mapeamento, carregada->tamanho);
+    carregada->mapeamento = NULL;
+    carregada->tamanho = 0;
+}
+
+// ============================================================================
+// DIÁRIO DE MOVIMENTOS (RECUPERAÇÃO APÓS QUEDA)
+// ============================================================================
+
+// FNV-1a de 32 bits do conteúdo, semeado com o número do lote: um lote
+// antigo que sobrou no lugar não passa por um lote novo.
+static uint32_t verificacaoLote(const unsigned char* dados, size_t tamanho, uint32_t lote) {
+    uint32_t hash = 2166136261u ^ (lote * 0x9E3779B9u);
+    for (size_t i = 0; i < tamanho; i++) {
+        hash ^= dados[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// write() até o fim no diário (como escreverTudo da saída), mas com o erro.
+static int gravarNoDiario(int descritor, const void* dados, size_t tamanho) {
+    const unsigned char* p = dados;
+    while (tamanho > 0) {
+        ssize_t escritos = write(descritor, p, tamanho);
+        if (escritos < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        p += escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return 1;
+}
+
+// Estado comum a um diário novo e a um recuperado (pronto para acrescentar).
+static void prepararDiario(Diario* diario, int descritor, uint32_t lotes) {
+    diario->ativo = 1;
+    diario->descritor = descritor;
+    diario->capacidade = 256;
+    diario->lote = realocarOuSair(NULL, diario->capacidade);
+    diario->usados = CABECALHO_LOTE;
+    diario->lotes = lotes;
+    diario->limiteSincronia = DIARIO_BYTES_SINCRONIA;
+    diario->intervaloSincronia = DIARIO_INTERVALO_SINCRONIA;
+    diario->naoSincronizados = 0;
+    diario->ultimaSincronia = agoraSegundos();
+    diario->escritas = diario->sincronias = 0;
+}
+
+static void encerrarDiario(Diario* diario) {
+    close(diario->descritor);
+    free(diario->lote);
+    diario->lote = NULL;
+    diario->ativo = 0;
+}
+
+/*
+ * abrirDiario() – cria (ou zera) o diário da partida e grava o cabeçalho com
+ * a impressão digital do caso, já sincronizado.
+ */
+int abrirDiario(Diario* diario, const char* arquivo, TabelaHash* tabela) {
+    CabecalhoDiario cabecalho;
+    int descritor = open(arquivo, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_DIARIO, 4);
+    cabecalho.versao = VERSAO_DIARIO;
+    cabecalho.impressaoCaso = impressaoDoCaso(tabela);
+    if (descritor < 0 || !gravarNoDiario(descritor, &cabecalho, sizeof(cabecalho)) || fdatasync(descritor) != 0) {
+        printf("Erro: não foi possível criar o diário '%s'.\n", arquivo);
+        if (descritor >= 0) close(descritor);
+        return 0;
+    }
+    prepararDiario(diario, descritor, 0);
+    return 1;
+}
+
+/*
+ * anotarDiario() – acrescenta um movimento ('e'/'d') ou uma pista nova ('p')
+ * ao lote em montagem. Não escreve nada: confirmarDiario() é que grava.
+ */
+void anotarDiario(Diario* diario, char tipo, int32_t pista) {
+    if (!diario->ativo) return;
+    if (diario->capacidade - diario->usados < 1 + sizeof(int32_t)) {
+        diario->capacidade *= 2;
+        diario->lote = realocarOuSair(diario->lote, diario->capacidade);
+    }
+    diario->lote[diario->usados++] = (unsigned char)tipo;
+    if (tipo == 'p') {
+        memcpy(diario->lote + diario->usados, &pista, sizeof(int32_t));
+        diario->usados += sizeof(int32_t);
+    }
+}
+
+/*
+ * confirmarDiario() – grava o lote montado numa só escrita (basta para
+ * sobreviver a uma queda do processo) e agrupa as sincronias com o disco:
+ * fdatasync quando pedido, ao juntar limiteSincronia bytes ou depois de
+ * intervaloSincronia segundos da última. Os limites só são conferidos
+ * aqui, então sem pedido o que foi gravado espera a próxima chamada: quem
+ * vai ficar parado (explorarSalas, antes de ler a escolha) pede a sincronia.
+ * Em erro, avisa e a partida segue sem diário.
+ */
+int confirmarDiario(Diario* diario, int sincronizar) {
+    if (!diario->ativo) return 1;
+    size_t conteudo = diario->usados - CABECALHO_LOTE;
+    int ok = 1;
+
+    if (conteudo > 0) {
+        uint32_t cabecalho[2] = {(uint32_t)conteudo,
+                                 verificacaoLote(diario->lote + CABECALHO_LOTE, conteudo, diario->lotes)};
+        memcpy(diario->lote, cabecalho, CABECALHO_LOTE);
+        ok = gravarNoDiario(diario->descritor, diario->lote, diario->usados);
+        diario->lotes++;
+        diario->escritas++;
+        diario->naoSincronizados += diario->usados;
+        diario->usados = CABECALHO_LOTE;
+    }
+    if (ok && diario->naoSincronizados > 0) {
+        double agora = agoraSegundos();
+        if (sincronizar || diario->naoSincronizados >= diario->limiteSincronia ||
+            agora - diario->ultimaSincronia >= diario->intervaloSincronia) {
+            ok = (fdatasync(diario->descritor) == 0);
+            diario->sincronias++;
+            diario->naoSincronizados = 0;
+            diario->ultimaSincronia = agora;
+        }
+    }
+    if (!ok) {
+        escrever("Aviso: falha ao gravar o diário (%s); a partida segue sem ele.\n", strerror(errno));
+        encerrarDiario(diario);
+    }
+    return ok;
+}
+
+/*
+ * recuperarDiario() – refaz a partida do diário: percorre os lotes inteiros,
+ * anda pelas salas e coleta as pistas anotadas (conferindo que são as da
+ * sala), e corta do arquivo o lote incompleto do fim, se houver. O diário
+ * fica aberto para a partida continuar nele.
+ */
+int recuperarDiario(Diario* diario, const char* arquivo, Caso* caso, Inventario* inventario, Sala** salaAtual) {
+    int descritor = open(arquivo, O_RDWR | O_APPEND | O_CLOEXEC);
+    struct stat info;
+
+    if (descritor < 0 || fstat(descritor, &info) != 0 || (size_t)info.st_size < sizeof(CabecalhoDiario)) {
+        printf("Erro: não foi possível abrir o diário '%s'.\n", arquivo);
+        if (descritor >= 0) close(descritor);
+        return 0;
+    }
+    size_t tamanho = (size_t)info.st_size;
+    unsigned char* base = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+    if (base == MAP_FAILED) {
+        printf("Erro: não foi possível mapear o diário '%s'.\n", arquivo);
+        close(descritor);
+        return 0;
+    }
+
+    const CabecalhoDiario* cabecalho = (const CabecalhoDiario*)base;
+    int valido = memcmp(cabecalho->magica, MAGICA_DIARIO, 4) == 0 && cabecalho->versao == VERSAO_DIARIO;
+    if (!valido || cabecalho->impressaoCaso != impressaoDoCaso(&caso->tabela)) {
+        if (!valido) printf("Erro: '%s' não é um diário válido (versão %d).\n", arquivo, VERSAO_DIARIO);
+        else printf("Erro: o diário '%s' é de outro caso.\n", arquivo);
+        munmap(base, tamanho);
+        close(descritor);
+        return 0;
+    }
+
+    Sala* sala = caso->mansao;
+    size_t posicao = sizeof(CabecalhoDiario), movimentos = 0, pistas = 0;
+    uint32_t lotes = 0;
+    trajeto.passos = 0;
+    while (valido && tamanho - posicao >= CABECALHO_LOTE) {
+        uint32_t cabecalhoLote[2];
+        memcpy(cabecalhoLote, base + posicao, CABECALHO_LOTE);
+        const unsigned char* dados = base + posicao + CABECALHO_LOTE;
+        size_t conteudo = cabecalhoLote[0];
+        if (conteudo > tamanho - posicao - CABECALHO_LOTE ||
+            cabecalhoLote[1] != verificacaoLote(dados, conteudo, lotes)) {
+            break; // Lote cortado pela queda: a partida volta até aqui
+        }
+
+        for (size_t i = 0; i < conteudo && valido; i++) {
+            if (dados[i] == 'e' || dados[i] == 'd') {
+                sala = (dados[i] == 'e') ? sala->esquerda : sala->direita;
+                valido = (sala != NULL);
+                if (valido) registrarMovimento((char)dados[i]);
+                movimentos++;
+            } else if (dados[i] == 'p' && conteudo - i > sizeof(int32_t)) {
+                int32_t pista;
+                memcpy(&pista, dados + i + 1, sizeof(int32_t));
+                valido = (pista == sala->pista) && coletarPista(inventario, pista);
+                i += sizeof(int32_t);
+                pistas++;
+            } else {
+                valido = 0;
+            }
+        }
+        posicao += CABECALHO_LOTE + conteudo;
+        lotes++;
+    }
+    munmap(base, tamanho);
+
+    if (!valido) {
+        printf("Erro: conteúdo inválido no diário '%s'.\n", arquivo);
+        close(descritor);
+        return 0;
+    }
+    if (posicao < tamanho && (ftruncate(descritor, (off_t)posicao) != 0 || fdatasync(descritor) != 0)) {
+        printf("Erro: não foi possível cortar o fim do diário '%s'.\n", arquivo);
+        close(descritor);
+        return 0;
+    }
+
+    prepararDiario(diario, descritor, lotes);
+    diario->movimentos = movimentos;
+    diario->pistas = pistas;
+    diario->descartados = tamanho - posicao;
+    *salaAtual = sala;
+    return 1;
+}
+
+// Grava o que faltar, sincroniza e fecha (o arquivo fica para uma recuperação).
+void fecharDiario(Diario* diario) {
+    if (diario->ativo && confirmarDiario(diario, 1)) encerrarDiario(diario);
+}
+
+// ============================================================================
+// MODO LOTE (REPETIÇÃO DE SESSÕES)
+// ============================================================================
+
+void iniciarRepetidor(Repetidor* repetidor, const MansaoCompacta* mansao,
+                      const IndicePistas* indice, TabelaHash* tabela) {
+    repetidor->mansao = mansao;
+    repetidor->indice = indice;
+    repetidor->quantidadeSimbolos = simbolos.quantidade;
+    repetidor->quantidadeSuspeitos = tabela->quantidadeSuspeitos;
+    repetidor->carimboPista = alocarZeradoOuSair(simbolos.quantidade + 1, sizeof(uint32_t));
+    repetidor->carimboPlacar = alocarZeradoOuSair(tabela->quantidadeSuspeitos + 1, sizeof(uint32_t));
+    repetidor->placar = alocarZeradoOuSair(tabela->quantidadeSuspeitos + 1, sizeof(int64_t));
+    repetidor->sessao = 0;
+}
+
+/*
+ * repetirSessao() – executa uma sessão como explorarSalas faria, sem menus:
+ * coleta a pista de cada sala em que entra (somando os pesos do índice ao
+ * placar de cada suspeito implicado), para numa folha ou em 's'.
+ * Movimentos para um lado sem saída são ignorados ("caminho bloqueado").
+ */
+void repetirSessao(Repetidor* repetidor, const char* movimentos, size_t tamanho,
+                   ResultadoSessao* resultado) {
+    const MansaoCompacta* mansao = repetidor->mansao;
+    const IndicePistas* indice = repetidor->indice;
+    uint32_t sessao = ++repetidor->sessao;
+
+    if (sessao == 0) { // Carimbos deram a volta: zera tudo uma vez
+        memset(repetidor->carimboPista, 0, repetidor->quantidadeSimbolos * sizeof(uint32_t));
+        memset(repetidor->carimboPlacar, 0, repetidor->quantidadeSuspeitos * sizeof(uint32_t));
+        sessao = repetidor->sessao = 1;
+    }
+
+    uint32_t sala = 0;
+    size_t proximo = 0;
+    resultado->salas = 0;
+    resultado->pistas = 0;
+
+    for (;;) {
+        resultado->salas++;
+
+        int32_t pista = mansao->pistas[sala];
+        if (pista != SEM_SIMBOLO && repetidor->carimboPista[pista] != sessao) {
+            repetidor->carimboPista[pista] = sessao;
+            resultado->pistas++;
+            for (size_t e = indice->inicio[pista]; e < indice->inicio[pista + 1]; e++) {
+                int32_t suspeito = indice->entradas[e].suspeito;
+                if (repetidor->carimboPlacar[suspeito] != sessao) {
+                    repetidor->carimboPlacar[suspeito] = sessao;
+                    repetidor->placar[suspeito] = 0;
+                }
+                repetidor->placar[suspeito] += indice->entradas[e].peso;
+            }
+        }
+
+        if (compactaEhFolha(mansao, sala)) break;
+
+        // Próximo movimento válido (opções inválidas ou bloqueadas são ignoradas)
+        uint32_t destino = SEM_SALA;
+        int sair = 0;
+        while (destino == SEM_SALA && !sair && proximo < tamanho) {
+            char opcao = movimentos[proximo++];
+            if (opcao == 'e' || opcao == 'E') destino = compactaEsquerda(mansao, sala);
+            else if (opcao == 'd' || opcao == 'D') destino = compactaDireita(mansao, sala);
+            else if (opcao == 's' || opcao == 'S') sair = 1;
+        }
+        if (destino == SEM_SALA) break; // Saiu ou acabaram os movimentos
+        sala = destino;
+    }
+}
+
+// Pontos da sessão atual contra o suspeito (índice no elenco).
+int64_t placarDaSessao(Repetidor* repetidor, int suspeito) {
+    if (suspeito < 0 || repetidor->carimboPlacar[suspeito] != repetidor->sessao) return 0;
+    return repetidor->placar[suspeito];
+}
+
+void liberarRepetidor(Repetidor* repetidor) {
+    free(repetidor->carimboPista);
+    free(repetidor->carimboPlacar);
+    free(repetidor->placar);
+}
+
+// Escreve um inteiro sem passar pelo printf.
+static char* escreverNumero(char* destino, uint64_t valor) {
+    char digitos[20];
+    int n = 0;
+    do {
+        digitos[n++] = (char)('0' + valor % 10);
+        valor /= 10;
+    } while (valor > 0);
+    while (n > 0) *destino++ = digitos[--n];
+    return destino;
+}
+
+#define TAM_BUFFER_LOTE (1 << 16)
+
+/*
+ * executarLote() – lê sessões (uma por linha) do arquivo ou de "-" (stdin)
+ * e escreve uma linha de resultado por sessão:
+ *   salas <TAB> pistas <TAB> acusado <TAB> provas <TAB> CULPADO|INOCENTE|-
+ * A leitura e a escrita usam blocos grandes; o resumo vai para stderr.
+ */
+int executarLote(Caso* caso, const char* arquivo) {
+    FILE* entrada = (strcmp(arquivo, "-") == 0) ? stdin : fopen(arquivo, "rb");
+    if (entrada == NULL) {
+        printf("Erro: não foi possível abrir as sessões '%s'.\n", arquivo);
+        return 0;
+    }
+
+    MansaoCompacta mansao;
+    if (!compactarMansao(caso->mansao, caso->quantidadeSalas, &mansao)) {
+        if (entrada != stdin) fclose(entrada);
+        return 0;
+    }
+    IndicePistas indice;
+    IndiceNomes nomes;
+    construirIndice(&indice, caso);
+    construirIndiceNomes(&nomes, &caso->tabela);
+    int64_t limiar = limiarDoCaso(caso);
+    Repetidor repetidor;
+    iniciarRepetidor(&repetidor, &mansao, &indice, &caso->tabela);
+
+    char* leitura = realocarOuSair(NULL, TAM_BUFFER_LOTE);
+    char* saida = realocarOuSair(NULL, TAM_BUFFER_LOTE);
+    size_t capacidadeLeitura = TAM_BUFFER_LOTE, ocupados = 0, usadosSaida = 0;
+    size_t sessoes = 0;
+    int fimArquivo = 0;
+    double inicio = agoraSegundos();
+
+    while (!fimArquivo || ocupados > 0) {
+        if (!fimArquivo) {
+            size_t lidos = fread(leitura + ocupados, 1, capacidadeLeitura - ocupados, entrada);
+            ocupados += lidos;
+            if (lidos == 0) fimArquivo = 1;
+        }
+
+        // Processa todas as linhas completas do bloco (e a última, no fim)
+        size_t consumidos = 0;
+        for (;;) {
+            char* linha = leitura + consumidos;
+            char* fimLinha = memchr(linha, '\n', ocupados - consumidos);
+            if (fimLinha == NULL) {
+                if (!fimArquivo || consumidos == ocupados) break;
+                fimLinha = leitura + ocupados; // Última linha sem '\n'
+            }
+            size_t tamanho = (size_t)(fimLinha - linha);
+            consumidos = (fimLinha < leitura + ocupados) ? consumidos + tamanho + 1 : ocupados;
+            if (tamanho > 0 && linha[tamanho - 1] == '\r') tamanho--;
+            if (tamanho == 0 || linha[0] == '#') continue;
+
+            // Movimentos até o primeiro espaço; o resto é o nome do acusado
+            size_t fimMovimentos = 0;
+            while (fimMovimentos < tamanho && linha[fimMovimentos] != ' ' && linha[fimMovimentos] != '\t') fimMovimentos++;
+            size_t inicioNome = fimMovimentos;
+            while (inicioNome < tamanho && (linha[inicioNome] == ' ' || linha[inicioNome] == '\t')) inicioNome++;
+
+            ResultadoSessao resultado;
+            repetirSessao(&repetidor, linha, fimMovimentos, &resultado);
+            resultado.acusado = -1;
+            resultado.provas = 0;
+            if (inicioNome < tamanho) {
+                char nome[TAM_NOME_ACUSADO];
+                size_t tamanhoNome = tamanho - inicioNome, primeiro, quantidade;
+                if (tamanhoNome >= sizeof(nome)) tamanhoNome = sizeof(nome) - 1;
+                memcpy(nome, linha + inicioNome, tamanhoNome);
+                nome[tamanhoNome] = '\0';
+                resultado.acusado = resolverSuspeito(&nomes, &caso->tabela, nome, &primeiro, &quantidade);
+                resultado.provas = placarDaSessao(&repetidor, resultado.acusado);
+            }
+
+            // Linha de resultado
+            if (usadosSaida + 512 > TAM_BUFFER_LOTE) {
+                fwrite(saida, 1, usadosSaida, stdout);
+                usadosSaida = 0;
+            }
+            char* p = saida + usadosSaida;
+            p = escreverNumero(p, resultado.salas);
+            *p++ = '\t';
+            p = escreverNumero(p, resultado.pistas);
+            *p++ = '\t';
+            if (inicioNome < tamanho) {
+                const char* nome = (resultado.acusado >= 0)
+                    ? textoSimbolo(caso->tabela.suspeitos[resultado.acusado]) : "?";
+                size_t tamanhoNome = strlen(nome);
+                if (tamanhoNome > 200) tamanhoNome = 200;
+                memcpy(p, nome, tamanhoNome);
+                p += tamanhoNome;
+                *p++ = '\t';
+                p = escreverNumero(p, (uint64_t)resultado.provas);
+                const char* veredito = (resultado.provas >= limiar) ? "\tCULPADO\n" : "\tINOCENTE\n";
+                size_t tamanhoVeredito = strlen(veredito);
+                memcpy(p, veredito, tamanhoVeredito);
+                p += tamanhoVeredito;
+            } else {
+                memcpy(p, "-\t0\t-\n", 6);
+                p += 6;
+            }
+            usadosSaida = (size_t)(p - saida);
+            sessoes++;
+        }
+
+        // Guarda a linha incompleta no começo do buffer (e cresce se ela não couber)
+        memmove(leitura, leitura + consumidos, ocupados - consumidos);
+        ocupados -= consumidos;
+        if (ocupados == capacidadeLeitura) {
+            capacidadeLeitura *= 2;
+            leitura = realocarOuSair(leitura, capacidadeLeitura);
+        }
+    }
+    fwrite(saida, 1, usadosSaida, stdout);
+    fflush(stdout);
+
+    double decorrido = agoraSegundos() - inicio;
+    fprintf(stderr, "%zu sessões em %.3f s (%.0f sessões/s)\n", sessoes, decorrido,
+            decorrido > 0 ? sessoes / decorrido : 0.0);
+
+    if (entrada != stdin) fclose(entrada);
+    free(leitura);
+    free(saida);
+    liberarRepetidor(&repetidor);
+    liberarIndice(&indice);
+    liberarIndiceNomes(&nomes);
+    liberarMansaoCompacta(&mansao);
+    return 1;
+}
+
+// ============================================================================
+// SIMULADOR DE SESSÕES (MULTITHREAD)
+// ============================================================================
+
+// Soma a sessão recém-repetida aos totais locais da thread.
+static void contabilizarSessao(Repetidor* repetidor, const ResultadoSessao* resultado,
+                               TrabalhoSimulacao* totais) {
+    totais->sessoes++;
+    totais->salas += resultado->salas;
+    totais->pistas += resultado->pistas;
+    if (resultado->pistas == 0) totais->semPistas++;
+
+    int lider = -1;
+    size_t lideres = 0; // Suspeitos com os pontos do líder
+    int64_t liderPontos = 0;
+    for (size_t i = 0; i < repetidor->quantidadeSuspeitos; i++) {
+        int64_t pontos = placarDaSessao(repetidor, (int)i);
+        if (pontos >= totais->simulacao->limiar) totais->condenavel[i]++;
+        if (pontos > liderPontos) {
+            lider = (int)i;
+            liderPontos = pontos;
+            lideres = 1;
+        } else if (pontos == liderPontos && pontos > 0) {
+            lideres++;
+        }
+    }
+    if (lideres == 1) {
+        totais->maisCitado[lider]++;
+    } else if (lideres > 1) { // Empate: conta para todos os da frente, à parte
+        for (size_t i = (size_t)lider; i < repetidor->quantidadeSuspeitos; i++) {
+            if (placarDaSessao(repetidor, (int)i) == liderPontos) totais->empatado[i]++;
+        }
+    }
+}
+
+/*
+ * simularSessoes() – corpo de cada thread. Lê apenas a Simulacao comum;
+ * escreve só no próprio Repetidor e nos próprios contadores.
+ */
+void* simularSessoes(void* argumento) {
+    TrabalhoSimulacao* trabalho = argumento;
+    const Simulacao* simulacao = trabalho->simulacao;
+    size_t quantidadeSuspeitos = simulacao->tabela->quantidadeSuspeitos;
+
+    Repetidor repetidor;
+    iniciarRepetidor(&repetidor, simulacao->mansao, simulacao->indice, simulacao->tabela);
+
+    TrabalhoSimulacao totais = *trabalho;
+    totais.sessoes = totais.salas = totais.pistas = totais.semPistas = 0;
+    totais.condenavel = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+    totais.maisCitado = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+    totais.empatado = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+
+    ResultadoSessao resultado;
+    if (simulacao->roteiro == NULL) {
+        // Sessões aleatórias: cada movimento é 'e' ou 'd' (um bit sorteado)
+        char* movimentos = realocarOuSair(NULL, simulacao->movimentosSessao + 1);
+        uint64_t estado = trabalho->semente, bits = 0;
+        int bitsRestantes = 0;
+        for (size_t sessao = trabalho->inicio; sessao < trabalho->fim; sessao++) {
+            for (uint32_t i = 0; i < simulacao->movimentosSessao; i++) {
+                if (bitsRestantes == 0) {
+                    bits = aleatorio(&estado);
+                    bitsRestantes = 64;
+                }
+                movimentos[i] = (bits & 1) ? 'd' : 'e';
+                bits >>= 1;
+                bitsRestantes--;
+            }
+            repetirSessao(&repetidor, movimentos, simulacao->movimentosSessao, &resultado);
+            contabilizarSessao(&repetidor, &resultado, &totais);
+        }
+        free(movimentos);
+    } else {
+        // Sessões gravadas: linhas inteiras dentro da faixa [inicio, fim)
+        const char* roteiro = simulacao->roteiro;
+        size_t posicao = trabalho->inicio;
+        while (posicao < trabalho->fim) {
+            const char* linha = roteiro + posicao;
+            const char* fimLinha = memchr(linha, '\n', simulacao->tamanhoRoteiro - posicao);
+            size_t tamanho = fimLinha ? (size_t)(fimLinha - linha) : simulacao->tamanhoRoteiro - posicao;
+            posicao += tamanho + 1;
+
+            size_t fimMovimentos = 0;
+            while (fimMovimentos < tamanho && linha[fimMovimentos] != ' ' &&
+                   linha[fimMovimentos] != '\t' && linha[fimMovimentos] != '\r') fimMovimentos++;
+            if (tamanho == 0 || fimMovimentos == 0 || linha[0] == '#') continue;
+
+            repetirSessao(&repetidor, linha, fimMovimentos, &resultado);
+            contabilizarSessao(&repetidor, &resultado, &totais);
+        }
+    }
+
+    liberarRepetidor(&repetidor);
+    *trabalho = totais;
+    return NULL;
+}
+
+// Altura (em movimentos) da mansão compacta: filhos vêm depois dos pais.
+static uint32_t alturaMansaoCompacta(const MansaoCompacta* mansao) {
+    uint32_t* altura = realocarOuSair(NULL, (mansao->quantidade + 1) * sizeof(uint32_t));
+    for (size_t i = mansao->quantidade; i-- > 0;) {
+        uint32_t esquerda = compactaEsquerda(mansao, (uint32_t)i);
+        uint32_t direita = compactaDireita(mansao, (uint32_t)i);
+        uint32_t maior = 0;
+        if (esquerda != SEM_SALA && altura[esquerda] + 1 > maior) maior = altura[esquerda] + 1;
+        if (direita != SEM_SALA && altura[direita] + 1 > maior) maior = altura[direita] + 1;
+        altura[i] = maior;
+    }
+    uint32_t resultado = altura[0];
+    free(altura);
+    return resultado;
+}
+
+/*
+ * executarSimulacao() – divide as sessões entre as threads, espera todas e
+ * soma os totais. 'sessoes' é um número (sessões aleatórias) ou um arquivo
+ * no formato do modo lote. threads <= 0 usa um thread por núcleo.
+ */
+int executarSimulacao(Caso* caso, const char* sessoes, int threads) {
+    Simulacao simulacao = {0};
+    MansaoCompacta mansao;
+    size_t quantidade = 0;
+    int descritor = -1;
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+
+    if (sessoes[0] != '\0' && strspn(sessoes, "0123456789") == strlen(sessoes)) {
+        quantidade = strtoull(sessoes, NULL, 10);
+    } else {
+        struct stat info;
+        descritor = open(sessoes, O_RDONLY);
+        if (descritor < 0 || fstat(descritor, &info) != 0) {
+            printf("Erro: não foi possível abrir as sessões '%s'.\n", sessoes);
+            if (descritor >= 0) close(descritor);
+            return 0;
+        }
+        simulacao.tamanhoRoteiro = (size_t)info.st_size;
+        simulacao.roteiro = "";
+        if (simulacao.tamanhoRoteiro > 0) {
+            void* mapa = mmap(NULL, simulacao.tamanhoRoteiro, PROT_READ, MAP_PRIVATE, descritor, 0);
+            if (mapa == MAP_FAILED) {
+                printf("Erro: não foi possível mapear '%s'.\n", sessoes);
+                close(descritor);
+                return 0;
+            }
+            simulacao.roteiro = mapa;
+        }
+    }
+
+    if (!compactarMansao(caso->mansao, caso->quantidadeSalas, &mansao)) {
+        if (descritor >= 0) {
+            if (simulacao.tamanhoRoteiro > 0) munmap((void*)simulacao.roteiro, simulacao.tamanhoRoteiro);
+            close(descritor);
+        }
+        return 0;
+    }
+    IndicePistas indice;
+    construirIndice(&indice, caso);
+    simulacao.mansao = &mansao;
+    simulacao.indice = &indice;
+    simulacao.tabela = &caso->tabela;
+    simulacao.limiar = limiarDoCaso(caso);
+    // Dobro da altura: movimentos para lados sem saída são ignorados
+    simulacao.movimentosSessao = 2 * alturaMansaoCompacta(&mansao) + 1;
+
+    // Faixas: sessões aleatórias em partes iguais; roteiro em bytes,
+    // com cada corte avançado até o início da linha seguinte.
+    TrabalhoSimulacao* trabalhos = realocarOuSair(NULL, threads * sizeof(TrabalhoSimulacao));
+    pthread_t* ids = realocarOuSair(NULL, threads * sizeof(pthread_t));
+    size_t total = simulacao.roteiro ? simulacao.tamanhoRoteiro : quantidade;
+    size_t corteAnterior = 0;
+    for (int t = 0; t < threads; t++) {
+        size_t corte = (t == threads - 1) ? total : total / threads * (t + 1);
+        if (simulacao.roteiro && corte < total) {
+            while (corte > 0 && corte < total && simulacao.roteiro[corte - 1] != '\n') corte++;
+        }
+        if (corte < corteAnterior) corte = corteAnterior;
+        trabalhos[t] = (TrabalhoSimulacao){ .simulacao = &simulacao, .inicio = corteAnterior,
+                                            .fim = corte, .semente = 0x9E3779B97F4A7C15ull * (t + 1) };
+        corteAnterior = corte;
+    }
+
+    double inicio = agoraSegundos();
+    int criadas = 0;
+    for (; criadas < threads; criadas++) {
+        if (pthread_create(&ids[criadas], NULL, simularSessoes, &trabalhos[criadas]) != 0) break;
+    }
+    if (criadas == 0) simularSessoes(&trabalhos[criadas++]); // Sem threads: roda aqui
+    for (int t = 0; t < criadas; t++) pthread_join(ids[t], NULL);
+    for (int t = criadas; t < threads; t++) simularSessoes(&trabalhos[t]); // Faixas que sobraram
+    double decorrido = agoraSegundos() - inicio;
+
+    // Soma dos totais de todas as threads
+    size_t quantidadeSuspeitos = caso->tabela.quantidadeSuspeitos;
+    uint64_t* condenavel = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+    uint64_t* maisCitado = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+    uint64_t* empatado = alocarZeradoOuSair(quantidadeSuspeitos + 1, sizeof(uint64_t));
+    uint64_t somaSessoes = 0, somaSalas = 0, somaPistas = 0, somaSemPistas = 0;
+    for (int t = 0; t < threads; t++) {
+        somaSessoes += trabalhos[t].sessoes;
+        somaSalas += trabalhos[t].salas;
+        somaPistas += trabalhos[t].pistas;
+        somaSemPistas += trabalhos[t].semPistas;
+        for (size_t i = 0; i < quantidadeSuspeitos; i++) {
+            condenavel[i] += trabalhos[t].condenavel[i];
+            maisCitado[i] += trabalhos[t].maisCitado[i];
+            empatado[i] += trabalhos[t].empatado[i];
+        }
+        free(trabalhos[t].condenavel);
+        free(trabalhos[t].maisCitado);
+        free(trabalhos[t].empatado);
+    }
+
+    double porSessao = somaSessoes ? 100.0 / somaSessoes : 0.0;
+    printf("Simulação: %llu sessões, %d threads, %.3f s (%.0f sessões/s)\n",
+           (unsigned long long)somaSessoes, threads, decorrido,
+           decorrido > 0 ? somaSessoes / decorrido : 0.0);
+    printf("Média por sessão: %.2f salas, %.2f pistas; sem pistas: %.1f%%\n",
+           somaSessoes ? (double)somaSalas / somaSessoes : 0.0,
+           somaSessoes ? (double)somaPistas / somaSessoes : 0.0, somaSemPistas * porSessao);
+    printf("Condenável = ao menos %lld ponto(s) contra o suspeito na sessão.\n", (long long)simulacao.limiar);
+    printf("Mais citado = liderou o placar sozinho; Empatado = dividiu a liderança com outro(s).\n");
+    printf("  Condenável  Mais citado    Empatado  Suspeito\n");
+    for (size_t i = 0; i < quantidadeSuspeitos; i++) {
+        printf("  %9.2f%%  %10.2f%%  %9.2f%%  %s\n", condenavel[i] * porSessao, maisCitado[i] * porSessao,
+               empatado[i] * porSessao, textoSimbolo(caso->tabela.suspeitos[i]));
+    }
+
+    free(condenavel);
+    free(maisCitado);
+    free(empatado);
+    free(trabalhos);
+    free(ids);
+    liberarIndice(&indice);
+    liberarMansaoCompacta(&mansao);
+    if (descritor >= 0) {
+        if (simulacao.tamanhoRoteiro > 0) munmap((void*)simulacao.roteiro, simulacao.tamanhoRoteiro);
+        close(descritor);
+    }
+    return 1;
+}
+
+// ============================================================================
+// TABELA CONCORRENTE (INSERÇÃO SEM TRAVAS)
+// ============================================================================
+
+#define CHAVE_CONCORRENTE(palavra) ((palavra) >> 32)
+
+static inline uint64_t palavraConcorrente(int pista, int suspeito) {
+    return ((uint64_t)(uint32_t)(pista + 1) << 32) | (uint32_t)(suspeito + 1);
+}
+
+static inline int suspeitoDaPalavra(uint64_t palavra) {
+    return (int)(palavra & (MOVIDA_CONCORRENTE - 1)) - 1;
+}
+
+static VetorConcorrente* criarVetorConcorrente(size_t capacidade) {
+    VetorConcorrente* vetor = alocarZeradoOuSair(1, sizeof(VetorConcorrente) + capacidade * sizeof(uint64_t));
+    vetor->capacidade = capacidade;
+    return vetor;
+}
+
+void iniciarTabelaConcorrente(TabelaConcorrente* tabela, size_t quantidade) {
+    size_t capacidade = CAPACIDADE_INICIAL_HASH;
+    while (quantidade * 4 > capacidade * 3) capacidade *= 2;
+    atomic_init(&tabela->atual, criarVetorConcorrente(capacidade));
+    atomic_init(&tabela->participantes, 0);
+    atomic_init(&tabela->epoca, 1);
+    for (int p = 0; p < MAX_PARTICIPANTES; p++) {
+        atomic_init(&tabela->participante[p].epoca, 0);
+        tabela->participante[p].aposentados = NULL;
+        tabela->participante[p].liberados = 0;
+    }
+}
+
+/*
+ * registrarParticipante() – lugar de uma thread na tabela (uma vez por
+ * thread, antes das operações; dois usos do mesmo lugar nunca podem ser
+ * simultâneos). Devolve o número a passar a elas.
+ */
+int registrarParticipante(TabelaConcorrente* tabela) {
+    int participante = atomic_fetch_add(&tabela->participantes, 1);
+    if (participante >= MAX_PARTICIPANTES) {
+        printf("Erro: mais de %d threads na tabela concorrente.\n", MAX_PARTICIPANTES);
+        exit(1);
+    }
+    return participante;
+}
+
+// --- Liberação por épocas ---
+// Quem entra numa operação publica a época global que viu. A época só
+// avança quando todas as threads em operação já estão nela; um vetor
+// aposentado na época e é liberado a partir de e + 2, quando ninguém que
+// ainda podia tê-lo alcançado continua em operação.
+
+static void entrarNaEpoca(TabelaConcorrente* tabela, int participante) {
+    // seq_cst: a época publicada é vista antes da leitura de 'atual'
+    atomic_store(&tabela->participante[participante].epoca, atomic_load(&tabela->epoca));
+}
+
+static void tentarAvancarEpoca(TabelaConcorrente* tabela) {
+    uint64_t global = atomic_load(&tabela->epoca);
+    int participantes = atomic_load(&tabela->participantes);
+    for (int p = 0; p < participantes && p < MAX_PARTICIPANTES; p++) {
+        uint64_t vista = atomic_load(&tabela->participante[p].epoca);
+        if (vista != 0 && vista != global) return;
+    }
+    atomic_compare_exchange_strong(&tabela->epoca, &global, global + 1);
+}
+
+static void liberarAposentados(TabelaConcorrente* tabela, int participante) {
+    ParticipanteTabela* eu = &tabela->participante[participante];
+    tentarAvancarEpoca(tabela);
+    uint64_t global = atomic_load(&tabela->epoca);
+    for (VetorConcorrente** elo = &eu->aposentados; *elo != NULL;) {
+        VetorConcorrente* vetor = *elo;
+        if (vetor->epocaAposentado + 2 <= global) {
+            *elo = vetor->aposentadoSeguinte;
+            free(vetor);
+            eu->liberados++;
+        } else {
+            elo = &vetor->aposentadoSeguinte;
+        }
+    }
+}
+
+static void sairDaEpoca(TabelaConcorrente* tabela, int participante) {
+    atomic_store_explicit(&tabela->participante[participante].epoca, 0, memory_order_release);
+    if (tabela->participante[participante].aposentados != NULL) liberarAposentados(tabela, participante);
+}
+
+// Troca o vetor atual pelo seguinte (migração completa) e aposenta o antigo.
+static void avancarAtual(TabelaConcorrente* tabela, int participante, VetorConcorrente* velho) {
+    VetorConcorrente* esperado = velho;
+    if (atomic_compare_exchange_strong(&tabela->atual, &esperado, atomic_load(&velho->proximo))) {
+        velho->epocaAposentado = atomic_load(&tabela->epoca);
+        velho->aposentadoSeguinte = tabela->participante[participante].aposentados;
+        tabela->participante[participante].aposentados = velho;
+    }
+}
+
+// --- Migração para o vetor com o dobro ---
+
+static void iniciarMigracao(VetorConcorrente* vetor) {
+    VetorConcorrente* novo = criarVetorConcorrente(vetor->capacidade * 2);
+    VetorConcorrente* esperado = NULL;
+    if (!atomic_compare_exchange_strong(&vetor->proximo, &esperado, novo)) free(novo); // Outra thread chegou antes
+}
+
+// Cópia da migração: entra só se a pista ainda não estiver no vetor novo
+// (lá, só as cópias a colocam antes do fim da migração). 1 = copiada; quem
+// chama soma as copiadas em 'ocupadas' de uma vez.
+static int colocarSeAusente(VetorConcorrente* vetor, uint64_t palavra) {
+    size_t mascara = vetor->capacidade - 1;
+    size_t i = hashId((int)CHAVE_CONCORRENTE(palavra) - 1, mascara);
+    for (;;) {
+        uint64_t atual = atomic_load(&vetor->posicoes[i]);
+        if (atual == 0 && atomic_compare_exchange_strong(&vetor->posicoes[i], &atual, palavra)) return 1;
+        // Já copiada, ou o vetor novo também migra (e ela já foi junto)
+        if (CHAVE_CONCORRENTE(atual) == CHAVE_CONCORRENTE(palavra) || atual == MOVIDA_CONCORRENTE) return 0;
+        i = (i + 1) & mascara;
+    }
+}
+
+// Congela a posição (nenhuma escrita passa mais por ela) e copia o par.
+// Repetir é inofensivo: a palavra congelada não muda mais.
+static int migrarPosicao(VetorConcorrente* velho, VetorConcorrente* novo, size_t i) {
+    uint64_t palavra = atomic_load(&velho->posicoes[i]);
+    while (!(palavra & MOVIDA_CONCORRENTE) &&
+           !atomic_compare_exchange_weak(&velho->posicoes[i], &palavra, palavra | MOVIDA_CONCORRENTE)) {
+    }
+    return CHAVE_CONCORRENTE(palavra) != 0 && colocarSeAusente(novo, palavra & ~MOVIDA_CONCORRENTE);
+}
+
+/*
+ * ajudarMigracao() – leva a migração do vetor até o fim: pega blocos ainda
+ * livres e, se eles acabarem sem tudo copiado (uma thread parou no meio do
+ * seu), refaz a passada inteira em vez de esperar por ela.
+ */
+static void ajudarMigracao(TabelaConcorrente* tabela, int participante, VetorConcorrente* velho) {
+    VetorConcorrente* novo = atomic_load(&velho->proximo);
+    size_t inicio;
+
+    while (!atomic_load(&velho->completa) &&
+           (inicio = atomic_fetch_add(&velho->proximoBloco, BLOCO_MIGRACAO)) < velho->capacidade) {
+        size_t fim = (inicio + BLOCO_MIGRACAO < velho->capacidade) ? inicio + BLOCO_MIGRACAO : velho->capacidade;
+        size_t copiadas = 0;
+        for (size_t i = inicio; i < fim; i++) copiadas += (size_t)migrarPosicao(velho, novo, i);
+        atomic_fetch_add(&novo->ocupadas, copiadas);
+        if (atomic_fetch_add(&velho->migradas, fim - inicio) + (fim - inicio) == velho->capacidade) {
+            atomic_store(&velho->completa, 1);
+        }
+    }
+    if (!atomic_load(&velho->completa)) {
+        size_t copiadas = 0;
+        for (size_t i = 0; i < velho->capacidade; i++) copiadas += (size_t)migrarPosicao(velho, novo, i);
+        atomic_fetch_add(&novo->ocupadas, copiadas);
+        atomic_store(&velho->completa, 1);
+    }
+    avancarAtual(tabela, participante, velho);
+}
+
+// --- Operações ---
+
+// Grava (ou atualiza) o par no vetor. 0 = achou posição congelada ou o
+// vetor cheio: a escrita tem de ir para o vetor seguinte.
+static int gravarNoVetor(VetorConcorrente* vetor, int pista, uint64_t palavra) {
+    size_t mascara = vetor->capacidade - 1;
+    size_t i = hashId(pista, mascara);
+
+    for (size_t sondagens = 0; sondagens < vetor->capacidade;) {
+        uint64_t atual = atomic_load(&vetor->posicoes[i]);
+        if (atual & MOVIDA_CONCORRENTE) return 0;
+        if (atual == 0 || CHAVE_CONCORRENTE(atual) == CHAVE_CONCORRENTE(palavra)) {
+            if (atomic_compare_exchange_weak(&vetor->posicoes[i], &atual, palavra)) {
+                if (atual == 0) atomic_fetch_add(&vetor->ocupadas, 1);
+                return 1;
+            }
+            continue; // Mudou no meio: examina a mesma posição de novo
+        }
+        i = (i + 1) & mascara;
+        sondagens++;
+    }
+    return 0;
+}
+
+/*
+ * inserirConcorrente() – associa a pista ao suspeito (ou troca o suspeito),
+ * sem travas. Se o vetor está migrando, ajuda a terminar antes de escrever
+ * no novo; se passou de 3/4, começa a migração.
+ */
+void inserirConcorrente(TabelaConcorrente* tabela, int participante, int pista, int suspeito) {
+    uint64_t palavra = palavraConcorrente(pista, suspeito);
+
+    entrarNaEpoca(tabela, participante);
+    VetorConcorrente* vetor = atomic_load(&tabela->atual);
+    for (;;) {
+        if (atomic_load(&vetor->proximo) != NULL) {
+            ajudarMigracao(tabela, participante, vetor);
+            vetor = atomic_load(&vetor->proximo);
+        } else if ((atomic_load(&vetor->ocupadas) + 1) * 4 > vetor->capacidade * 3) {
+            iniciarMigracao(vetor);
+        } else if (gravarNoVetor(vetor, pista, palavra)) {
+            break;
+        } else if (atomic_load(&vetor->proximo) == NULL) {
+            iniciarMigracao(vetor); // Cheio antes do limite (inserções simultâneas)
+        }
+    }
+    sairDaEpoca(tabela, participante);
+}
+
+/*
+ * buscarConcorrente() – id do suspeito da pista, ou SEM_SIMBOLO. Não espera
+ * nem ajuda migrações: uma posição congelada ainda vale enquanto a migração
+ * não terminou, pois até lá ninguém escreve no vetor novo.
+ */
+int buscarConcorrente(TabelaConcorrente* tabela, int participante, int pista) {
+    uint64_t chave = (uint32_t)(pista + 1);
+    int suspeito = SEM_SIMBOLO;
+
+    entrarNaEpoca(tabela, participante);
+    VetorConcorrente* vetor = atomic_load(&tabela->atual);
+    for (;;) {
+        if (atomic_load(&vetor->completa)) {
+            avancarAtual(tabela, participante, vetor);
+            vetor = atomic_load(&vetor->proximo);
+            continue;
+        }
+        size_t mascara = vetor->capacidade - 1;
+        size_t i = hashId(pista, mascara);
+        uint64_t atual = 0;
+        for (size_t sondagens = 0; sondagens < vetor->capacidade; sondagens++, i = (i + 1) & mascara) {
+            atual = atomic_load(&vetor->posicoes[i]);
+            if (CHAVE_CONCORRENTE(atual) == 0 || CHAVE_CONCORRENTE(atual) == chave) break;
+        }
+        if ((atual & MOVIDA_CONCORRENTE) && atomic_load(&vetor->completa)) continue; // A resposta está no novo
+        if (CHAVE_CONCORRENTE(atual) == chave) suspeito = suspeitoDaPalavra(atual);
+        break;
+    }
+    sairDaEpoca(tabela, participante);
+    return suspeito;
+}
+
+// Último vetor da cadeia (com as outras threads paradas, é o que vale).
+static VetorConcorrente* vetorFinal(TabelaConcorrente* tabela) {
+    VetorConcorrente* vetor = atomic_load(&tabela->atual);
+    while (atomic_load(&vetor->proximo) != NULL) vetor = atomic_load(&vetor->proximo);
+    return vetor;
+}
+
+// Associações na tabela (exata com as outras threads paradas).
+size_t quantidadeConcorrente(TabelaConcorrente* tabela) {
+    return atomic_load(&vetorFinal(tabela)->ocupadas);
+}
+
+/*
+ * copiarTabelaConcorrente() – passa as associações para uma TabelaHash, que
+ * monta o elenco. Numa thread só, depois que as outras terminaram.
+ */
+void copiarTabelaConcorrente(TabelaHash* destino, TabelaConcorrente* tabela) {
+    VetorConcorrente* vetor = vetorFinal(tabela);
+    reservarHash(destino, destino->quantidade + atomic_load(&vetor->ocupadas));
+    for (size_t i = 0; i < vetor->capacidade; i++) {
+        uint64_t palavra = atomic_load_explicit(&vetor->posicoes[i], memory_order_relaxed);
+        if (CHAVE_CONCORRENTE(palavra) != 0) {
+            inserirNaHashIds(destino, (int)CHAVE_CONCORRENTE(palavra) - 1, suspeitoDaPalavra(palavra));
+        }
+    }
+}
+
+// Libera a cadeia de vetores e os aposentados que sobraram (threads paradas).
+void liberarTabelaConcorrente(TabelaConcorrente* tabela) {
+    VetorConcorrente* vetor = atomic_load(&tabela->atual);
+    while (vetor != NULL) {
+        VetorConcorrente* proximo = atomic_load(&vetor->proximo);
+        free(vetor);
+        vetor = proximo;
+    }
+    for (int p = 0; p < MAX_PARTICIPANTES; p++) {
+        while (tabela->participante[p].aposentados != NULL) {
+            VetorConcorrente* aposentado = tabela->participante[p].aposentados;
+            tabela->participante[p].aposentados = aposentado->aposentadoSeguinte;
+            free(aposentado);
+        }
+    }
+    atomic_store(&tabela->atual, NULL);
+}
+
+// ============================================================================
+// SERVIDOR DE SESSÕES (SOCKET UNIX E EPOLL)
+// ============================================================================
+
+// Pedido de encerramento (SIGINT/SIGTERM): o laço termina e mostra o relatório.
+static volatile sig_atomic_t servidorEncerrando;
+
+static void pedirEncerramento(int sinal) {
+    (void)sinal;
+    servidorEncerrando = 1;
+}
+
+// Sobe o limite de descritores abertos até o máximo permitido (uma conexão = um descritor).
+static void elevarLimiteDescritores(void) {
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+}
+
+// --- Histograma de latências ---
+
+// Faixa do valor: exata abaixo de 16; acima, 16 faixas por potência de 2.
+static size_t faixaLatencia(uint64_t ns) {
+    if (ns < 16) return (size_t)ns;
+    int expoente = 63 - __builtin_clzll(ns);
+    return (size_t)(expoente - 3) * 16 + ((ns >> (expoente - 4)) & 15);
+}
+
+static void registrarLatencia(HistogramaLatencia* histograma, uint64_t ns) {
+    histograma->contagem[faixaLatencia(ns)]++;
+    histograma->total++;
+    if (ns > histograma->maior) histograma->maior = ns;
+}
+
+// Maior valor da faixa em que cai o percentil pedido (fracao em 0..1), em ns.
+static uint64_t percentilLatencia(const HistogramaLatencia* histograma, double fracao) {
+    uint64_t alvo = (uint64_t)(fracao * histograma->total), acumulado = 0;
+    if (alvo == 0) alvo = 1;
+    for (size_t f = 0; f < FAIXAS_LATENCIA; f++) {
+        acumulado += histograma->contagem[f];
+        if (acumulado < alvo) continue;
+        if (f < 16) return f;
+        int expoente = (int)(f / 16) + 3;
+        uint64_t fim = ((uint64_t)(16 + f % 16 + 1) << (expoente - 4)) - 1;
+        return (fim < histograma->maior) ? fim : histograma->maior;
+    }
+    return histograma->maior;
+}
+
+static void mostrarLatencias(const char* rotulo, const HistogramaLatencia* histograma) {
+    if (histograma->total == 0) return;
+    printf("%s (µs): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  máx %.1f\n", rotulo,
+           percentilLatencia(histograma, 0.50) / 1e3, percentilLatencia(histograma, 0.90) / 1e3,
+           percentilLatencia(histograma, 0.99) / 1e3, percentilLatencia(histograma, 0.999) / 1e3,
+           histograma->maior / 1e3);
+}
+
+// --- Sessões do servidor ---
+
+// Acrescenta texto formatado à resposta da sessão (o buffer cresce se preciso).
+static void responder(SessaoServidor* sessao, const char* formato, ...) {
+    for (;;) {
+        va_list argumentos;
+        size_t livre = sessao->capacidadeSaida - sessao->usadosSaida;
+        va_start(argumentos, formato);
+        int tamanho = vsnprintf(sessao->saida + sessao->usadosSaida, livre, formato, argumentos);
+        va_end(argumentos);
+        if (tamanho < 0) return;
+        if ((size_t)tamanho < livre) {
+            sessao->usadosSaida += (size_t)tamanho;
+            return;
+        }
+        size_t capacidade = sessao->capacidadeSaida ? sessao->capacidadeSaida : 512;
+        while (capacidade - sessao->usadosSaida <= (size_t)tamanho) capacidade *= 2;
+        sessao->saida = realocarOuSair(sessao->saida, capacidade);
+        sessao->capacidadeSaida = capacidade;
+    }
+}
+
+static int compararPistasPorTexto(const void* a, const void* b) {
+    return strcmp(textoSimbolo(*(const int32_t*)a), textoSimbolo(*(const int32_t*)b));
+}
+
+// Fim da exploração: pistas em ordem alfabética, placar dos primeiros e a
+// lista para a acusação (como o relatório do modo -q).
+static void relatorioServidor(Servidor* servidor, SessaoServidor* sessao) {
+    TabelaHash* tabela = servidor->tabela;
+    size_t k = tabela->quantidadeSuspeitos;
+
+    qsort(sessao->coletadas, sessao->quantidadeColetadas, sizeof(int32_t), compararPistasPorTexto);
+    for (size_t i = 0; i < sessao->quantidadeColetadas; i++) {
+        responder(sessao, "coletada\t%s\n", textoSimbolo(sessao->coletadas[i]));
+    }
+    if (sessao->quantidadeColetadas > 0) {
+        int ordem[RANKING_EXIBIDO];
+        size_t total = melhoresSuspeitos(sessao->placar, k, RANKING_EXIBIDO, ordem);
+        for (size_t i = 0; i < total; i++) {
+            responder(sessao, "placar\t%lld\t%s\n", (long long)sessao->placar[ordem[i]],
+                      textoSimbolo(tabela->suspeitos[ordem[i]]));
+        }
+        if (total > 0 && sessao->placar[ordem[0]] > 0) {
+            responder(sessao, "mais_citado\t%s\n", textoSimbolo(tabela->suspeitos[ordem[0]]));
+        }
+    }
+    responder(sessao, "acusar");
+    for (size_t i = 0; i < k; i++) responder(sessao, "\t%s", textoSimbolo(tabela->suspeitos[i]));
+    responder(sessao, "\n");
+    sessao->sala = SEM_SALA;
+}
+
+// Entra na sala: mostra nome e pista, coleta a pista se for nova no caminho
+// (soma os pesos do índice ao placar) e mostra as saídas ou o relatório.
+static void entrarNaSala(Servidor* servidor, SessaoServidor* sessao, uint32_t sala) {
+    const MansaoCompacta* mansao = &servidor->mansao;
+    int32_t pista = mansao->pistas[sala];
+
+    sessao->sala = sala;
+    responder(sessao, "sala\t%s\n", textoSimbolo(mansao->nomes[sala]));
+    if (pista != SEM_SIMBOLO) {
+        responder(sessao, "pista\t%s\n", textoSimbolo(pista));
+        if (servidor->pistaNova[sala] != SEM_SIMBOLO) {
+            if (sessao->quantidadeColetadas == sessao->capacidadeColetadas) {
+                sessao->capacidadeColetadas = sessao->capacidadeColetadas ? sessao->capacidadeColetadas * 2 : 8;
+                sessao->coletadas = realocarOuSair(sessao->coletadas, sessao->capacidadeColetadas * sizeof(int32_t));
+            }
+            sessao->coletadas[sessao->quantidadeColetadas++] = pista;
+            const IndicePistas* indice = &servidor->indice;
+            for (size_t e = indice->inicio[pista]; e < indice->inicio[pista + 1]; e++) {
+                sessao->placar[indice->entradas[e].suspeito] += indice->entradas[e].peso;
+            }
+        }
+    }
+    if (compactaEhFolha(mansao, sala)) {
+        responder(sessao, "fim\tsem_saida\n");
+        relatorioServidor(servidor, sessao);
+    } else {
+        responder(sessao, "saidas\t%s%s\n", compactaEsquerda(mansao, sala) != SEM_SALA ? "e" : "",
+                  compactaDireita(mansao, sala) != SEM_SALA ? "d" : "");
+    }
+}
+
+// Um comando da sessão: movimento durante a exploração, nome na acusação.
+static void executarComando(Servidor* servidor, SessaoServidor* sessao, char* linha) {
+    char* texto = aparar(linha);
+    TabelaHash* tabela = servidor->tabela;
+
+    servidor->comandos++;
+    if (sessao->sala != SEM_SALA) {
+        char opcao = (texto[0] != '\0' && texto[1] == '\0') ? texto[0] : '?';
+        if (opcao == 'e' || opcao == 'E' || opcao == 'd' || opcao == 'D') {
+            uint32_t destino = (opcao == 'e' || opcao == 'E') ? compactaEsquerda(&servidor->mansao, sessao->sala)
+                                                              : compactaDireita(&servidor->mansao, sessao->sala);
+            if (destino != SEM_SALA) entrarNaSala(servidor, sessao, destino);
+            else responder(sessao, "erro\tcaminho_bloqueado\n");
+        } else if (opcao == 's' || opcao == 'S') {
+            responder(sessao, "fim\tsaiu\n");
+            relatorioServidor(servidor, sessao);
+        } else {
+            responder(sessao, "erro\topcao_invalida\n");
+        }
+    } else if (texto[0] == '\0') {
+        responder(sessao, "erro\tnome_vazio\n");
+    } else {
+        size_t primeiro, quantidade;
+        int suspeito = resolverSuspeito(&servidor->nomes, tabela, texto, &primeiro, &quantidade);
+        if (suspeito < 0 && quantidade >= 2) {
+            size_t listados = (quantidade < NOMES_SUGERIDOS) ? quantidade : NOMES_SUGERIDOS;
+            responder(sessao, "sugestoes");
+            for (size_t i = 0; i < listados; i++) {
+                responder(sessao, "\t%s", textoSimbolo(tabela->suspeitos[servidor->nomes.suspeito[primeiro + i]]));
+            }
+            if (listados < quantidade) responder(sessao, "\t+%zu", quantidade - listados);
+            responder(sessao, "\n");
+        } else {
+            // Nome desconhecido: julgamento sem provas, como no jogo
+            long long provas = (suspeito >= 0) ? (long long)sessao->placar[suspeito] : 0;
+            responder(sessao, "veredito\t%s\t%s\t%lld\n", (provas >= servidor->limiar) ? "CULPADO" : "INOCENTE",
+                      (suspeito >= 0) ? textoSimbolo(tabela->suspeitos[suspeito]) : texto, provas);
+            sessao->encerrando = 1;
+        }
+    }
+    responder(sessao, "\n"); // Fim do bloco
+}
+
+// Envia o que der da resposta: 1 = tudo enviado, 0 = socket cheio, -1 = erro.
+static int enviarResposta(SessaoServidor* sessao) {
+    while (sessao->enviadosSaida < sessao->usadosSaida) {
+        ssize_t enviados = send(sessao->descritor, sessao->saida + sessao->enviadosSaida,
+                                sessao->usadosSaida - sessao->enviadosSaida, MSG_NOSIGNAL);
+        if (enviados < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        sessao->enviadosSaida += (size_t)enviados;
+    }
+    sessao->usadosSaida = sessao->enviadosSaida = 0;
+    return 1;
+}
+
+// Fecha a conexão e devolve a sessão à lista de livres.
+static void fecharSessao(Servidor* servidor, SessaoServidor* sessao) {
+    close(sessao->descritor); // Também a tira do epoll
+    if (sessao->anterior != NULL) sessao->anterior->proxima = sessao->proxima;
+    else servidor->ativas = sessao->proxima;
+    if (sessao->proxima != NULL) sessao->proxima->anterior = sessao->anterior;
+    sessao->anterior = NULL;
+    sessao->proxima = servidor->livres;
+    servidor->livres = sessao;
+    servidor->quantidadeAtivas--;
+}
+
+// Liga ou desliga o aviso de "pode escrever" conforme sobrou resposta.
+static int acompanharEscrita(Servidor* servidor, SessaoServidor* sessao, int pendente) {
+    if (pendente == sessao->esperandoEscrita) return 1;
+    struct epoll_event evento = {.events = EPOLLIN | (pendente ? EPOLLOUT : 0), .data.ptr = sessao};
+    sessao->esperandoEscrita = pendente;
+    return epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, sessao->descritor, &evento) == 0;
+}
+
+// Aceita as conexões pendentes; cada uma recebe uma sessão e a sala de entrada.
+static void aceitarConexoes(Servidor* servidor, int ouvinte) {
+    size_t k = servidor->tabela->quantidadeSuspeitos;
+
+    for (;;) {
+        int descritor = accept(ouvinte, NULL, NULL);
+        if (descritor < 0) {
+            if ((errno == EMFILE || errno == ENFILE) && servidor->reserva >= 0) {
+                // Sem descritores: aceita com a reserva e fecha, para a fila não travar o laço
+                close(servidor->reserva);
+                descritor = accept(ouvinte, NULL, NULL);
+                if (descritor >= 0) close(descritor);
+                servidor->reserva = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                fprintf(stderr, "Aviso: limite de descritores; conexão recusada.\n");
+                continue;
+            }
+            return; // EAGAIN: fila vazia
+        }
+        fcntl(descritor, F_SETFL, O_NONBLOCK);
+        fcntl(descritor, F_SETFD, FD_CLOEXEC);
+
+        SessaoServidor* sessao = servidor->livres;
+        if (sessao != NULL) {
+            servidor->livres = sessao->proxima;
+        } else {
+            sessao = poolAlocar(&servidor->pool);
+            sessao->placar = realocarOuSair(NULL, (k + 1) * sizeof(int64_t));
+            sessao->coletadas = NULL;
+            sessao->capacidadeColetadas = 0;
+            sessao->saida = NULL;
+            sessao->capacidadeSaida = 0;
+        }
+        sessao->descritor = descritor;
+        sessao->encerrando = 0;
+        sessao->esperandoEscrita = 0;
+        memset(sessao->placar, 0, (k + 1) * sizeof(int64_t));
+        sessao->quantidadeColetadas = 0;
+        sessao->usadosSaida = sessao->enviadosSaida = 0;
+        sessao->usadosEntrada = 0;
+        sessao->anterior = NULL;
+        sessao->proxima = servidor->ativas;
+        if (servidor->ativas != NULL) servidor->ativas->anterior = sessao;
+        servidor->ativas = sessao;
+        servidor->conexoes++;
+        if (++servidor->quantidadeAtivas > servidor->maiorAtivas) servidor->maiorAtivas = servidor->quantidadeAtivas;
+
+        struct epoll_event evento = {.events = EPOLLIN, .data.ptr = sessao};
+        entrarNaSala(servidor, sessao, 0);
+        responder(sessao, "\n");
+        int enviado = enviarResposta(sessao);
+        if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, descritor, &evento) != 0 || enviado < 0 ||
+            !acompanharEscrita(servidor, sessao, enviado == 0)) {
+            fecharSessao(servidor, sessao);
+        }
+    }
+}
+
+// Eventos de uma conexão: lê, executa as linhas completas e responde.
+// A latência de cada comando vai do despertar do epoll até a resposta sair.
+static void atenderSessao(Servidor* servidor, SessaoServidor* sessao, uint32_t eventos, double despertar) {
+    size_t comandos = 0;
+
+    if (eventos & EPOLLIN) {
+        ssize_t lidos = read(sessao->descritor, sessao->entrada + sessao->usadosEntrada,
+                             TAM_LINHA_SERVIDOR - sessao->usadosEntrada);
+        if (lidos == 0 || (lidos < 0 && errno != EAGAIN && errno != EINTR)) {
+            fecharSessao(servidor, sessao);
+            return;
+        }
+        if (lidos > 0) sessao->usadosEntrada += (size_t)lidos;
+
+        // Comandos chegados depois do veredito são ignorados
+        char* inicio = sessao->entrada;
+        char* fim = sessao->entrada + sessao->usadosEntrada;
+        char* quebra;
+        while (!sessao->encerrando && (quebra = memchr(inicio, '\n', (size_t)(fim - inicio))) != NULL) {
+            *quebra = '\0';
+            executarComando(servidor, sessao, inicio);
+            comandos++;
+            inicio = quebra + 1;
+        }
+        sessao->usadosEntrada = sessao->encerrando ? 0 : (size_t)(fim - inicio);
+        memmove(sessao->entrada, inicio, sessao->usadosEntrada);
+        if (sessao->usadosEntrada == TAM_LINHA_SERVIDOR) {
+            responder(sessao, "erro\tlinha_longa\n\n");
+            sessao->encerrando = 1;
+        }
+    } else if (eventos & (EPOLLERR | EPOLLHUP)) {
+        fecharSessao(servidor, sessao);
+        return;
+    }
+
+    int enviado = enviarResposta(sessao);
+    if (comandos > 0) {
+        uint64_t ns = (uint64_t)((agoraSegundos() - despertar) * 1e9);
+        for (size_t c = 0; c < comandos; c++) registrarLatencia(&servidor->latencia, ns);
+    }
+    if (enviado < 0 || (enviado == 1 && sessao->encerrando) || !acompanharEscrita(servidor, sessao, enviado == 0)) {
+        fecharSessao(servidor, sessao);
+    }
+}
+
+// Devolve placar e buffers de todas as sessões (ativas e livres) e os blocos do pool.
+static void liberarSessoesServidor(Servidor* servidor) {
+    while (servidor->ativas != NULL) fecharSessao(servidor, servidor->ativas);
+    for (SessaoServidor* sessao = servidor->livres; sessao != NULL; sessao = sessao->proxima) {
+        free(sessao->placar);
+        free(sessao->coletadas);
+        free(sessao->saida);
+    }
+    servidor->livres = NULL;
+    poolDestruir(&servidor->pool);
+}
+
+/*
+ * executarServidor() – modo "--servidor": atende sessões do caso num socket
+ * Unix até SIGINT/SIGTERM, com um laço de eventos epoll (nível) numa thread.
+ * Só o que muda por jogador fica na sessão: sala atual, pistas coletadas e
+ * placar; as pistas repetidas no caminho saem de marcarPistasNovas (o mesmo
+ * do perito), calculadas uma vez para o caso. Ao encerrar, mostra conexões,
+ * pico de sessões simultâneas e os percentis de latência por comando.
+ */
+int executarServidor(Caso* caso, const char* caminho) {
+    Servidor servidor;
+    struct sockaddr_un endereco;
+
+    memset(&servidor, 0, sizeof(servidor));
+    memset(&endereco, 0, sizeof(endereco));
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        printf("Erro: caminho do socket longo demais: %s\n", caminho);
+        return 0;
+    }
+    if (!compactarMansao(caso->mansao, caso->quantidadeSalas, &servidor.mansao)) return 0;
+
+    servidor.pistaNova = marcarPistasNovas(&servidor.mansao);
+    servidor.tabela = &caso->tabela;
+    servidor.limiar = limiarDoCaso(caso);
+    construirIndice(&servidor.indice, caso);
+    construirIndiceNomes(&servidor.nomes, &caso->tabela);
+    poolIniciar(&servidor.pool, sizeof(SessaoServidor));
+    elevarLimiteDescritores();
+
+    endereco.sun_family = AF_UNIX;
+    memcpy(endereco.sun_path, caminho, strlen(caminho) + 1);
+    int ouvinte = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(caminho); // Socket de uma execução anterior
+    servidor.epoll = epoll_create1(EPOLL_CLOEXEC);
+    servidor.reserva = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    struct epoll_event evento = {.events = EPOLLIN, .data.ptr = NULL}; // NULL = o ouvinte
+    int ok = ouvinte >= 0 && servidor.epoll >= 0 &&
+             bind(ouvinte, (struct sockaddr*)&endereco, sizeof(endereco)) == 0 &&
+             listen(ouvinte, SOMAXCONN) == 0 &&
+             epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, ouvinte, &evento) == 0;
+
+    if (ok) {
+        struct sigaction acao;
+        memset(&acao, 0, sizeof(acao));
+        acao.sa_handler = pedirEncerramento; // Sem SA_RESTART: epoll_wait volta com EINTR
+        sigaction(SIGINT, &acao, NULL);
+        sigaction(SIGTERM, &acao, NULL);
+        printf("Servidor em %s: %zu salas, %zu suspeitos. Ctrl+C encerra.\n", caminho,
+               caso->quantidadeSalas, caso->tabela.quantidadeSuspeitos);
+        fflush(stdout);
+    } else {
+        printf("Erro: não foi possível abrir o socket '%s': %s\n", caminho, strerror(errno));
+    }
+
+    double inicio = agoraSegundos();
+    struct epoll_event eventos[EVENTOS_POR_ESPERA];
+    while (ok && !servidorEncerrando) {
+        int prontos = epoll_wait(servidor.epoll, eventos, EVENTOS_POR_ESPERA, -1);
+        if (prontos < 0) {
+            if (errno == EINTR) continue;
+            printf("Erro: epoll_wait: %s\n", strerror(errno));
+            ok = 0;
+            break;
+        }
+        double despertar = agoraSegundos();
+        for (int i = 0; i < prontos; i++) {
+            if (eventos[i].data.ptr == NULL) aceitarConexoes(&servidor, ouvinte);
+            else atenderSessao(&servidor, eventos[i].data.ptr, eventos[i].events, despertar);
+        }
+    }
+    double decorrido = agoraSegundos() - inicio;
+
+    if (servidorEncerrando) {
+        printf("\nServidor: %zu conexão(ões), até %zu simultâneas; %zu comando(s) em %.1f s.\n",
+               servidor.conexoes, servidor.maiorAtivas, servidor.comandos, decorrido);
+        printf("Memória por sessão: %zu bytes + %zu de placar (+ pistas e resposta pendente).\n",
+               servidor.pool.tamanhoNo, (caso->tabela.quantidadeSuspeitos + 1) * sizeof(int64_t));
+        mostrarLatencias("Latência por comando, do despertar do epoll ao envio", &servidor.latencia);
+    }
+
+    liberarSessoesServidor(&servidor);
+    if (ouvinte >= 0) close(ouvinte);
+    if (servidor.epoll >= 0) close(servidor.epoll);
+    if (servidor.reserva >= 0) close(servidor.reserva);
+    if (ok || ouvinte >= 0) unlink(caminho);
+    free(servidor.pistaNova);
+    liberarIndice(&servidor.indice);
+    liberarIndiceNomes(&servidor.nomes);
+    liberarMansaoCompacta(&servidor.mansao);
+    return ok;
+}
+
+// ============================================================================
+// GERADOR DE CASOS SINTÉTICOS
+// ============================================================================
+
+void parametrosPadrao(ParametrosCaso* parametros) {
+    parametros->salas = 1000;
+    parametros->aleatoria = 0;
+    parametros->inclinacao = 0;
+    parametros->densidade = 60;
+    parametros->suspeitos = 8;
+    parametros->colisao = 0;
+    parametros->implicacoes = 0;
+    parametros->portas = 0;
+    parametros->semente = 88172645463325252ULL;
+}
+
+// A chave de "chave=valor" (até o '=') é 'nome'?
+static int chaveIgual(const char* argumento, size_t tamanho, const char* nome) {
+    return tamanho == strlen(nome) && strncmp(argumento, nome, tamanho) == 0;
+}
+
+/*
+ * lerParametrosCaso() – lê pares "chave=valor":
+ *   salas=<n>  forma=completa|aleatoria  inclinacao=<0-100>  densidade=<0-100>
+ *   suspeitos=<k>  colisao=<bits>  implica=<0-100>  portas=<n>  semente=<n>
+ * Devolve 0 (com a mensagem) se uma chave ou valor não for válido.
+ */
+int lerParametrosCaso(ParametrosCaso* parametros, int argc, char* argv[]) {
+    for (int i = 0; i < argc; i++) {
+        const char* chave = argv[i];
+        char* valor = strchr(chave, '=');
+        char* fim = NULL;
+        int ok = 0;
+
+        if (valor != NULL) {
+            size_t tamanho = (size_t)(valor - chave);
+            unsigned long long numero = strtoull(++valor, &fim, 10);
+            int numerico = (fim != valor && *fim == '\0');
+
+            if (chaveIgual(chave, tamanho, "forma")) {
+                ok = (strcmp(valor, "completa") == 0 || strcmp(valor, "aleatoria") == 0);
+                parametros->aleatoria = (strcmp(valor, "aleatoria") == 0);
+            } else if (!numerico) {
+                ok = 0;
+            } else if (chaveIgual(chave, tamanho, "salas")) {
+                ok = (numero >= 1 && numero <= MAX_SALAS_COMPACTAS);
+                parametros->salas = (size_t)numero;
+            } else if (chaveIgual(chave, tamanho, "inclinacao")) {
+                ok = (numero <= 100);
+                parametros->inclinacao = (unsigned)numero;
+            } else if (chaveIgual(chave, tamanho, "densidade")) {
+                ok = (numero <= 100);
+                parametros->densidade = (unsigned)numero;
+            } else if (chaveIgual(chave, tamanho, "suspeitos")) {
+                ok = (numero >= 1 && numero <= INT32_MAX);
+                parametros->suspeitos = (size_t)numero;
+            } else if (chaveIgual(chave, tamanho, "colisao")) {
+                ok = (numero <= MAX_BITS_COLISAO);
+                parametros->colisao = (unsigned)numero;
+            } else if (chaveIgual(chave, tamanho, "implica")) {
+                ok = (numero <= 100);
+                parametros->implicacoes = (unsigned)numero;
+            } else if (chaveIgual(chave, tamanho, "portas")) {
+                ok = 1;
+                parametros->portas = (size_t)numero;
+            } else if (chaveIgual(chave, tamanho, "semente")) {
+                ok = 1;
+                parametros->semente = numero ? numero : 1; // O xorshift não sai do zero
+            }
+        }
+        if (!ok) {
+            printf("Erro: parâmetro inválido '%s'.\n", argv[i]);
+            return 0;
+        }
+    }
+    if (parametros->salas < 2) parametros->portas = 0; // Não há duas salas para ligar
+    return 1;
+}
+
+/*
+ * gerarCaso() – grava em 'destino' um caso aleatório, mas válido, no
+ * formato texto (carregarCasoTexto). A árvore é completa ou cresce prendendo
+ * cada sala nova a uma saída livre sorteada (ou, com a chance 'inclinacao',
+ * à sala anterior, alongando corredores). Com 'colisao', as pistas são
+ * escolhidas entre os textos sintéticos cujos bits baixos de funcaoHash são
+ * iguais: longas sequências de sondagem no índice de símbolos (custa cerca
+ * de 2^bits hashes por pista). A mesma semente gera o mesmo caso.
+ */
+int gerarCaso(const char* destino, const ParametrosCaso* parametros) {
+    size_t n = parametros->salas, k = parametros->suspeitos;
+    uint64_t semente = parametros->semente;
+    FILE* saida = fopen(destino, "w");
+
+    if (saida == NULL) {
+        printf("Erro: não foi possível gravar '%s'.\n", destino);
+        return 0;
+    }
+
+    // Filhos de cada sala; na árvore aleatória, as salas com saída livre
+    long (*filhos)[2] = realocarOuSair(NULL, n * sizeof(*filhos));
+    for (size_t i = 0; i < n; i++) filhos[i][0] = filhos[i][1] = -1;
+    if (!parametros->aleatoria) {
+        for (size_t i = 1; i < n; i++) filhos[(i - 1) / 2][(i - 1) % 2] = (long)i;
+    } else {
+        uint32_t* abertas = realocarOuSair(NULL, n * sizeof(uint32_t));
+        size_t quantidadeAbertas = 0;
+        abertas[quantidadeAbertas++] = 0;
+        for (size_t i = 1; i < n; i++) {
+            size_t origem, escolhida = 0;
+            if (aleatorio(&semente) % 100 < parametros->inclinacao) {
+                origem = i - 1; // Acabou de entrar: as duas saídas estão livres
+            } else {
+                escolhida = aleatorio(&semente) % quantidadeAbertas;
+                origem = abertas[escolhida];
+            }
+            int lado = (int)(aleatorio(&semente) & 1);
+            if (filhos[origem][lado] >= 0) lado = !lado;
+            filhos[origem][lado] = (long)i;
+            if (filhos[origem][!lado] >= 0) abertas[escolhida] = abertas[--quantidadeAbertas]; // Lotou
+            abertas[quantidadeAbertas++] = (uint32_t)i;
+        }
+        free(abertas);
+    }
+
+    // Pistas: número do texto sintético de cada sala (SIZE_MAX = sem pista)
+    size_t* textoDaSala = realocarOuSair(NULL, n * sizeof(size_t));
+    uint64_t mascara = ((uint64_t)1 << parametros->colisao) - 1, alvo = 0;
+    size_t candidato = 0;
+    char pista[100];
+    if (parametros->colisao > 0) {
+        gerarPistaSintetica(pista, 0);
+        alvo = funcaoHash(pista) & mascara;
+    }
+    for (size_t i = 0; i < n; i++) {
+        textoDaSala[i] = SIZE_MAX;
+        if (aleatorio(&semente) % 100 >= parametros->densidade) continue;
+        for (;; candidato++) {
+            gerarPistaSintetica(pista, candidato);
+            if ((funcaoHash(pista) & mascara) == alvo) break;
+        }
+        textoDaSala[i] = candidato++;
+    }
+
+    fprintf(saida, "# Caso gerado: %zu salas, forma %s, inclinacao %u%%, densidade %u%%, %zu suspeitos,\n"
+            "# colisao %u bits, implica %u%%, %zu portas, semente %llu\n", n,
+            parametros->aleatoria ? "aleatoria" : "completa", parametros->inclinacao, parametros->densidade, k,
+            parametros->colisao, parametros->implicacoes, parametros->portas,
+            (unsigned long long)parametros->semente);
+    for (size_t i = 0; i < n; i++) {
+        fprintf(saida, "sala %zu %ld %ld Sala %zu", i, filhos[i][0], filhos[i][1], i);
+        if (textoDaSala[i] != SIZE_MAX) {
+            gerarPistaSintetica(pista, textoDaSala[i]);
+            fprintf(saida, " | %s", pista);
+        }
+        fputc('\n', saida);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (textoDaSala[i] == SIZE_MAX) continue;
+        gerarPistaSintetica(pista, textoDaSala[i]);
+        fprintf(saida, "suspeito %s | Suspeito %llu\n", pista, (unsigned long long)(aleatorio(&semente) % k));
+        if (aleatorio(&semente) % 100 < parametros->implicacoes) {
+            fprintf(saida, "implica %s | Suspeito %llu | %llu\n", pista,
+                    (unsigned long long)(aleatorio(&semente) % k), (unsigned long long)(1 + aleatorio(&semente) % 3));
+        }
     }
-}
\ No newline at end of file
+    for (size_t i = 0; i < parametros->portas; i++) {
+        size_t a = aleatorio(&semente) % n, b = aleatorio(&semente) % (n - 1);
+        fprintf(saida, "porta %zu %zu\n", a, (b >= a) ? b + 1 : b);
+    }
+
+    free(filhos);
+    free(textoDaSala);
+    if (fclose(saida) != 0) {
+        printf("Erro: não foi possível gravar '%s'.\n", destino);
+        return 0;
+    }
+    return 1;
+}
+
+// ============================================================================
+// ESTATÍSTICAS (SAÍDA EM JSON)
+// ============================================================================
+
+#ifdef ESTATISTICAS
+// Arquivo gravado na saída; a variável DQ_ESTATISTICAS troca o nome ("-" = stderr).
+#define ARQUIVO_ESTATISTICAS "estatisticas.json"
+
+static const char* const nomesFases[QUANTIDADE_FASES] = {
+    "carga", "mapa", "exploracao", "veredito", "repeticao"
+};
+
+/*
+ * iniciarEstatisticas() – guarda a linha de comando (para identificar o caso
+ * no JSON) e agenda a gravação para a saída do programa, inclusive por exit().
+ */
+void iniciarEstatisticas(int argc, char** argv) {
+    estatisticas.argc = argc;
+    estatisticas.argv = argv;
+    estatisticas.inicio = agoraSegundos();
+    atexit(escreverEstatisticas);
+}
+
+void iniciarFase(FaseJogo fase) {
+    estatisticas.inicioFase[fase] = agoraSegundos();
+}
+
+void encerrarFase(FaseJogo fase) {
+    estatisticas.segundosFase[fase] += agoraSegundos() - estatisticas.inicioFase[fase];
+    estatisticas.vezesFase[fase]++;
+}
+
+// Texto entre aspas, com os caracteres que o JSON não aceita escapados.
+static void escreverTextoJson(FILE* destino, const char* texto) {
+    fputc('"', destino);
+    for (const unsigned char* c = (const unsigned char*)texto; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fprintf(destino, "\\%c", *c);
+        else if (*c < 0x20) fprintf(destino, "\\u%04x", *c);
+        else fputc(*c, destino);
+    }
+    fputc('"', destino);
+}
+
+static void escreverSondagensJson(FILE* destino, const char* nome, SondagensTabela* tabela) {
+    size_t buscas = atomic_load(&tabela->buscas), sondagens = atomic_load(&tabela->sondagens);
+    fprintf(destino, "  \"%s\": {\"buscas\": %zu, \"sondagens\": %zu, \"media\": %.3f, \"maior\": %zu, "
+            "\"faixas\": [", nome, buscas, sondagens, buscas ? (double)sondagens / buscas : 0.0,
+            atomic_load(&tabela->maior));
+    for (size_t f = 0; f < FAIXAS_SONDAGEM; f++) {
+        fprintf(destino, "%s%zu", f ? ", " : "", atomic_load(&tabela->faixas[f]));
+    }
+    fprintf(destino, "]},\n");
+}
+
+/*
+ * escreverEstatisticas() – grava os contadores e os tempos das fases em JSON.
+ * "faixas" conta as buscas por número de sondagens: 1, 2, 3-4, 5-8, ... e
+ * a última, acima de 64. Os tempos vêm do relógio monotônico.
+ */
+void escreverEstatisticas(void) {
+    const char* arquivo = getenv("DQ_ESTATISTICAS") ? getenv("DQ_ESTATISTICAS") : ARQUIVO_ESTATISTICAS;
+    FILE* destino = (strcmp(arquivo, "-") == 0) ? stderr : fopen(arquivo, "w");
+    struct rusage uso;
+
+    if (destino == NULL) {
+        fprintf(stderr, "Erro: não foi possível gravar as estatísticas em '%s'.\n", arquivo);
+        return;
+    }
+    getrusage(RUSAGE_SELF, &uso);
+
+    fprintf(destino, "{\n  \"argumentos\": [");
+    for (int i = 0; i < estatisticas.argc; i++) {
+        if (i > 0) fprintf(destino, ", ");
+        escreverTextoJson(destino, estatisticas.argv[i]);
+    }
+    fprintf(destino, "],\n  \"total_ms\": %.3f,\n  \"fases\": {", (agoraSegundos() - estatisticas.inicio) * 1e3);
+    for (int f = 0, primeira = 1; f < QUANTIDADE_FASES; f++) {
+        if (estatisticas.vezesFase[f] == 0) continue;
+        fprintf(destino, "%s\n    \"%s\": {\"ms\": %.3f, \"vezes\": %zu}", primeira ? "" : ",", nomesFases[f],
+                estatisticas.segundosFase[f] * 1e3, estatisticas.vezesFase[f]);
+        primeira = 0;
+    }
+    fprintf(destino, "\n  },\n");
+    escreverSondagensJson(destino, "simbolos", &estatisticas.simbolos);
+    escreverSondagensJson(destino, "gabarito", &estatisticas.gabarito);
+    fprintf(destino, "  \"pistas\": {\"insercoes\": %zu, \"maior_profundidade\": %zu, \"rotacoes\": %zu},\n",
+            atomic_load(&estatisticas.insercoesPistas), atomic_load(&estatisticas.profundidadePistas),
+            atomic_load(&estatisticas.rotacoesPistas));
+    fprintf(destino, "  \"memoria\": {\"calloc\": %zu, \"realloc\": %zu, \"free\": %zu, "
+            "\"bytes_pedidos\": %zu, \"pico_kb\": %ld}\n}\n",
+            atomic_load(&estatisticas.callocs),
+            atomic_load(&estatisticas.reallocs), atomic_load(&estatisticas.frees),
+            atomic_load(&estatisticas.bytesPedidos), uso.ru_maxrss);
+    if (destino != stderr) fclose(destino);
+}
+#endif
@@ -0,0 +1,2576 @@
+/*
+ * Autor: Augusto Bento Carvalho 
+ * 
+ * Jogo: Detective Quest: O Último Caso – medições e testes de carga
+ * 
+ * Objetivo: Benchmarks das estruturas do jogo, o estresse da tabela
+ * concorrente e o cliente de teste do servidor de sessões, fora do binário
+ * do jogo. Este arquivo inclui Ultimo_Caso.c (sem a main dele): mede as
+ * mesmas estruturas e funções que o jogo usa.
+ *
+ * Compilação:
+ *   gcc -O2 -o Ultimo_Caso_Benchmarks Ultimo_Caso_Benchmarks.c -lpthread
+ *
+ * Uso:
+ *   ./Ultimo_Caso_Benchmarks <alvo> [n]
+ *                                      Benchmarks das estruturas (alvos: suite, hash, avl,
+ *                                      veredito, carga, layout, saida,
+ *                                      pilha, perito, sessao, diario, simd,
+ *                                      gabarito, bitset, ponderado, nomes,
+ *                                      mapa, jogo [salas] [sessoes] [chave=valor...],
+ *                                      concorrente [n] [threads]).
+ *   ./Ultimo_Caso_Benchmarks --cliente <socket> [ociosas] [sessoes]
+ *                                      Teste de carga do servidor (Ultimo_Caso
+ *                                      --servidor): conexões paradas (padrão
+ *                                      1000) e partidas completas (padrão
+ *                                      10000), com latências.
+ */
+
+#define ULTIMO_CASO_SEM_MAIN
+#include "Ultimo_Caso.c"
+
+// ============================================================================
+// MODO BENCHMARK
+// ============================================================================
+
+// Destino dos resultados medidos, para o compilador não descartar o trabalho.
+volatile size_t sumidouroBenchmark;
+
+// --- Tabela encadeada original (referência para comparação) ---
+
+#define TAM_HASH_ENCADEADA 31   // Tamanho da tabela encadeada original
+
+typedef struct HashNodeEncadeado {
+    char pista[100];
+    char suspeito[50];
+    struct HashNodeEncadeado* proximo;
+} HashNodeEncadeado;
+
+static int funcaoHashSomaAscii(char* chave) {
+    int soma = 0;
+    for (int i = 0; chave[i] != '\0'; i++) {
+        soma += chave[i];
+    }
+    return soma % TAM_HASH_ENCADEADA;
+}
+
+static const char* encontrarSuspeitoEncadeado(HashNodeEncadeado* tabela[], char* pista) {
+    HashNodeEncadeado* atual = tabela[funcaoHashSomaAscii(pista)];
+    while (atual != NULL) {
+        if (strcmp(atual->pista, pista) == 0) return atual->suspeito;
+        atual = atual->proximo;
+    }
+    return NULL;
+}
+
+#define CONSULTAS_DISTINTAS 65536
+
+// Mede consultas por ~0,5 s (ou até 'limite' operações) e devolve ns/consulta.
+static double medirConsultas(TabelaHash* nova, HashNodeEncadeado** antiga,
+                             char (*consultas)[100], size_t limite) {
+    size_t feitas = 0, achadas = 0;
+    double inicio = agoraSegundos(), decorrido = 0;
+
+    while (feitas < limite && decorrido < 0.5) {
+        for (int k = 0; k < 64 && feitas < limite; k++, feitas++) {
+            char* pista = consultas[feitas % CONSULTAS_DISTINTAS];
+            const char* r = nova ? encontrarSuspeito(nova, pista) : encontrarSuspeitoEncadeado(antiga, pista);
+            achadas += (r != NULL);
+        }
+        decorrido = agoraSegundos() - inicio;
+    }
+    if (achadas != feitas) printf("  [!] %zu consulta(s) sem resposta\n", feitas - achadas);
+    return decorrido * 1e9 / feitas;
+}
+
+/*
+ * benchmarkHash() – vazão de encontrarSuspeito com n associações,
+ * tabela aberta (FNV-1a) versus a tabela encadeada de 31 posições original.
+ */
+static void benchmarkHash(size_t n) {
+    char (*consultas)[100] = realocarOuSair(NULL, CONSULTAS_DISTINTAS * sizeof *consultas);
+    uint64_t semente = 88172645463325252ULL;
+    char pista[100];
+
+    for (size_t k = 0; k < CONSULTAS_DISTINTAS; k++) {
+        gerarPistaSintetica(consultas[k], aleatorio(&semente) % n);
+    }
+
+    // Tabela atual
+    TabelaHash tabela;
+    iniciarHash(&tabela);
+    double inicio = agoraSegundos();
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        inserirNaHash(&tabela, pista, "Suspeito");
+    }
+    double insercaoNova = (agoraSegundos() - inicio) * 1e9 / n;
+    double consultaNova = medirConsultas(&tabela, NULL, consultas, SIZE_MAX);
+
+    // Consulta por id (caminho do jogo: a pista da sala já está internada)
+    static int ids[CONSULTAS_DISTINTAS];
+    for (size_t k = 0; k < CONSULTAS_DISTINTAS; k++) ids[k] = buscarSimbolo(consultas[k]);
+    size_t feitas = 0, achadas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.5) {
+        for (size_t k = 0; k < CONSULTAS_DISTINTAS; k++, feitas++) {
+            achadas += (encontrarSuspeitoId(&tabela, ids[k]) != SEM_SIMBOLO);
+        }
+    }
+    double consultaId = (agoraSegundos() - inicio) * 1e9 / feitas;
+    sumidouroBenchmark = achadas;
+
+    liberarHash(&tabela);
+    arenaResetar(&arenaCaso);
+    arenaDestruir(&arenaCaso);
+    liberarSimbolos();
+
+    // Tabela encadeada original (os nós vêm de um pool para não medir o malloc)
+    HashNodeEncadeado* antiga[TAM_HASH_ENCADEADA] = {NULL};
+    Pool nos;
+    poolIniciar(&nos, sizeof(HashNodeEncadeado));
+    inicio = agoraSegundos();
+    for (size_t i = 0; i < n; i++) {
+        HashNodeEncadeado* novo = (HashNodeEncadeado*)poolAlocar(&nos);
+        gerarPistaSintetica(novo->pista, i);
+        strcpy(novo->suspeito, "Suspeito");
+        int indice = funcaoHashSomaAscii(novo->pista);
+        novo->proximo = antiga[indice];
+        antiga[indice] = novo;
+    }
+    double insercaoAntiga = (agoraSegundos() - inicio) * 1e9 / n;
+    double consultaAntiga = medirConsultas(NULL, antiga, consultas, SIZE_MAX);
+    poolDestruir(&nos);
+    free(consultas);
+
+    printf("%10zu | %12.1f %12.1f %10.1f | %12.1f %14.1f | %8.1fx\n", n,
+           insercaoNova, consultaNova, consultaId, insercaoAntiga, consultaAntiga,
+           consultaAntiga / consultaNova);
+}
+
+// --- BST sem balanceamento original (referência para comparação) ---
+
+static PistaNode* inserirPistaSemBalanceamento(PistaNode* raiz, int conteudo) {
+    if (raiz == NULL) {
+        PistaNode* novo = (PistaNode*)poolAlocar(&arenaCaso.pistas);
+        novo->conteudo = conteudo;
+        novo->altura = 1;
+        novo->esquerda = NULL;
+        novo->direita = NULL;
+        return novo;
+    }
+
+    if (conteudo == raiz->conteudo) return raiz;
+
+    int cmp = strcmp(textoSimbolo(conteudo), textoSimbolo(raiz->conteudo));
+    if (cmp < 0) {
+        raiz->esquerda = inserirPistaSemBalanceamento(raiz->esquerda, conteudo);
+    } else if (cmp > 0) {
+        raiz->direita = inserirPistaSemBalanceamento(raiz->direita, conteudo);
+    }
+    return raiz;
+}
+
+// Percurso em-ordem que só soma ids (mede a travessia sem o custo do printf).
+static size_t percorrerEmOrdem(PistaNode* raiz) {
+    if (raiz == NULL) return 0;
+    return percorrerEmOrdem(raiz->esquerda) + (size_t)raiz->conteudo +
+           percorrerEmOrdem(raiz->direita);
+}
+
+static int profundidadeReal(PistaNode* raiz) {
+    if (raiz == NULL) return 0;
+    int esq = profundidadeReal(raiz->esquerda);
+    int dir = profundidadeReal(raiz->direita);
+    return 1 + (esq > dir ? esq : dir);
+}
+
+/*
+ * benchmarkAvl() – inserção de n pistas (ordenadas = pior caso da BST simples,
+ * ou aleatórias) e travessia em-ordem, AVL versus BST sem balanceamento.
+ */
+static void benchmarkAvl(size_t n, int ordenadas) {
+    int* pistas = realocarOuSair(NULL, n * sizeof *pistas);
+    uint64_t semente = 88172645463325252ULL;
+    char texto[100];
+
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(texto, ordenadas ? i : aleatorio(&semente) % n);
+        pistas[i] = internar(texto);
+    }
+
+    for (int balanceada = 1; balanceada >= 0; balanceada--) {
+        PistaNode* raiz = NULL;
+
+        double inicio = agoraSegundos();
+        for (size_t i = 0; i < n; i++) {
+            raiz = balanceada ? inserirPista(raiz, pistas[i])
+                              : inserirPistaSemBalanceamento(raiz, pistas[i]);
+        }
+        double insercao = (agoraSegundos() - inicio) * 1e9 / n;
+
+        inicio = agoraSegundos();
+        sumidouroBenchmark = percorrerEmOrdem(raiz);
+        double travessia = (agoraSegundos() - inicio) * 1e9 / n;
+
+        printf("%10zu %-10s %-6s | %14.1f %14.2f | %6d\n", n,
+               ordenadas ? "ordenadas" : "aleatórias", balanceada ? "AVL" : "BST",
+               insercao, travessia, profundidadeReal(raiz));
+        arenaResetar(&arenaCaso);
+    }
+    free(pistas);
+}
+
+// Índice de pesos de uma tabela sintética (só o gabarito, peso 1 por pista).
+static void indiceDaTabela(IndicePistas* indice, TabelaHash* tabela) {
+    Caso caso = {0};
+    caso.tabela = *tabela;
+    construirIndice(indice, &caso);
+}
+
+/*
+ * benchmarkVeredito() – custo de uma acusação com n pistas coletadas e k
+ * suspeitos: placar incremental versus recontagem pela BST.
+ */
+static void benchmarkVeredito(size_t n, size_t k) {
+    TabelaHash tabela;
+    IndicePistas indice;
+    Inventario inventario;
+    char pista[100], suspeito[40];
+
+    iniciarHash(&tabela);
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        sprintf(suspeito, "Suspeito %zu", i % k);
+        inserirNaHash(&tabela, pista, suspeito);
+    }
+    indiceDaTabela(&indice, &tabela);
+    iniciarInventario(&inventario, &indice);
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        coletarPista(&inventario, buscarSimbolo(pista));
+    }
+
+    // Recontagem: cada acusação percorre as n pistas
+    size_t acusacoes = 0, provas = 0;
+    double inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.5) {
+        sprintf(suspeito, "Suspeito %zu", acusacoes++ % k);
+        provas += contarPistasSuspeito(inventario.raiz, &tabela, suspeito);
+    }
+    double recontagem = (agoraSegundos() - inicio) * 1e9 / acusacoes;
+
+    // Placar: cada acusação é uma consulta ao nome e um acesso ao vetor
+    char nomes[64][40];
+    for (size_t i = 0; i < 64; i++) sprintf(nomes[i], "Suspeito %zu", i % k);
+    size_t consultas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.5) {
+        for (size_t i = 0; i < 64; i++, consultas++) {
+            provas += evidenciasContra(&inventario, &tabela, nomes[i]);
+        }
+    }
+    double placar = (agoraSegundos() - inicio) * 1e9 / consultas;
+
+    int* ordem = realocarOuSair(NULL, (k + 1) * sizeof(int));
+    inicio = agoraSegundos();
+    melhoresSuspeitos(inventario.placar, tabela.quantidadeSuspeitos, tabela.quantidadeSuspeitos, ordem);
+    double ranking = (agoraSegundos() - inicio) * 1e9;
+    sumidouroBenchmark = provas + (size_t)ordem[0];
+    free(ordem);
+
+    printf("%10zu %8zu | %14.1f %10.1f | %12.0f\n", n, k, recontagem, placar, ranking);
+
+    liberarInventario(&inventario);
+    liberarIndice(&indice);
+    liberarHash(&tabela);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+/*
+ * benchmarkBitset() – acusação com n pistas no caso (metade coletada) e k
+ * suspeitos: recontagem pela BST, popcount(coletadas & máscara) e placar;
+ * mais "pistas faltando" e "pistas em comum com outra sessão" por palavras.
+ */
+static int benchmarkBitset(size_t n, size_t k) {
+    TabelaHash tabela;
+    IndicePistas indice;
+    Inventario sessao, outra;
+    MascarasSuspeitos mascaras;
+    ConjuntoPistas comuns;
+    uint64_t semente = 88172645463325252ULL;
+    char pista[100], suspeito[40];
+
+    iniciarHash(&tabela);
+    reservarHash(&tabela, n);
+    iniciarConjunto(&comuns);
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        sprintf(suspeito, "Suspeito %zu", i % k);
+        inserirNaHash(&tabela, pista, suspeito);
+    }
+    indiceDaTabela(&indice, &tabela);
+    iniciarInventario(&sessao, &indice);
+    iniciarInventario(&outra, &indice);
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        int id = buscarSimbolo(pista);
+        if (aleatorio(&semente) & 1) coletarPista(&sessao, id);
+        if (aleatorio(&semente) % 3 == 0) coletarPista(&outra, id);
+    }
+    prepararMascaras(&mascaras, &tabela);
+
+    // As três contagens concordam
+    for (size_t s = 0; s < k; s++) {
+        size_t bits = provasNoConjunto(&sessao.coletadas, &mascaras, (int)s);
+        int recontadas = contarPistasSuspeitoId(sessao.raiz, &tabela, tabela.suspeitos[s]);
+        if (bits != (size_t)pontosSuspeito(&sessao, (int)s) || bits != (size_t)recontadas) {
+            printf("Erro: popcount (%zu) difere do placar/recontagem para o suspeito %zu.\n", bits, s);
+            return 1;
+        }
+    }
+
+    char nomes[64][40];
+    for (size_t i = 0; i < 64; i++) sprintf(nomes[i], "Suspeito %zu", i % k);
+    size_t feitas = 0, soma = 0;
+    double inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.3) {
+        soma += (size_t)contarPistasSuspeito(sessao.raiz, &tabela, nomes[feitas++ % 64]);
+    }
+    double recontagem = (agoraSegundos() - inicio) * 1e9 / feitas;
+
+    double tempos[4];
+    for (int medida = 0; medida < 4; medida++) {
+        feitas = 0;
+        inicio = agoraSegundos();
+        while (agoraSegundos() - inicio < 0.3) {
+            for (size_t i = 0; i < 64; i++, feitas++) {
+                int s = (int)(feitas % k);
+                if (medida == 0) soma += provasNoConjunto(&sessao.coletadas, &mascaras, s);
+                else if (medida == 1) soma += (size_t)pontosSuspeito(&sessao, s);
+                else if (medida == 2) soma += pistasFaltando(&sessao.coletadas, &mascaras, s);
+                else {
+                    combinarConjuntos(&comuns, &sessao.coletadas, &outra.coletadas, CONJUNTO_INTERSECAO);
+                    soma += contarConjunto(&comuns);
+                }
+            }
+        }
+        tempos[medida] = (agoraSegundos() - inicio) * 1e9 / feitas;
+    }
+    sumidouroBenchmark = soma;
+
+    printf("%9zu %6zu | %12.1f %9.1f %7.1f | %9.1f %9.1f | %8.1f %8.1f\n", n, k, recontagem, tempos[0],
+           tempos[1], tempos[2], tempos[3], sessao.totalPistas * sizeof(PistaNode) / 1024.0,
+           sessao.coletadas.quantidadePalavras * sizeof(uint64_t) / 1024.0);
+
+    liberarConjunto(&comuns);
+    liberarMascaras(&mascaras);
+    liberarInventario(&sessao);
+    liberarInventario(&outra);
+    liberarIndice(&indice);
+    liberarHash(&tabela);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+    return 0;
+}
+
+static const int64_t* pontosOrdenacao; // Pontos usados pela comparação do qsort
+
+static int compararPontosPonderados(const void* a, const void* b) {
+    int sa = *(const int*)a, sb = *(const int*)b;
+    if (pontosOrdenacao[sa] != pontosOrdenacao[sb]) return (pontosOrdenacao[sa] < pontosOrdenacao[sb]) ? 1 : -1;
+    return sa - sb;
+}
+
+// Recontagem de um suspeito sem índice: percorre gabarito e implicações
+// inteiros somando os pesos das pistas coletadas que apontam para ele.
+static int64_t recontarPonderado(Caso* caso, const ConjuntoPistas* coletadas, int suspeito) {
+    TabelaHash* tabela = &caso->tabela;
+    int64_t pontos = 0;
+    for (size_t i = 0; i < tabela->capacidade; i++) {
+        HashNode* slot = &tabela->slots[i];
+        if (slot->pista != SEM_SIMBOLO && slot->suspeito == suspeito && contemPista(coletadas, slot->pista)) pontos++;
+    }
+    int id = tabela->suspeitos[suspeito];
+    for (size_t i = 0; i < caso->quantidadeImplicacoes; i++) {
+        const Implicacao* implicacao = &caso->implicacoes[i];
+        if (implicacao->suspeito == id && contemPista(coletadas, implicacao->pista)) pontos += implicacao->peso;
+    }
+    return pontos;
+}
+
+/*
+ * benchmarkPonderado() – n pistas, cada uma contra 1 a 4 de k suspeitos
+ * (o principal com peso 1, as implicações com pesos de 1 a 9), metade
+ * coletada: placar do inventário (pesos do índice somados na coleta) +
+ * heap dos 10 primeiros versus ordenar o elenco inteiro e versus recontar
+ * suspeito por suspeito.
+ */
+static int benchmarkPonderado(size_t n, size_t k) {
+    Caso caso;
+    Inventario inventario;
+    IndicePistas indice;
+    uint64_t semente = 0x2545F4914F6CDD1DULL;
+    char pista[100], suspeito[40];
+    int* ids = realocarOuSair(NULL, (n + 1) * sizeof(int));
+    size_t coletadas = 0;
+
+    memset(&caso, 0, sizeof(caso));
+    iniciarHash(&caso.tabela);
+    reservarHash(&caso.tabela, n);
+    for (size_t s = 0; s < k; s++) { // Elenco na ordem dos índices
+        sprintf(suspeito, "Suspeito %zu", s);
+        registrarSuspeito(&caso.tabela, internar(suspeito));
+    }
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        sprintf(suspeito, "Suspeito %zu", (size_t)(aleatorio(&semente) % k));
+        inserirNaHash(&caso.tabela, pista, suspeito);
+        int id = buscarSimbolo(pista);
+        for (uint64_t extras = aleatorio(&semente) % 4; extras > 0; extras--) {
+            int implicado = caso.tabela.suspeitos[aleatorio(&semente) % k];
+            adicionarImplicacao(&caso, id, implicado, (int32_t)(1 + aleatorio(&semente) % 9));
+        }
+        if (aleatorio(&semente) & 1) ids[coletadas++] = id;
+    }
+
+    double inicio = agoraSegundos();
+    construirIndice(&indice, &caso);
+    double construcao = (agoraSegundos() - inicio) * 1e3;
+
+    const int64_t* pontos = NULL;
+    int* ordem = realocarOuSair(NULL, (k + 1) * sizeof(int));
+    int melhores[RANKING_EXIBIDO];
+    size_t feitas = 0, soma = 0;
+
+    // Coletar as pistas num inventário novo (o placar soma os pesos de cada
+    // uma), tirar os 10 primeiros do heap e ordenar o elenco inteiro
+    double tempos[3];
+    for (int medida = 0; medida < 3; medida++) {
+        feitas = 0;
+        inicio = agoraSegundos();
+        while (agoraSegundos() - inicio < 0.3) {
+            if (medida == 0) {
+                iniciarInventario(&inventario, &indice);
+                for (size_t i = 0; i < coletadas; i++) coletarPista(&inventario, ids[i]);
+                soma += (size_t)inventario.placar[feitas % k];
+                liberarInventario(&inventario);
+                poolResetar(&arenaCaso.pistas);
+            } else if (medida == 1) {
+                soma += melhoresSuspeitos(pontos, k, RANKING_EXIBIDO, melhores);
+            } else {
+                for (size_t s = 0; s < k; s++) ordem[s] = (int)s;
+                pontosOrdenacao = pontos;
+                qsort(ordem, k, sizeof(int), compararPontosPonderados);
+                soma += (size_t)ordem[0];
+            }
+            feitas++;
+        }
+        tempos[medida] = (agoraSegundos() - inicio) * 1e6 / feitas;
+        if (medida == 0) { // O inventário que fica para as demais medidas
+            iniciarInventario(&inventario, &indice);
+            for (size_t i = 0; i < coletadas; i++) coletarPista(&inventario, ids[i]);
+            pontos = inventario.placar;
+        }
+    }
+
+    // Recontagem: amostra de suspeitos, extrapolada para o elenco inteiro
+    feitas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.3 || feitas < 8) {
+        int s = (int)(feitas * 7919 % k);
+        int64_t recontados = recontarPonderado(&caso, &inventario.coletadas, s);
+        if (recontados != pontos[s]) {
+            printf("Erro: recontagem (%lld) difere do placar (%lld) para o suspeito %d.\n",
+                   (long long)recontados, (long long)pontos[s], s);
+            return 1;
+        }
+        feitas++;
+    }
+    double recontagem = (agoraSegundos() - inicio) * 1e6 / feitas;
+    sumidouroBenchmark = soma;
+
+    // O heap e a ordenação completa concordam nos primeiros
+    size_t total = melhoresSuspeitos(pontos, k, RANKING_EXIBIDO, melhores);
+    for (size_t i = 0; i < total; i++) {
+        if (melhores[i] != ordem[i]) {
+            printf("Erro: o %zuº do heap (%d) difere do da ordenação (%d).\n", i + 1, melhores[i], ordem[i]);
+            return 1;
+        }
+    }
+
+    printf("%8zu %7zu %8zu | %7.2f | %10.1f %8.1f %10.1f | %11.1f %11.1f\n", n, k,
+           indice.inicio[indice.universo], construcao, tempos[0], tempos[1], tempos[2], recontagem,
+           recontagem * (double)k / 1e3);
+
+    free(ordem);
+    free(ids);
+    liberarInventario(&inventario);
+    liberarIndice(&indice);
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+    return 0;
+}
+
+/*
+ * benchmarkNomes() – acusação num elenco de k nomes com acentos: nome
+ * exato, o mesmo sem caixa/acento e um começo que só serve a ele, pelo
+ * índice ordenado; e a procura sem índice (normaliza e compara cada nome).
+ */
+static int benchmarkNomes(size_t k) {
+    static const char* const nomes[] = {"Álvaro", "Érica", "Ígor", "Otávio", "Úrsula", "Conceição",
+                                        "Joaquim", "Lúcia", "Mônica", "Sebastião", "Inês", "André"};
+    static const char* const sobrenomes[] = {"Araújo", "Gonçalves", "Simões", "Brandão",
+                                             "Magalhães", "Estêvão", "Lúcio", "Assunção"};
+    TabelaHash tabela;
+    IndiceNomes indice;
+    char nome[TAM_NOME_ACUSADO];
+
+    iniciarHash(&tabela);
+    for (size_t i = 0; i < k; i++) {
+        sprintf(nome, "%s %zu %s", nomes[i % 12], i, sobrenomes[(i / 12) % 8]);
+        registrarSuspeito(&tabela, internar(nome));
+    }
+    double inicio = agoraSegundos();
+    construirIndiceNomes(&indice, &tabela);
+    double construcao = (agoraSegundos() - inicio) * 1e3;
+
+    // Consultas: 64 suspeitos espalhados, em três formas cada
+    enum { CONSULTAS = 64 };
+    static char consultas[3][CONSULTAS][TAM_NOME_ACUSADO];
+    int esperado[CONSULTAS];
+    for (size_t q = 0; q < CONSULTAS; q++) {
+        esperado[q] = (int)((q * 2654435761u) % k);
+        strcpy(consultas[0][q], textoSimbolo(tabela.suspeitos[esperado[q]]));
+        normalizarNome(consultas[0][q], consultas[1][q], TAM_NOME_ACUSADO);
+        for (char* c = consultas[1][q]; *c; c++) *c = (char)toupper((unsigned char)*c);
+        // Começo: até a primeira letra depois do número, que já o distingue
+        normalizarNome(consultas[0][q], consultas[2][q], TAM_NOME_ACUSADO);
+        char* numero = strchr(consultas[2][q], ' ');
+        char* depois = strchr(numero + 1, ' ');
+        depois[2] = '\0';
+    }
+
+    double tempos[4];
+    size_t soma = 0;
+    for (int forma = 0; forma < 4; forma++) {
+        size_t feitas = 0;
+        inicio = agoraSegundos();
+        while (agoraSegundos() - inicio < 0.3) {
+            for (size_t q = 0; q < CONSULTAS; q++, feitas++) {
+                size_t primeiro, quantidade;
+                int achado;
+                if (forma < 3) {
+                    achado = resolverSuspeito(&indice, &tabela, consultas[forma][q], &primeiro, &quantidade);
+                } else {
+                    // Sem índice: normaliza a entrada e cada nome do elenco até achar
+                    char chave[TAM_NOME_ACUSADO], outro[TAM_NOME_ACUSADO];
+                    normalizarNome(consultas[1][q], chave, sizeof(chave));
+                    achado = -1;
+                    for (size_t s = 0; s < k && achado < 0; s++) {
+                        normalizarNome(textoSimbolo(tabela.suspeitos[s]), outro, sizeof(outro));
+                        if (strcmp(chave, outro) == 0) achado = (int)s;
+                    }
+                }
+                if (achado != esperado[q]) {
+                    printf("Erro: consulta '%s' resolveu %d, esperado %d.\n", consultas[forma < 3 ? forma : 1][q],
+                           achado, esperado[q]);
+                    return 1;
+                }
+                soma += (size_t)achado;
+            }
+            if (forma == 3 && feitas >= CONSULTAS) break; // Uma rodada já mede a procura linear
+        }
+        tempos[forma] = (agoraSegundos() - inicio) * 1e9 / feitas;
+    }
+
+    // Sugestões para um começo comum a muitos ("alv" = 1/12 do elenco)
+    size_t primeiro, quantidade = 0, feitas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.3) {
+        quantidade = faixaDoPrefixo(&indice, "alv", 3, &primeiro);
+        soma += primeiro;
+        feitas++;
+    }
+    double faixa = (agoraSegundos() - inicio) * 1e9 / feitas;
+    sumidouroBenchmark = soma;
+
+    printf("%9zu | %8.2f | %9.1f %9.1f %9.1f | %9.1f %8zu | %12.0f\n", k, construcao, tempos[0], tempos[1],
+           tempos[2], faixa, quantidade, tempos[3]);
+
+    liberarIndiceNomes(&indice);
+    liberarHash(&tabela);
+    liberarSimbolos();
+    return 0;
+}
+
+// Grava um caso sintético de n salas (árvore completa), com pista em 3 de
+// cada 5 salas, cada pista associada a um de k suspeitos.
+static int gravarCasoSintetico(const char* destino, size_t n, size_t k) {
+    FILE* saida = fopen(destino, "w");
+    char pista[100];
+
+    if (saida == NULL) return 0;
+    for (size_t i = 0; i < n; i++) {
+        long esquerda = (2 * i + 1 < n) ? (long)(2 * i + 1) : -1;
+        long direita = (2 * i + 2 < n) ? (long)(2 * i + 2) : -1;
+        fprintf(saida, "sala %zu %ld %ld Sala %zu", i, esquerda, direita, i);
+        if (i % 5 < 3) {
+            gerarPistaSintetica(pista, i);
+            fprintf(saida, " | %s", pista);
+        }
+        fputc('\n', saida);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (i % 5 >= 3) continue;
+        gerarPistaSintetica(pista, i);
+        fprintf(saida, "suspeito %s | Suspeito %zu\n", pista, i % k);
+    }
+    return fclose(saida) == 0;
+}
+
+/*
+ * benchmarkCarga() – tempo de partida com uma mansão de n salas:
+ * leitura do texto versus mapeamento do binário compilado.
+ */
+static int benchmarkCarga(size_t n) {
+    const char* pastaTemp = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char arquivoTexto[512], arquivoBinario[512];
+    Caso caso;
+
+    snprintf(arquivoTexto, sizeof(arquivoTexto), "%s/dq_carga_%d.txt", pastaTemp, (int)getpid());
+    snprintf(arquivoBinario, sizeof(arquivoBinario), "%s/dq_carga_%d.dqc", pastaTemp, (int)getpid());
+    if (!gravarCasoSintetico(arquivoTexto, n, 8)) {
+        printf("Erro: não foi possível gravar '%s'.\n", arquivoTexto);
+        return 1;
+    }
+
+    double inicio = agoraSegundos();
+    int ok = carregarCasoTexto(&caso, arquivoTexto);
+    double tempoTexto = agoraSegundos() - inicio;
+    ok = ok && compilarCaso(&caso, arquivoBinario);
+    liberarCaso(&caso);
+    liberarSimbolos();
+    arenaResetar(&arenaCaso);
+
+    double tempoBinario = 0;
+    if (ok) {
+        inicio = agoraSegundos();
+        ok = carregarCasoBinario(&caso, arquivoBinario);
+        tempoBinario = agoraSegundos() - inicio;
+        if (ok) {
+            sumidouroBenchmark = (size_t)caso.mansao->nome;
+            liberarSimbolos();
+            liberarCaso(&caso);
+        }
+    }
+    remove(arquivoTexto);
+    remove(arquivoBinario);
+    if (!ok) return 1;
+
+    printf("%10zu | %10.1f ms %8.1f ns/sala | %10.1f ms %8.1f ns/sala\n", n,
+           tempoTexto * 1e3, tempoTexto * 1e9 / n, tempoBinario * 1e3, tempoBinario * 1e9 / n);
+    return 0;
+}
+
+/*
+ * gerarMansaoSintetica() – mansão de n salas criada na arena.
+ * profunda = 0: árvore completa (Eytzinger perfeito).
+ * profunda = 1: corredor de n/2 salas com um cômodo-folha de cada lado,
+ *               alternando (profundidade ~ n/2).
+ * As salas são ligadas numa ordem embaralhada em relação à alocação, como
+ * num heap fragmentado, para que a versão com ponteiros salte pela memória.
+ */
+static Sala* gerarMansaoSintetica(size_t n, int profunda, uint64_t* semente) {
+    Sala** salas = realocarOuSair(NULL, n * sizeof(Sala*));
+    size_t* posicao = realocarOuSair(NULL, n * sizeof(size_t));
+    char nome[40], pista[100];
+
+    for (size_t i = 0; i < n; i++) {
+        sprintf(nome, "Sala %zu", i);
+        gerarPistaSintetica(pista, i);
+        salas[i] = criarSala(nome, (i % 5 < 3) ? pista : NULL);
+        posicao[i] = i;
+    }
+    for (size_t i = n - 1; i > 0; i--) { // Fisher-Yates
+        size_t j = aleatorio(semente) % (i + 1);
+        size_t t = posicao[i]; posicao[i] = posicao[j]; posicao[j] = t;
+    }
+    // Posição lógica k -> sala salas[posicao[k]]
+    for (size_t k = 0; k < n; k++) {
+        Sala* sala = salas[posicao[k]];
+        size_t esquerda, direita;
+        if (!profunda) {
+            esquerda = 2 * k + 1;
+            direita = 2 * k + 2;
+        } else {
+            // Corredor nas posições pares; folhas nas ímpares
+            esquerda = (k % 2 == 0) ? k + 1 : n;
+            direita = (k % 2 == 0) ? k + 2 : n;
+            if ((k / 2) % 2 == 1) { size_t t = esquerda; esquerda = direita; direita = t; }
+        }
+        if (esquerda < n) sala->esquerda = salas[posicao[esquerda]];
+        if (direita < n) sala->direita = salas[posicao[direita]];
+    }
+    Sala* raiz = salas[posicao[0]];
+    free(salas);
+    free(posicao);
+    return raiz;
+}
+
+// Percurso completo com ponteiros (pilha explícita): soma os ids das pistas.
+static size_t somarPistasPonteiros(Sala* raiz, size_t n) {
+    Sala** pilha = realocarOuSair(NULL, (n + 1) * sizeof(Sala*));
+    size_t topo = 0, soma = 0;
+
+    pilha[topo++] = raiz;
+    while (topo > 0) {
+        Sala* sala = pilha[--topo];
+        soma += (size_t)(sala->pista + 1);
+        if (sala->direita) pilha[topo++] = sala->direita;
+        if (sala->esquerda) pilha[topo++] = sala->esquerda;
+    }
+    free(pilha);
+    return soma;
+}
+
+// Percurso completo no layout compacto: uma varredura linear do vetor.
+static size_t somarPistasCompacta(const MansaoCompacta* m) {
+    size_t soma = 0;
+    for (size_t i = 0; i < m->quantidade; i++) soma += (size_t)(m->pistas[i] + 1);
+    return soma;
+}
+
+// Mesma busca em profundidade, mas navegando pelo layout compacto.
+static size_t somarPistasCompactaProfundidade(const MansaoCompacta* m) {
+    uint32_t* pilha = realocarOuSair(NULL, (m->quantidade + 1) * sizeof(uint32_t));
+    size_t topo = 0, soma = 0;
+
+    pilha[topo++] = 0;
+    while (topo > 0) {
+        uint32_t sala = pilha[--topo];
+        soma += (size_t)(m->pistas[sala] + 1);
+        if (compactaDireita(m, sala) != SEM_SALA) pilha[topo++] = compactaDireita(m, sala);
+        if (compactaEsquerda(m, sala) != SEM_SALA) pilha[topo++] = compactaEsquerda(m, sala);
+    }
+    free(pilha);
+    return soma;
+}
+
+// Lista de vizinhos de uma sala com vetor próprio (referência do benchmark
+// do mapa: um malloc por sala, vizinhos espalhados pela memória).
+typedef struct ListaVizinhos {
+    uint32_t* salas;
+    uint32_t quantidade, capacidade;
+} ListaVizinhos;
+
+static void ligarVizinhos(ListaVizinhos* listas, uint32_t a, uint32_t b) {
+    for (int lado = 0; lado < 2; lado++) {
+        ListaVizinhos* lista = &listas[lado ? b : a];
+        if (lista->quantidade == lista->capacidade) {
+            lista->capacidade = lista->capacidade ? lista->capacidade * 2 : 2;
+            lista->salas = realocarOuSair(lista->salas, lista->capacidade * sizeof(uint32_t));
+        }
+        lista->salas[lista->quantidade++] = lado ? a : b;
+    }
+}
+
+// Busca em largura da referência: listas separadas e 'visitada' zerado a cada rota.
+static size_t rotaPorListas(const ListaVizinhos* listas, size_t n, uint8_t* visitada, uint32_t* fila,
+                            uint32_t* distancia, uint32_t origem, uint32_t destino) {
+    memset(visitada, 0, n);
+    size_t inicio = 0, fim = 0;
+    fila[fim++] = origem;
+    visitada[origem] = 1;
+    distancia[origem] = 0;
+    while (inicio < fim) {
+        uint32_t sala = fila[inicio++];
+        if (sala == destino) return distancia[sala];
+        for (uint32_t i = 0; i < listas[sala].quantidade; i++) {
+            uint32_t vizinho = listas[sala].salas[i];
+            if (visitada[vizinho]) continue;
+            visitada[vizinho] = 1;
+            distancia[vizinho] = distancia[sala] + 1;
+            fila[fim++] = vizinho;
+        }
+    }
+    return SIZE_MAX;
+}
+
+/*
+ * benchmarkMapa() – mansão de n salas (árvore completa) com n/4 portas
+ * sorteadas: montagem do CSR e rotas entre salas aleatórias, pelo mapa
+ * (CSR, dois lados, carimbos) versus a busca simples a partir da origem em
+ * listas por sala, com 'visitada' zerado por rota.
+ */
+static int benchmarkMapa(size_t n) {
+    uint64_t semente = 0x9E3779B97F4A7C15ULL;
+    Caso caso;
+
+    memset(&caso, 0, sizeof(caso));
+    caso.mansao = gerarMansaoSintetica(n, 0, &semente);
+    caso.quantidadeSalas = n;
+    caso.quantidadePortas = n / 4;
+    caso.portas = realocarOuSair(NULL, (caso.quantidadePortas + 1) * sizeof(PortaMapa));
+    for (size_t i = 0; i < caso.quantidadePortas; i++) {
+        caso.portas[i].a = (uint32_t)(aleatorio(&semente) % n);
+        do caso.portas[i].b = (uint32_t)(aleatorio(&semente) % n); while (caso.portas[i].b == caso.portas[i].a);
+    }
+
+    MapaSalas mapa;
+    BuscaMapa busca;
+    double inicio = agoraSegundos();
+    if (!construirMapa(&mapa, &caso)) return 1;
+    double construcao = (agoraSegundos() - inicio) * 1e3;
+    iniciarBusca(&busca, n);
+
+    // Referência: as mesmas ligações em listas separadas
+    ListaVizinhos* listas = alocarZeradoOuSair(n, sizeof(ListaVizinhos));
+    uint8_t* visitada = realocarOuSair(NULL, n);
+    uint32_t* fila = realocarOuSair(NULL, n * sizeof(uint32_t));
+    uint32_t* distancia = realocarOuSair(NULL, n * sizeof(uint32_t));
+    inicio = agoraSegundos();
+    for (uint32_t s = 0; s < n; s++) {
+        for (size_t e = mapa.inicio[s]; e < mapa.inicio[s + 1]; e++) {
+            if (mapa.vizinhos[e] > s) ligarVizinhos(listas, s, mapa.vizinhos[e]);
+        }
+    }
+    double construcaoListas = (agoraSegundos() - inicio) * 1e3;
+
+    // Rotas entre pares sorteados; as duas buscas devem dar a mesma distância
+    enum { ROTAS = 64 };
+    uint32_t origens[ROTAS], destinos[ROTAS];
+    for (size_t i = 0; i < ROTAS; i++) {
+        origens[i] = (uint32_t)(aleatorio(&semente) % n);
+        destinos[i] = (uint32_t)(aleatorio(&semente) % n);
+        uint32_t chegada = buscarRota(&mapa, &busca, origens[i], destinos[i], SEM_SIMBOLO);
+        size_t tamanho = 0;
+        for (uint32_t sala = chegada; busca.anterior[sala] != SEM_SALA; sala = busca.anterior[sala]) tamanho++;
+        if (chegada != destinos[i] ||
+            tamanho != rotaPorListas(listas, n, visitada, fila, distancia, origens[i], destinos[i])) {
+            printf("Erro: rota %u -> %u difere entre o mapa e as listas.\n", origens[i], destinos[i]);
+            return 1;
+        }
+    }
+    size_t passos = 0, rotas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.5 || rotas < ROTAS) {
+        size_t i = rotas++ % ROTAS;
+        uint32_t chegada = buscarRota(&mapa, &busca, origens[i], destinos[i], SEM_SIMBOLO);
+        for (uint32_t sala = chegada; busca.anterior[sala] != SEM_SALA; sala = busca.anterior[sala]) passos++;
+    }
+    double porMapa = (agoraSegundos() - inicio) * 1e6 / rotas;
+    double passosMedios = (double)passos / rotas;
+
+    size_t rotasListas = 0, passosListas = 0;
+    inicio = agoraSegundos();
+    while (agoraSegundos() - inicio < 0.5 || rotasListas < ROTAS) {
+        size_t i = rotasListas++ % ROTAS;
+        passosListas += rotaPorListas(listas, n, visitada, fila, distancia, origens[i], destinos[i]);
+    }
+    double porListas = (agoraSegundos() - inicio) * 1e6 / rotasListas;
+    sumidouroBenchmark = passos + passosListas;
+
+    printf("%10zu %9zu | %9.1f %9.1f | %7.1f | %10.1f %10.1f\n", n, caso.quantidadePortas, construcao,
+           construcaoListas, passosMedios, porMapa, porListas);
+
+    for (size_t s = 0; s < n; s++) free(listas[s].salas);
+    free(listas);
+    free(visitada);
+    free(fila);
+    free(distancia);
+    liberarBusca(&busca);
+    liberarMapaSalas(&mapa);
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+    return 0;
+}
+
+/*
+ * benchmarkLayout() – percursos numa mansão de n salas: ponteiros versus
+ * layout compacto (percurso completo e descidas aleatórias até uma folha).
+ */
+static void benchmarkLayout(size_t n, int profunda) {
+    uint64_t semente = 88172645463325252ULL;
+    Sala* raiz = gerarMansaoSintetica(n, profunda, &semente);
+    MansaoCompacta compacta;
+
+    double inicio = agoraSegundos();
+    if (!compactarMansao(raiz, n, &compacta)) return;
+    double conversao = (agoraSegundos() - inicio) * 1e9 / n;
+
+    inicio = agoraSegundos();
+    size_t somaPonteiros = somarPistasPonteiros(raiz, n);
+    double completoPonteiros = (agoraSegundos() - inicio) * 1e9 / n;
+
+    inicio = agoraSegundos();
+    size_t somaProfundidade = somarPistasCompactaProfundidade(&compacta);
+    double completoCompactaDfs = (agoraSegundos() - inicio) * 1e9 / n;
+
+    inicio = agoraSegundos();
+    size_t somaCompacta = somarPistasCompacta(&compacta);
+    double completoCompacta = (agoraSegundos() - inicio) * 1e9 / n;
+
+    if (somaPonteiros != somaCompacta || somaProfundidade != somaCompacta) {
+        printf("  [!] Percursos divergentes\n");
+    }
+
+    // Descidas: escolhas aleatórias até uma folha (ou 'passos' salas no total)
+    size_t passos = 20000000, feitos = 0, soma = 0;
+    uint64_t sementeDescida = 42;
+    inicio = agoraSegundos();
+    while (feitos < passos) {
+        Sala* sala = raiz;
+        while (sala != NULL && feitos < passos) {
+            soma += (size_t)sala->pista;
+            feitos++;
+            sala = (aleatorio(&sementeDescida) & 1) ? (sala->esquerda ? sala->esquerda : sala->direita)
+                                                     : (sala->direita ? sala->direita : sala->esquerda);
+        }
+    }
+    double descidaPonteiros = (agoraSegundos() - inicio) * 1e9 / feitos;
+
+    feitos = 0;
+    sementeDescida = 42;
+    inicio = agoraSegundos();
+    while (feitos < passos) {
+        uint32_t sala = 0;
+        while (sala != SEM_SALA && feitos < passos) {
+            soma += (size_t)compacta.pistas[sala];
+            feitos++;
+            uint32_t esquerda = compactaEsquerda(&compacta, sala);
+            uint32_t direita = compactaDireita(&compacta, sala);
+            sala = (aleatorio(&sementeDescida) & 1) ? (esquerda != SEM_SALA ? esquerda : direita)
+                                                     : (direita != SEM_SALA ? direita : esquerda);
+        }
+    }
+    double descidaCompacta = (agoraSegundos() - inicio) * 1e9 / feitos;
+    sumidouroBenchmark = soma;
+
+    printf("%10zu %-9s | %8.2f | %9.2f %9.2f %9.2f | %9.2f %9.2f\n", n,
+           profunda ? "profunda" : "completa", conversao, completoPonteiros,
+           completoCompactaDfs, completoCompacta, descidaPonteiros, descidaCompacta);
+
+    liberarMansaoCompacta(&compacta);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+// --- Perito: preparo linear e consultas O(1) ---
+
+/*
+ * benchmarkPerito() – tempo de prepararPerito numa mansão sintética de n
+ * salas com k suspeitos, e custo de uma consulta evidenciasAlcancaveis.
+ */
+static void benchmarkPerito(size_t n, size_t k, int profunda) {
+    uint64_t semente = 88172645463325252ULL;
+    char pista[100], suspeito[32];
+    Caso caso;
+    memset(&caso, 0, sizeof(caso));
+    caso.mansao = gerarMansaoSintetica(n, profunda, &semente);
+    caso.quantidadeSalas = n;
+    iniciarHash(&caso.tabela);
+    reservarHash(&caso.tabela, n);
+    for (size_t i = 0; i < n; i++) {
+        if (i % 5 >= 3) continue; // Mesmas salas com pista da mansão sintética
+        gerarPistaSintetica(pista, i);
+        sprintf(suspeito, "Suspeito %zu", i % k);
+        inserirNaHash(&caso.tabela, pista, suspeito);
+    }
+
+    IndicePistas indice;
+    construirIndice(&indice, &caso);
+    Perito local;
+    double inicio = agoraSegundos();
+    int pronto = prepararPerito(&local, &caso, &indice);
+    double preparo = agoraSegundos() - inicio;
+
+    if (pronto) {
+        size_t consultas = 10000000, soma = 0;
+        inicio = agoraSegundos();
+        for (size_t i = 0; i < consultas; i++) {
+            uint32_t sala = (uint32_t)(aleatorio(&semente) % n);
+            soma += evidenciasAlcancaveis(&local, sala, (int)(i % k));
+        }
+        double consulta = (agoraSegundos() - inicio) * 1e9 / consultas;
+        sumidouroBenchmark = soma;
+
+        printf("%10zu %-9s %9zu | %10.1f %10.1f | %10.1f | %8lld\n", n, profunda ? "profunda" : "larga", k,
+               preparo * 1e3, preparo * 1e9 / n, consulta, (long long)local.melhor[0]);
+        liberarPerito(&local);
+    }
+    liberarIndice(&indice);
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+// --- Sessão gravada: gravar e continuar ---
+
+/*
+ * benchmarkSessao() – sessão com n pistas coletadas (k suspeitos): tempo de
+ * gravarSessao, de carregarSessao (mmap + troca de índices por ponteiros) e
+ * da alternativa de reconstruir o inventário chamando coletarPista de novo.
+ */
+static int benchmarkSessao(size_t n, size_t k) {
+    const char* pastaTemp = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char arquivo[512], pista[100], suspeito[32];
+    Caso caso;
+    memset(&caso, 0, sizeof(caso));
+    snprintf(arquivo, sizeof(arquivo), "%s/dq_sessao_%d.dqs", pastaTemp, (int)getpid());
+
+    caso.mansao = criarSala("Hall", NULL);
+    iniciarHash(&caso.tabela);
+    reservarHash(&caso.tabela, n);
+    int* ids = realocarOuSair(NULL, n * sizeof(int));
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(pista, i);
+        sprintf(suspeito, "Suspeito %zu", i % k);
+        inserirNaHash(&caso.tabela, pista, suspeito);
+        ids[i] = internar(pista);
+    }
+
+    IndicePistas indice;
+    construirIndice(&indice, &caso);
+    Inventario original;
+    iniciarInventario(&original, &indice);
+    double inicio = agoraSegundos();
+    for (size_t i = 0; i < n; i++) coletarPista(&original, ids[i]);
+    double tempoColeta = agoraSegundos() - inicio;
+
+    inicio = agoraSegundos();
+    int ok = gravarSessao(arquivo, &original, &caso.tabela);
+    double tempoGravacao = agoraSegundos() - inicio;
+
+    Inventario retomado;
+    SessaoCarregada carregada = {0};
+    Sala* sala = NULL;
+    double tempoCarga = 0;
+    iniciarInventario(&retomado, &indice);
+    if (ok) {
+        inicio = agoraSegundos();
+        ok = carregarSessao(arquivo, &caso, &retomado, &sala, &carregada);
+        tempoCarga = agoraSegundos() - inicio;
+    }
+
+    // Conferência: mesmas pistas em ordem e mesmo placar
+    if (ok) {
+        PistaNode* a = original.raiz;
+        PistaNode* b = retomado.raiz;
+        PistaNode* x;
+        PistaNode* y;
+        do {
+            x = proximoEmOrdem(&a);
+            y = proximoEmOrdem(&b);
+            ok = ok && ((x == NULL) == (y == NULL)) && (x == NULL || x->conteudo == y->conteudo);
+        } while (x != NULL && y != NULL);
+        for (size_t s = 0; s < k; s++) ok = ok && pontosSuspeito(&original, (int)s) == pontosSuspeito(&retomado, (int)s);
+        ok = ok && retomado.totalPistas == original.totalPistas;
+    }
+    size_t tamanho = carregada.tamanho;
+
+    liberarSessaoCarregada(&carregada);
+    liberarInventario(&retomado);
+    liberarInventario(&original);
+    liberarIndice(&indice);
+    free(ids);
+    remove(arquivo);
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+    if (!ok) {
+        printf("Erro: a sessão retomada difere da gravada.\n");
+        return 1;
+    }
+
+    printf("%10zu %9zu | %9.1f MB | %10.1f %10.1f | %10.1f\n", n, k, tamanho / 1e6,
+           tempoGravacao * 1e3, tempoCarga * 1e3, tempoColeta * 1e3);
+    return 0;
+}
+
+// --- Diário de movimentos: custo por passo e recuperação ---
+
+#define PASSOS_SINCRONIA_CADA 2000
+
+/*
+ * benchmarkDiario() – partida de n passos num corredor (pista a cada 4
+ * salas, 8 suspeitos) pelo caminho de escrita de explorarSalas: coleta,
+ * anotação e confirmação a cada passo. Compara sem diário, sincronias
+ * agrupadas (passos sem espera entre eles), só write e fdatasync a cada
+ * passo (o jogo, que sincroniza antes de esperar o jogador; em até
+ * PASSOS_SINCRONIA_CADA passos), e refaz a partida pelo diário agrupado.
+ */
+static int benchmarkDiario(size_t n) {
+    static const char* politicas[] = {"sem diário", "agrupado", "só write", "fdatasync/passo"};
+    const char* pastaTemp = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char arquivo[512], nome[32], pista[100], suspeito[32];
+    Caso caso;
+    memset(&caso, 0, sizeof(caso));
+    snprintf(arquivo, sizeof(arquivo), "%s/dq_diario_%d.dqj", pastaTemp, (int)getpid());
+
+    caso.mansao = criarSala("Sala 0", NULL);
+    iniciarHash(&caso.tabela);
+    reservarHash(&caso.tabela, n / 4 + 1);
+    Sala* ultima = caso.mansao;
+    for (size_t i = 1; i <= n; i++) {
+        int temPista = (i % 4 == 0);
+        sprintf(nome, "Sala %zu", i);
+        if (temPista) {
+            gerarPistaSintetica(pista, i);
+            sprintf(suspeito, "Suspeito %zu", i % 8);
+            inserirNaHash(&caso.tabela, pista, suspeito);
+        }
+        Sala* nova = criarSala(nome, temPista ? pista : NULL);
+        if (i % 2) ultima->direita = nova;
+        else ultima->esquerda = nova;
+        ultima = nova;
+    }
+    caso.quantidadeSalas = n + 1;
+    IndicePistas indice;
+    construirIndice(&indice, &caso);
+
+    double nsBase = 0, tempoRecuperacao = 0;
+    size_t tamanhoDiario = 0;
+    int ok = 1;
+    for (int politica = 0; politica < 4 && ok; politica++) {
+        size_t passos = (politica == 3 && n > PASSOS_SINCRONIA_CADA) ? PASSOS_SINCRONIA_CADA : n;
+        Inventario inventario;
+        Diario registro;
+        memset(&registro, 0, sizeof(registro));
+        iniciarInventario(&inventario, &indice);
+        trajeto.passos = 0;
+        if (politica > 0) ok = abrirDiario(&registro, arquivo, &caso.tabela);
+        if (politica == 2) registro.limiteSincronia = SIZE_MAX, registro.intervaloSincronia = 1e30;
+        if (politica == 3) registro.limiteSincronia = 0;
+
+        Sala* atual = caso.mansao;
+        double inicio = agoraSegundos();
+        for (size_t i = 0; i < passos && ok; i++) {
+            if (atual->pista != SEM_SIMBOLO && coletarPista(&inventario, atual->pista)) {
+                anotarDiario(&registro, 'p', atual->pista);
+            }
+            char lado = atual->esquerda ? 'e' : 'd';
+            atual = (lado == 'e') ? atual->esquerda : atual->direita;
+            registrarMovimento(lado);
+            anotarDiario(&registro, lado, 0);
+            confirmarDiario(&registro, 0);
+        }
+        double ns = (agoraSegundos() - inicio) * 1e9 / passos;
+        size_t sincronias = registro.sincronias;
+        fecharDiario(&registro);
+        if (politica == 0) nsBase = ns;
+
+        if (ok && politica == 1) {
+            // Recuperação: mesma sala, mesmas pistas e mesmo placar
+            struct stat info;
+            Inventario refeito;
+            Diario retomado;
+            Sala* sala = NULL;
+            memset(&retomado, 0, sizeof(retomado));
+            iniciarInventario(&refeito, &indice);
+            tamanhoDiario = (stat(arquivo, &info) == 0) ? (size_t)info.st_size : 0;
+            inicio = agoraSegundos();
+            ok = recuperarDiario(&retomado, arquivo, &caso, &refeito, &sala);
+            tempoRecuperacao = agoraSegundos() - inicio;
+            ok = ok && sala == atual && retomado.movimentos == passos && trajeto.passos == passos &&
+                 refeito.totalPistas == inventario.totalPistas;
+            for (int s = 0; ok && s < 8; s++) ok = pontosSuspeito(&refeito, s) == pontosSuspeito(&inventario, s);
+            fecharDiario(&retomado);
+            liberarInventario(&refeito);
+        }
+        liberarInventario(&inventario);
+        printf("%10zu | %10.1f %10.1f | %10zu  %s\n", passos, ns, (politica > 0) ? ns - nsBase : 0.0,
+               sincronias, politicas[politica]);
+    }
+
+    remove(arquivo);
+    free(trajeto.movimentos);
+    memset(&trajeto, 0, sizeof(trajeto));
+    liberarIndice(&indice);
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+    if (!ok) {
+        printf("Erro: a partida refeita pelo diário difere da jogada.\n");
+        return 1;
+    }
+    printf("Diário de %zu passos: %.1f MB (%.2f bytes/passo); recuperação em %.1f ms (%.1f ns/passo).\n", n,
+           tamanhoDiario / 1e6, (double)tamanhoDiario / n, tempoRecuperacao * 1e3, tempoRecuperacao * 1e9 / n);
+    return 0;
+}
+
+// --- Tabela concorrente: estresse e vazão de 1 a N threads ---
+
+#define LEITORES_ESTRESSE 2
+
+typedef enum {
+    ESCRITA_ESTRESSE,     // Insere as próprias pistas, depois atualiza todas
+    LEITURA_ESTRESSE,     // Consulta sorteadas até os escritores terminarem
+    CARGA_SEM_TRAVA,
+    CARGA_COM_TRAVA,      // TabelaHash protegida por um mutex
+    BUSCA_SEM_TRAVA,
+    BUSCA_TABELA_PRONTA   // TabelaHash só lida (referência)
+} ModoConcorrente;
+
+// Dados comuns às threads de uma rodada.
+typedef struct EnsaioConcorrente {
+    TabelaConcorrente* tabela;
+    TabelaHash* comTrava;
+    pthread_mutex_t trava;
+    pthread_barrier_t fase;       // Entre inserção e atualização (escritores)
+    atomic_size_t* progresso;     // Por escritor: pistas próprias já inseridas
+    atomic_int escritoresAtivos;
+    size_t chaves;
+    int escritores;
+} EnsaioConcorrente;
+
+typedef struct TrabalhoConcorrente {
+    EnsaioConcorrente* ensaio;
+    ModoConcorrente modo;
+    int indice, threads;
+    int participante;             // Lugar na tabela sem travas (um por thread, em todos os modos)
+    uint64_t semente;
+    size_t consultas, erros;
+} TrabalhoConcorrente;
+
+// Suspeito da pista antes e depois da atualização (o estresse confere ambos).
+static int suspeitoInicial(size_t pista) {
+    return 1000 + (int)(pista % 7);
+}
+
+static int suspeitoFinal(size_t pista) {
+    return 2000 + (int)(pista % 11);
+}
+
+static void* trabalharConcorrente(void* argumento) {
+    TrabalhoConcorrente* trabalho = argumento;
+    EnsaioConcorrente* ensaio = trabalho->ensaio;
+    size_t n = ensaio->chaves;
+    int participante = trabalho->participante;
+
+    switch (trabalho->modo) {
+    case ESCRITA_ESTRESSE: {
+        // Pistas próprias (indice, indice + escritores, ...) em ordem, com o
+        // progresso publicado a cada uma; depois, todas as pistas a partir de
+        // um ponto diferente por escritor, disputando as mesmas posições
+        size_t proprias = 0;
+        for (size_t k = (size_t)trabalho->indice; k < n; k += (size_t)ensaio->escritores) {
+            inserirConcorrente(ensaio->tabela, participante, (int)k, suspeitoInicial(k));
+            atomic_store_explicit(&ensaio->progresso[trabalho->indice], ++proprias, memory_order_release);
+        }
+        pthread_barrier_wait(&ensaio->fase);
+        for (size_t j = 0, k = n / (size_t)ensaio->escritores * (size_t)trabalho->indice; j < n; j++) {
+            inserirConcorrente(ensaio->tabela, participante, (int)k, suspeitoFinal(k));
+            if (++k == n) k = 0;
+        }
+        atomic_fetch_sub(&ensaio->escritoresAtivos, 1);
+        break;
+    }
+    case LEITURA_ESTRESSE:
+        // Pista cujo dono já publicou tem de estar lá, com um dos dois suspeitos
+        while (atomic_load(&ensaio->escritoresAtivos) > 0) {
+            size_t k = aleatorio(&trabalho->semente) % n;
+            size_t dono = k % (size_t)ensaio->escritores, ordem = k / (size_t)ensaio->escritores;
+            size_t publicadas = atomic_load_explicit(&ensaio->progresso[dono], memory_order_acquire);
+            int suspeito = buscarConcorrente(ensaio->tabela, participante, (int)k);
+            if ((suspeito == SEM_SIMBOLO && ordem < publicadas) ||
+                (suspeito != SEM_SIMBOLO && suspeito != suspeitoInicial(k) && suspeito != suspeitoFinal(k))) {
+                trabalho->erros++;
+            }
+            trabalho->consultas++;
+        }
+        break;
+    case CARGA_SEM_TRAVA:
+        for (size_t k = (size_t)trabalho->indice; k < n; k += (size_t)trabalho->threads) {
+            inserirConcorrente(ensaio->tabela, participante, (int)k, suspeitoInicial(k));
+        }
+        break;
+    case CARGA_COM_TRAVA:
+        for (size_t k = (size_t)trabalho->indice; k < n; k += (size_t)trabalho->threads) {
+            pthread_mutex_lock(&ensaio->trava);
+            inserirNaHashIds(ensaio->comTrava, (int)k, suspeitoInicial(k));
+            pthread_mutex_unlock(&ensaio->trava);
+        }
+        break;
+    case BUSCA_SEM_TRAVA:
+    case BUSCA_TABELA_PRONTA:
+        for (size_t c = (size_t)trabalho->indice; c < n; c += (size_t)trabalho->threads) {
+            int pista = (int)(aleatorio(&trabalho->semente) % n);
+            int suspeito = (trabalho->modo == BUSCA_SEM_TRAVA)
+                               ? buscarConcorrente(ensaio->tabela, participante, pista)
+                               : encontrarSuspeitoId(ensaio->comTrava, pista);
+            trabalho->erros += (suspeito != suspeitoInicial((size_t)pista));
+            trabalho->consultas++;
+        }
+        break;
+    }
+    return NULL;
+}
+
+// Roda os trabalhos, um por thread (os que não ganharem thread rodam aqui).
+// Devolve o tempo de parede e soma os erros.
+static double rodarConcorrentes(TrabalhoConcorrente* trabalhos, int quantidade, size_t* erros) {
+    pthread_t ids[MAX_PARTICIPANTES];
+    int criadas = 0;
+    double inicio = agoraSegundos();
+    for (; criadas < quantidade; criadas++) {
+        if (pthread_create(&ids[criadas], NULL, trabalharConcorrente, &trabalhos[criadas]) != 0) break;
+    }
+    for (int t = 0; t < criadas; t++) pthread_join(ids[t], NULL);
+    for (int t = criadas; t < quantidade; t++) trabalharConcorrente(&trabalhos[t]);
+    double decorrido = agoraSegundos() - inicio;
+    for (int t = 0; t < quantidade; t++) *erros += trabalhos[t].erros;
+    return decorrido;
+}
+
+static size_t vetoresLiberados(TabelaConcorrente* tabela) {
+    size_t total = 0;
+    for (int p = 0; p < MAX_PARTICIPANTES; p++) total += tabela->participante[p].liberados;
+    return total;
+}
+
+/*
+ * estresseConcorrente() – escritores inserindo e atualizando as mesmas
+ * pistas enquanto leitores consultam, a partir de uma tabela mínima (com
+ * várias migrações no meio). Confere cada consulta durante a carga, o
+ * estado final pela busca e pela cópia para uma TabelaHash.
+ */
+static int estresseConcorrente(size_t n, int escritores) {
+    TabelaConcorrente tabela;
+    TabelaHash copia;
+    EnsaioConcorrente ensaio = {.tabela = &tabela, .chaves = n, .escritores = escritores};
+    TrabalhoConcorrente trabalhos[MAX_PARTICIPANTES];
+    int quantidade = escritores + LEITORES_ESTRESSE;
+    size_t erros = 0, consultas = 0;
+
+    iniciarTabelaConcorrente(&tabela, 0);
+    ensaio.progresso = alocarZeradoOuSair((size_t)escritores, sizeof(atomic_size_t));
+    atomic_init(&ensaio.escritoresAtivos, escritores);
+    pthread_barrier_init(&ensaio.fase, NULL, (unsigned)escritores);
+    for (int t = 0; t < quantidade; t++) {
+        trabalhos[t] = (TrabalhoConcorrente){.ensaio = &ensaio, .indice = t < escritores ? t : t - escritores,
+                                             .modo = t < escritores ? ESCRITA_ESTRESSE : LEITURA_ESTRESSE,
+                                             .participante = registrarParticipante(&tabela),
+                                             .semente = 0x9E3779B97F4A7C15ull * (uint64_t)(t + 1)};
+    }
+    double decorrido = rodarConcorrentes(trabalhos, quantidade, &erros);
+    for (int t = escritores; t < quantidade; t++) consultas += trabalhos[t].consultas;
+
+    // Estado final: todas as pistas com o suspeito da atualização
+    int participante = registrarParticipante(&tabela);
+    for (size_t k = 0; k < n; k++) erros += (buscarConcorrente(&tabela, participante, (int)k) != suspeitoFinal(k));
+    erros += (quantidadeConcorrente(&tabela) != n);
+    iniciarHash(&copia);
+    copiarTabelaConcorrente(&copia, &tabela);
+    for (size_t k = 0; k < n; k++) erros += (encontrarSuspeitoId(&copia, (int)k) != suspeitoFinal(k));
+    erros += (copia.quantidade != n || copia.quantidadeSuspeitos != 11);
+
+    printf("Estresse: %d escritores e %d leitores, %zu pistas (%zu escritas), %zu consultas durante a carga,\n"
+           "          %zu vetores liberados por época em %.2f s: %s\n",
+           escritores, LEITORES_ESTRESSE, n, n * (size_t)(escritores + 1), consultas, vetoresLiberados(&tabela),
+           decorrido, erros ? "FALHOU" : "ok");
+
+    liberarHash(&copia);
+    liberarTabelaConcorrente(&tabela);
+    pthread_barrier_destroy(&ensaio.fase);
+    free(ensaio.progresso);
+    return erros ? 1 : 0;
+}
+
+/*
+ * benchmarkConcorrente() – n pistas carregadas (a partir da tabela mínima,
+ * migrações incluídas) e n consultas sorteadas, por 1, 2, 4... threads:
+ * tabela sem travas, TabelaHash com mutex e TabelaHash pronta só lida. A
+ * thread t ocupa o mesmo lugar da tabela em todos os modos da rodada.
+ */
+static int benchmarkConcorrente(size_t n, int maximo) {
+    size_t erros = 0;
+
+    for (int threads = 1;; threads = (threads * 2 < maximo) ? threads * 2 : maximo) {
+        TabelaConcorrente tabela;
+        TabelaHash comTrava;
+        EnsaioConcorrente ensaio = {.tabela = &tabela, .comTrava = &comTrava, .chaves = n};
+        TrabalhoConcorrente trabalhos[MAX_PARTICIPANTES];
+        int participantes[MAX_PARTICIPANTES];
+        double tempos[4];
+        static const ModoConcorrente modos[4] = {CARGA_SEM_TRAVA, CARGA_COM_TRAVA, BUSCA_SEM_TRAVA,
+                                                 BUSCA_TABELA_PRONTA};
+
+        iniciarTabelaConcorrente(&tabela, 0);
+        iniciarHash(&comTrava);
+        pthread_mutex_init(&ensaio.trava, NULL);
+        for (int t = 0; t < threads; t++) participantes[t] = registrarParticipante(&tabela);
+        for (int m = 0; m < 4; m++) {
+            for (int t = 0; t < threads; t++) {
+                trabalhos[t] = (TrabalhoConcorrente){.ensaio = &ensaio, .modo = modos[m], .indice = t,
+                                                     .threads = threads, .participante = participantes[t],
+                                                     .semente = 0x9E3779B97F4A7C15ull * (uint64_t)(t + 1)};
+            }
+            tempos[m] = rodarConcorrentes(trabalhos, threads, &erros);
+        }
+        printf("%7d | %10.2f %10.2f | %10.2f %10.2f | %9zu\n", threads, n / tempos[0] / 1e6, n / tempos[1] / 1e6,
+               n / tempos[2] / 1e6, n / tempos[3] / 1e6, vetoresLiberados(&tabela));
+        pthread_mutex_destroy(&ensaio.trava);
+        liberarHash(&comTrava);
+        liberarTabelaConcorrente(&tabela);
+        if (threads == maximo) break;
+    }
+    if (erros) printf("Erro: %zu consulta(s) com suspeito errado.\n", erros);
+    return erros ? 1 : 0;
+}
+
+// --- Textos vetorizados: hash ---
+
+#define TEXTOS_SIMD 4096
+
+static const char* nomesSimd[] = {"escalar", "sse2", "avx2"};
+
+// strcmp byte a byte, como escrito à mão (referência sem vetores).
+static int compararBytes(const char* a, const char* b) {
+    const unsigned char* ua = (const unsigned char*)a;
+    const unsigned char* ub = (const unsigned char*)b;
+    while (*ua != '\0' && *ua == *ub) {
+        ua++;
+        ub++;
+    }
+    return *ua - *ub;
+}
+
+// FNV-1a byte a byte, o hash anterior da tabela de símbolos.
+static uint64_t hashFnv(const char* chave) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* c = (const unsigned char*)chave; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Pista longa: ~90 bytes de prefixo comum e a diferença só no fim.
+static void gerarPistaLonga(char* destino, size_t i) {
+    sprintf(destino, "Pista encontrada no comodo leste da mansao, debaixo do tapete persa, perto da lareira: %09u",
+            (unsigned)(i % 1000000000));
+}
+
+// Milhões de comparações por segundo de 'comparar' sobre pares do conjunto.
+static double medirComparacoes(int (*comparar)(const char*, const char*), char (*textos)[100], size_t vezes) {
+    size_t soma = 0;
+    double inicio = agoraSegundos();
+    for (size_t r = 0; r < vezes; r++) {
+        size_t i = r & (TEXTOS_SIMD - 1);
+        soma += (size_t)(comparar(textos[i], textos[(i * 7 + 1) & (TEXTOS_SIMD - 1)]) > 0);
+    }
+    sumidouroBenchmark = soma;
+    return vezes / (agoraSegundos() - inicio) / 1e6;
+}
+
+static double medirHashes(uint64_t (*calcular)(const char*), char (*textos)[100], size_t vezes) {
+    uint64_t soma = 0;
+    double inicio = agoraSegundos();
+    for (size_t r = 0; r < vezes; r++) soma += calcular(textos[r & (TEXTOS_SIMD - 1)]);
+    sumidouroBenchmark = (size_t)soma;
+    return vezes / (agoraSegundos() - inicio) / 1e6;
+}
+
+/*
+ * benchmarkSimd() – hashes por segundo em pistas com prefixo longo em comum
+ * (FNV-1a e cada nível vetorial; a comparação do strcmp da libc e de um laço
+ * byte a byte como referência) e o efeito em inserirPista e
+ * encontrarSuspeito com n pistas. Confere que todos os níveis dão o mesmo
+ * hash.
+ */
+static int benchmarkSimd(size_t n) {
+    char (*textos)[100] = realocarOuSair(NULL, TEXTOS_SIMD * sizeof *textos);
+    uint64_t semente = 88172645463325252ULL;
+    size_t vezes = 20000000;
+    NivelSimd melhor = detectarSimd();
+    int ok = 1;
+
+    for (size_t i = 0; i < TEXTOS_SIMD; i++) gerarPistaLonga(textos[i], aleatorio(&semente) % 1000000000);
+
+    // Mesmo hash em todos os níveis
+    for (int nivel = SIMD_ESCALAR; nivel <= (int)melhor; nivel++) {
+        for (size_t i = 0; i < TEXTOS_SIMD && ok; i++) {
+            escolherSimd(SIMD_ESCALAR);
+            uint64_t referencia = funcaoHash(textos[i]);
+            escolherSimd((NivelSimd)nivel);
+            ok = funcaoHash(textos[i]) == referencia;
+        }
+    }
+    if (!ok) {
+        free(textos);
+        escolherSimd(melhor);
+        printf("Erro: os níveis vetoriais discordam do escalar.\n");
+        return 1;
+    }
+
+    printf("Pistas de %zu bytes com %zu de prefixo comum (milhões/s)\n", strlen(textos[0]), strlen(textos[0]) - 9);
+    printf("  comparação: strcmp libc %8.1f | byte a byte %8.1f", medirComparacoes(strcmp, textos, vezes),
+           medirComparacoes(compararBytes, textos, vezes));
+    printf("\n  hash:       FNV-1a     %8.1f", medirHashes(hashFnv, textos, vezes));
+    for (int nivel = SIMD_ESCALAR; nivel <= (int)melhor; nivel++) {
+        escolherSimd((NivelSimd)nivel);
+        printf(" | %-7s %8.1f", nomesSimd[nivel], medirHashes(funcaoHash, textos, vezes));
+    }
+    printf("\n\n");
+
+    // Caminhos do jogo com n pistas longas (a tabela serve a todos os níveis:
+    // o hash não muda)
+    char pista[100];
+    TabelaHash tabela;
+    int* ids = realocarOuSair(NULL, n * sizeof(int));
+    iniciarHash(&tabela);
+    reservarHash(&tabela, n);
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaLonga(pista, i);
+        inserirNaHash(&tabela, pista, (i & 1) ? "Mordomo" : "Governanta");
+        ids[i] = buscarSimbolo(pista);
+    }
+    for (size_t i = n - 1; i > 0; i--) { // Ordem de coleta embaralhada
+        size_t j = aleatorio(&semente) % (i + 1);
+        int temp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = temp;
+    }
+
+    printf("%10s %-8s | %14s | %18s\n", "pistas", "nível", "inserirPista ns", "encontrarSuspeito ns");
+    for (int nivel = SIMD_ESCALAR; nivel <= (int)melhor; nivel++) {
+        escolherSimd((NivelSimd)nivel);
+        PistaNode* raiz = NULL;
+        double inicio = agoraSegundos();
+        for (size_t i = 0; i < n; i++) raiz = inserirPista(raiz, ids[i]);
+        double insercao = (agoraSegundos() - inicio) * 1e9 / n;
+
+        size_t achadas = 0;
+        inicio = agoraSegundos();
+        for (size_t i = 0; i < n; i++) {
+            achadas += (encontrarSuspeito(&tabela, (char*)textoSimbolo(ids[i])) != NULL);
+        }
+        double consulta = (agoraSegundos() - inicio) * 1e9 / n;
+        sumidouroBenchmark = achadas + (size_t)raiz->altura;
+        printf("%10zu %-8s | %14.1f | %18.1f\n", n, nomesSimd[nivel], insercao, consulta);
+        arenaResetar(&arenaCaso);
+    }
+
+    escolherSimd(melhor);
+    liberarHash(&tabela);
+    free(ids);
+    free(textos);
+    liberarSimbolos();
+    return 0;
+}
+
+// --- Gabarito gerado versus tabela dinâmica ---
+
+static const char* consultasGabarito[] = {
+    "Pegadas de lama no chão", "Relógio parado às 10h", "Livro de venenos aberto",
+    "Terra revirada recente", "Taça de vinho quebrada", "Chave enferrujada antiga",
+    "Cozinha", "Pista que não existe no caso"}; // As duas últimas não estão no gabarito
+#define CONSULTAS_GABARITO (sizeof(consultasGabarito) / sizeof(consultasGabarito[0]))
+
+// ns por montagem e alocações por montagem da tabela do gabarito padrão.
+static void medirMontagemGabarito(int fixo, double* ns, double* alocacoes) {
+    size_t vezes = 200000, alocadas = 0;
+    double total = 0;
+    for (size_t r = 0; r < vezes; r++) {
+        TabelaHash tabela;
+        for (size_t i = 0; i < CONSULTAS_GABARITO; i++) internar(consultasGabarito[i]); // Como criarSala
+        size_t antes = atomic_load(&alocacoesSistema);
+        double inicio = agoraSegundos();
+        if (!fixo || !usarGabaritoFixo(&tabela, &gabaritoPadrao)) montarGabaritoDinamico(&tabela);
+        total += agoraSegundos() - inicio;
+        alocadas += atomic_load(&alocacoesSistema) - antes;
+        liberarHash(&tabela);
+        liberarSimbolos();
+    }
+    *ns = total * 1e9 / vezes;
+    *alocacoes = (double)alocadas / vezes;
+}
+
+// ns por consulta, por texto (encontrarSuspeito) ou por id (encontrarSuspeitoId).
+static double medirConsultasGabarito(TabelaHash* tabela, int porId) {
+    int ids[CONSULTAS_GABARITO];
+    size_t vezes = 20000000, achadas = 0;
+    for (size_t i = 0; i < CONSULTAS_GABARITO; i++) ids[i] = internar(consultasGabarito[i]);
+    double inicio = agoraSegundos();
+    for (size_t r = 0; r < vezes; r++) {
+        size_t i = r % CONSULTAS_GABARITO;
+        if (porId) achadas += (encontrarSuspeitoId(tabela, ids[i]) != SEM_SIMBOLO);
+        else achadas += (encontrarSuspeito(tabela, (char*)consultasGabarito[i]) != NULL);
+    }
+    sumidouroBenchmark = achadas;
+    return (agoraSegundos() - inicio) * 1e9 / vezes;
+}
+
+/*
+ * benchmarkGabarito() – montagem e consultas do gabarito padrão com a tabela
+ * gerada (embutida) e com a tabela dinâmica inserida par a par.
+ */
+static int benchmarkGabarito(void) {
+    double nsFixo, alocFixo, nsDinamico, alocDinamico;
+    TabelaHash fixa, dinamica;
+
+    for (size_t i = 0; i < CONSULTAS_GABARITO; i++) internar(consultasGabarito[i]);
+    if (!usarGabaritoFixo(&fixa, &gabaritoPadrao) || !gabaritoFixoConfere(&fixa)) {
+        printf("Erro: a tabela gerada não confere com o gabarito; rode --gerar-gabarito.\n");
+        return 1;
+    }
+    montarGabaritoDinamico(&dinamica);
+    for (size_t i = 0; i < CONSULTAS_GABARITO; i++) {
+        const char* a = encontrarSuspeito(&fixa, (char*)consultasGabarito[i]);
+        const char* b = encontrarSuspeito(&dinamica, (char*)consultasGabarito[i]);
+        if ((a == NULL) != (b == NULL) || (a != NULL && strcmp(a, b) != 0)) {
+            printf("Erro: as tabelas discordam em '%s'.\n", consultasGabarito[i]);
+            return 1;
+        }
+    }
+
+    printf("%-10s | %12s %10s | %14s %12s\n", "tabela", "montagem ns", "alocações", "por texto ns", "por id ns");
+    double textoFixo = medirConsultasGabarito(&fixa, 0), idFixo = medirConsultasGabarito(&fixa, 1);
+    double textoDinamico = medirConsultasGabarito(&dinamica, 0), idDinamico = medirConsultasGabarito(&dinamica, 1);
+    liberarHash(&fixa);
+    liberarHash(&dinamica);
+    liberarSimbolos();
+
+    medirMontagemGabarito(1, &nsFixo, &alocFixo);
+    medirMontagemGabarito(0, &nsDinamico, &alocDinamico);
+    printf("%-10s | %12.1f %10.1f | %14.1f %12.1f\n", "gerada", nsFixo, alocFixo, textoFixo, idFixo);
+    printf("%-10s | %12.1f %10.1f | %14.1f %12.1f\n", "inserida", nsDinamico, alocDinamico, textoDinamico, idDinamico);
+    return 0;
+}
+
+// --- Saída: printf por linha versus renderizador ---
+
+// exibirPistas original: um fprintf por pista.
+static void exibirPistasPrintf(FILE* destino, PistaNode* raiz) {
+    if (raiz != NULL) {
+        exibirPistasPrintf(destino, raiz->esquerda);
+        fprintf(destino, "- %s\n", textoSimbolo(raiz->conteudo));
+        exibirPistasPrintf(destino, raiz->direita);
+    }
+}
+
+/*
+ * benchmarkSaida() – listagem de n pistas com a saída padrão apontando para
+ * 'caminho': fprintf com buffer de linha (como num terminal), fprintf com o
+ * buffer do stdio e o renderizador. Escritas do stdio são estimadas.
+ */
+static void benchmarkSaida(size_t n, const char* caminho, const char* rotulo) {
+    char texto[100];
+    PistaNode* raiz = NULL;
+    for (size_t i = 0; i < n; i++) {
+        gerarPistaSintetica(texto, i);
+        raiz = inserirPista(raiz, internar(texto));
+    }
+    size_t bytes = n * (strlen(texto) + 3);
+
+    fflush(stdout);
+    int salvo = dup(STDOUT_FILENO);
+    for (int modo = 0; modo < 3; modo++) {
+        int destino = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (destino < 0) {
+            printf("Erro: não foi possível abrir '%s'.\n", caminho);
+            break;
+        }
+        dup2(destino, STDOUT_FILENO);
+        close(destino);
+
+        size_t escritas = 0;
+        double inicio = agoraSegundos();
+        if (modo < 2) {
+            FILE* arquivo = fdopen(dup(STDOUT_FILENO), "w");
+            if (modo == 0) setvbuf(arquivo, NULL, _IOLBF, BUFSIZ);
+            exibirPistasPrintf(arquivo, raiz);
+            fclose(arquivo);
+            escritas = (modo == 0) ? n : (bytes + BUFSIZ - 1) / BUFSIZ;
+        } else {
+            size_t antes = saida.descargas;
+            exibirPistas(raiz);
+            descarregarSaida();
+            escritas = saida.descargas - antes;
+        }
+        double decorrido = agoraSegundos() - inicio;
+
+        dup2(salvo, STDOUT_FILENO);
+        const char* nomes[] = { "printf (linha)", "printf (stdio)", "renderizador" };
+        printf("%10zu %-10s %-15s | %8.1f %10.1f | %s%zu\n", n, rotulo, nomes[modo],
+               decorrido * 1e9 / n, bytes / decorrido / 1e6, (modo < 2) ? "~" : "", escritas);
+        fflush(stdout); // Antes de redirecionar de novo
+    }
+    close(salvo);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+// --- Percursos sem recursão versus os recursivos originais ---
+
+static void exibirPistasRecursivo(PistaNode* raiz) {
+    if (raiz != NULL) {
+        exibirPistasRecursivo(raiz->esquerda);
+        escreverTexto("- ");
+        escreverTexto(textoSimbolo(raiz->conteudo));
+        escreverTexto("\n");
+        exibirPistasRecursivo(raiz->direita);
+    }
+}
+
+static int contarPistasSuspeitoRecursivo(PistaNode* raiz, TabelaHash* tabela, int suspeitoAlvo) {
+    if (raiz == NULL) return 0;
+    return (encontrarSuspeitoId(tabela, raiz->conteudo) == suspeitoAlvo) +
+           contarPistasSuspeitoRecursivo(raiz->esquerda, tabela, suspeitoAlvo) +
+           contarPistasSuspeitoRecursivo(raiz->direita, tabela, suspeitoAlvo);
+}
+
+#define PISTAS_DISTINTAS_PILHA 1024
+
+/*
+ * medirPercursoPilha() – ns/nó de uma versão (0 = exibir, 1 = contar) sobre
+ * a árvore. A listagem vai para /dev/null pelo renderizador.
+ */
+static double medirPercursoPilha(PistaNode* raiz, size_t n, TabelaHash* tabela,
+                                 int suspeito, int operacao, int recursiva) {
+    int salvo = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (nulo >= 0) {
+        fflush(stdout);
+        dup2(nulo, STDOUT_FILENO);
+        close(nulo);
+    }
+
+    double inicio = agoraSegundos();
+    if (operacao == 0) {
+        if (recursiva) exibirPistasRecursivo(raiz);
+        else exibirPistas(raiz);
+        descarregarSaida();
+    } else {
+        sumidouroBenchmark = recursiva ? (size_t)contarPistasSuspeitoRecursivo(raiz, tabela, suspeito)
+                                       : (size_t)contarPistasSuspeitoId(raiz, tabela, suspeito);
+    }
+    double decorrido = agoraSegundos() - inicio;
+
+    dup2(salvo, STDOUT_FILENO);
+    close(salvo);
+    return decorrido * 1e9 / n;
+}
+
+/*
+ * benchmarkPilha() – árvore degenerada de n nós (uma lista pela esquerda,
+ * o pior caso para a recursão). A versão recursiva roda num processo filho:
+ * se a pilha estourar, só o filho morre e o sinal é mostrado.
+ */
+static void benchmarkPilha(size_t n) {
+    TabelaHash tabela;
+    char texto[100], suspeito[32];
+    iniciarHash(&tabela);
+    for (size_t i = 0; i < PISTAS_DISTINTAS_PILHA; i++) {
+        gerarPistaSintetica(texto, i);
+        sprintf(suspeito, "Suspeito %zu", i % 3);
+        inserirNaHash(&tabela, texto, suspeito);
+    }
+    int alvo = buscarSimbolo("Suspeito 0");
+
+    // Lista pela esquerda: o nó i é filho esquerdo do nó i - 1
+    PistaNode* raiz = NULL;
+    for (size_t i = 0; i < n; i++) {
+        PistaNode* no = poolAlocar(&arenaCaso.pistas);
+        gerarPistaSintetica(texto, i % PISTAS_DISTINTAS_PILHA);
+        no->conteudo = buscarSimbolo(texto);
+        no->altura = 1;
+        no->esquerda = raiz;
+        no->direita = NULL;
+        raiz = no;
+    }
+
+    const char* nomes[] = { "exibirPistas", "contarPistasSuspeito" };
+    for (int operacao = 0; operacao < 2; operacao++) {
+        double iterativa = medirPercursoPilha(raiz, n, &tabela, alvo, operacao, 0);
+        printf("%10zu %-21s | %10.1f | ", n, nomes[operacao], iterativa);
+        fflush(stdout);
+
+        int canal[2];
+        double recursiva = -1;
+        int status = 0;
+        if (pipe(canal) == 0) {
+            pid_t filho = fork();
+            if (filho == 0) {
+                close(canal[0]);
+                recursiva = medirPercursoPilha(raiz, n, &tabela, alvo, operacao, 1);
+                if (write(canal[1], &recursiva, sizeof recursiva) != sizeof recursiva) _exit(1);
+                _exit(0);
+            }
+            close(canal[1]);
+            if (filho > 0) {
+                if (read(canal[0], &recursiva, sizeof recursiva) != sizeof recursiva) recursiva = -1;
+                waitpid(filho, &status, 0);
+            }
+            close(canal[0]);
+        }
+        if (recursiva >= 0) printf("%10.1f\n", recursiva);
+        else if (WIFSIGNALED(status)) printf("estouro de pilha (sinal %d)\n", WTERMSIG(status));
+        else printf("%10s\n", "falhou");
+    }
+
+    // O percurso de Morris devolve a árvore intacta
+    size_t nos = 0;
+    for (PistaNode* no = raiz; no != NULL; no = no->esquerda) {
+        if (no->direita != NULL) printf("  [!] Fio de Morris esquecido na árvore\n");
+        nos++;
+    }
+    if (nos != n) printf("  [!] Árvore alterada: %zu de %zu nós\n", nos, n);
+
+    liberarHash(&tabela);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+// --- Teste de carga do jogo (casos gerados) ---
+
+#define SESSOES_CARGA 10000
+
+/*
+ * medirJogo() – passa um caso pelo caminho do jogo: carga, montagem do mapa
+ * (grafo e perito), uma varredura que coleta todas as pistas e 'sessoes'
+ * explorações da entrada até um cômodo sem saída, por caminhos sorteados.
+ * Cada exploração tem inventário novo (AVL, placar e mapa de bits) e termina
+ * no veredito: pontos, ranking e acusação do primeiro pelo nome.
+ */
+static int medirJogo(const char* arquivo, size_t sessoes, uint64_t semente) {
+    Caso caso;
+    double inicio = agoraSegundos();
+    if (!carregarCaso(&caso, arquivo)) {
+        liberarSimbolos();
+        liberarCaso(&caso);
+        return 0;
+    }
+    double carga = agoraSegundos() - inicio;
+
+    MapaSalas mapa;
+    Perito peritoCarga;
+    IndicePistas indice;
+    inicio = agoraSegundos();
+    construirMapa(&mapa, &caso);
+    construirIndice(&indice, &caso);
+    prepararPerito(&peritoCarga, &caso, &indice);
+    double montagem = agoraSegundos() - inicio;
+
+    TabelaHash* tabela = &caso.tabela;
+    size_t k = tabela->quantidadeSuspeitos;
+    IndiceNomes nomes;
+    construirIndiceNomes(&nomes, tabela);
+    Sala** pilha = realocarOuSair(NULL, (caso.quantidadeSalas + 1) * sizeof(Sala*));
+    int64_t limiar = limiarDoCaso(&caso);
+    uint64_t salas = 0, pistas = 0, condenaveis = 0;
+    double varredura = 0, exploracao = 0, veredito = 0;
+
+    for (size_t s = 0; s <= sessoes; s++) { // s = 0: a varredura
+        Inventario inventario;
+        iniciarInventario(&inventario, &indice);
+        double antes = agoraSegundos();
+        if (s == 0) {
+            size_t topo = 0;
+            pilha[topo++] = caso.mansao;
+            while (topo > 0) {
+                Sala* sala = pilha[--topo];
+                if (sala->pista != SEM_SIMBOLO) coletarPista(&inventario, sala->pista);
+                if (sala->direita != NULL) pilha[topo++] = sala->direita;
+                if (sala->esquerda != NULL) pilha[topo++] = sala->esquerda;
+            }
+        } else {
+            for (Sala* sala = caso.mansao; sala != NULL;) {
+                salas++;
+                if (sala->pista != SEM_SIMBOLO) pistas += (uint64_t)coletarPista(&inventario, sala->pista);
+                if (sala->esquerda != NULL && sala->direita != NULL) {
+                    sala = (aleatorio(&semente) & 1) ? sala->direita : sala->esquerda;
+                } else {
+                    sala = (sala->esquerda != NULL) ? sala->esquerda : sala->direita;
+                }
+            }
+        }
+        double explorada = agoraSegundos();
+
+        int ordem[RANKING_EXIBIDO];
+        const int64_t* pontos = inventario.placar;
+        if (melhoresSuspeitos(pontos, k, RANKING_EXIBIDO, ordem) > 0) {
+            size_t primeiro, quantidade;
+            int acusado = resolverSuspeito(&nomes, tabela, textoSimbolo(tabela->suspeitos[ordem[0]]),
+                                           &primeiro, &quantidade);
+            condenaveis += (s > 0 && acusado >= 0 && pontos[acusado] >= limiar);
+        }
+        double fim = agoraSegundos();
+
+        if (s == 0) {
+            varredura = fim - antes;
+        } else {
+            exploracao += explorada - antes;
+            veredito += fim - explorada;
+        }
+        liberarInventario(&inventario);
+        poolResetar(&arenaCaso.pistas);
+    }
+
+    printf("%10zu %9zu | %8.1f %8.1f %9.1f | %9.0f %10.0f %10.0f %8.2f %6.1f%% |", caso.quantidadeSalas,
+           tabela->quantidade, carga * 1e3, montagem * 1e3, varredura * 1e3,
+           sessoes / (exploracao + veredito), salas / exploracao, pistas / exploracao,
+           veredito * 1e6 / sessoes, 100.0 * condenaveis / sessoes);
+
+    free(pilha);
+    liberarIndice(&indice);
+    liberarIndiceNomes(&nomes);
+    liberarPerito(&peritoCarga);
+    liberarMapaSalas(&mapa);
+    liberarSimbolos();
+    liberarCaso(&caso);
+    arenaResetar(&arenaCaso);
+    return 1;
+}
+
+/*
+ * benchmarkJogo() – teste de carga: casos gerados com 1000, 10000, ... até
+ * 'maximo' salas (os demais parâmetros vêm de 'parametros'), cada um medido
+ * num processo filho para que o pico de memória (wait4) seja só dele.
+ */
+static int benchmarkJogo(size_t maximo, size_t sessoes, ParametrosCaso* parametros) {
+    const char* pastaTemp = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char arquivo[512];
+    struct rusage uso;
+    int ok = 1;
+
+    snprintf(arquivo, sizeof(arquivo), "%s/dq_jogo_%d.txt", pastaTemp, (int)getpid());
+    printf("Teste de carga: forma %s, inclinacao %u%%, densidade %u%%, %zu suspeitos, colisao %u bits,\n"
+           "implica %u%%, %zu portas; %zu sessões por caso, numa thread.\n",
+           parametros->aleatoria ? "aleatoria" : "completa", parametros->inclinacao, parametros->densidade,
+           parametros->suspeitos, parametros->colisao, parametros->implicacoes, parametros->portas, sessoes);
+    printf("     salas    pistas | carga ms  mapa ms varred ms | sessões/s    salas/s   pistas/s vered µs  cond. |"
+           "   pico KiB\n");
+
+    for (size_t n = (maximo < 1000) ? maximo : 1000;; n = (n * 10 < maximo) ? n * 10 : maximo) {
+        parametros->salas = n;
+        if (!gerarCaso(arquivo, parametros)) return 1;
+        fflush(stdout);
+
+        int status = 0;
+        pid_t filho = fork();
+        if (filho == 0) {
+            int medido = medirJogo(arquivo, sessoes, parametros->semente);
+            fflush(stdout);
+            _exit(medido ? 0 : 1);
+        }
+        if (filho > 0 && wait4(filho, &status, 0, &uso) == filho) {
+            ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (ok) printf(" %10ld\n", uso.ru_maxrss);
+        } else {
+            // Sem processo filho: mede aqui mesmo (pico do processo inteiro)
+            ok = medirJogo(arquivo, sessoes, parametros->semente);
+            getrusage(RUSAGE_SELF, &uso);
+            if (ok) printf(" %9ld*\n", uso.ru_maxrss);
+        }
+        remove(arquivo);
+        if (!ok || n == maximo) break;
+    }
+    return ok ? 0 : 1;
+}
+
+// --- Suíte de microbenchmarks (uma operação por processo) ---
+
+enum { DIST_ORDENADA, DIST_ALEATORIA, DIST_COLISAO, TOTAL_DISTRIBUICOES };
+static const char* nomesDistribuicao[] = { "ordenada", "aleatoria", "colisao" };
+
+enum { OP_CRIAR_SALA, OP_INSERIR_PISTA, OP_INSERIR_HASH, OP_ENCONTRAR_SUSPEITO,
+       OP_CONTAR_PISTAS, OP_EXIBIR_PISTAS, TOTAL_OPERACOES };
+static const char* nomesOperacao[] = { "criarSala", "inserirPista", "inserirNaHash",
+                                       "encontrarSuspeito", "contarPistasSuspeito", "exibirPistas" };
+
+#define SUSPEITOS_SUITE 8
+#define BITS_COLISAO 8  // Pistas "colisão" têm os mesmos 8 bits baixos de hash
+
+/*
+ * gerarCargaSuite() – n pistas distintas na ordem da distribuição:
+ * ordenada (crescente), aleatória (permutação) ou colisão (todas caem nas
+ * mesmas posições-base do índice da tabela de símbolos, formando longas
+ * sequências de sondagem).
+ */
+static char (*gerarCargaSuite(size_t n, int distribuicao))[100] {
+    char (*textos)[100] = realocarOuSair(NULL, (n + 1) * sizeof *textos);
+    uint64_t semente = 88172645463325252ULL;
+
+    if (distribuicao == DIST_COLISAO) {
+        uint64_t alvo = funcaoHash("Pista 000000000 encontrada no comodo") & ((1u << BITS_COLISAO) - 1);
+        size_t candidato = 0;
+        for (size_t i = 0; i < n; candidato++) {
+            gerarPistaSintetica(textos[i], candidato);
+            if ((funcaoHash(textos[i]) & ((1u << BITS_COLISAO) - 1)) == alvo) i++;
+        }
+        return textos;
+    }
+
+    for (size_t i = 0; i < n; i++) gerarPistaSintetica(textos[i], i);
+    if (distribuicao == DIST_ALEATORIA) {
+        char temp[100];
+        for (size_t i = n; i > 1; i--) { // Fisher-Yates
+            size_t j = aleatorio(&semente) % i;
+            memcpy(temp, textos[i - 1], sizeof temp);
+            memcpy(textos[i - 1], textos[j], sizeof temp);
+            memcpy(textos[j], temp, sizeof temp);
+        }
+    }
+    return textos;
+}
+
+// Gabarito da suíte: pista i -> "Suspeito (i % SUSPEITOS_SUITE)".
+static void montarTabelaSuite(TabelaHash* tabela, char (*textos)[100], size_t n) {
+    char suspeito[32];
+    iniciarHash(tabela);
+    for (size_t i = 0; i < n; i++) {
+        sprintf(suspeito, "Suspeito %zu", i % SUSPEITOS_SUITE);
+        inserirNaHash(tabela, textos[i], suspeito);
+    }
+}
+
+/*
+ * medirOperacaoSuite() – prepara o que a operação precisa (fora da medição),
+ * mede só a operação e imprime ops, ns/op e alocações/op.
+ */
+static void medirOperacaoSuite(int operacao, size_t n, char (*textos)[100]) {
+    TabelaHash tabela;
+    PistaNode* raiz = NULL;
+    int* ids = NULL;
+    size_t operacoes = n;
+    double inicio = 0, decorrido = 0;
+    size_t alocacoesAntes = 0;
+    char suspeitos[SUSPEITOS_SUITE][32];
+
+    for (int k = 0; k < SUSPEITOS_SUITE; k++) sprintf(suspeitos[k], "Suspeito %d", k);
+    iniciarHash(&tabela);
+
+    // Preparação
+    if (operacao != OP_CRIAR_SALA && operacao != OP_INSERIR_HASH) {
+        ids = realocarOuSair(NULL, (n + 1) * sizeof(int));
+        reservarSimbolos(n + SUSPEITOS_SUITE);
+        for (size_t i = 0; i < n; i++) ids[i] = internar(textos[i]);
+    }
+    if (operacao == OP_ENCONTRAR_SUSPEITO || operacao == OP_CONTAR_PISTAS) {
+        liberarHash(&tabela);
+        montarTabelaSuite(&tabela, textos, n);
+    }
+    if (operacao == OP_CONTAR_PISTAS || operacao == OP_EXIBIR_PISTAS) {
+        for (size_t i = 0; i < n; i++) raiz = inserirPista(raiz, ids[i]);
+    }
+    if (operacao == OP_ENCONTRAR_SUSPEITO) { // Consultas em ordem embaralhada
+        uint64_t semente = 2463534242ULL;
+        for (size_t i = n; i > 1; i--) {
+            size_t j = aleatorio(&semente) % i;
+            int temp = ids[i - 1];
+            ids[i - 1] = ids[j];
+            ids[j] = temp;
+        }
+    }
+
+    alocacoesAntes = atomic_load(&alocacoesSistema);
+    inicio = agoraSegundos();
+    switch (operacao) {
+        case OP_CRIAR_SALA:
+            // Nome e pista distintos por sala (nomes: a carga de trás para frente)
+            for (size_t i = 0; i < n; i++) {
+                sumidouroBenchmark += (size_t)criarSala(textos[n - 1 - i], textos[i])->pista;
+            }
+            break;
+        case OP_INSERIR_PISTA:
+            for (size_t i = 0; i < n; i++) raiz = inserirPista(raiz, ids[i]);
+            break;
+        case OP_INSERIR_HASH:
+            for (size_t i = 0; i < n; i++) {
+                inserirNaHash(&tabela, textos[i], suspeitos[i % SUSPEITOS_SUITE]);
+            }
+            break;
+        case OP_ENCONTRAR_SUSPEITO:
+            for (size_t i = 0; i < n; i++) {
+                sumidouroBenchmark += (size_t)encontrarSuspeito(&tabela, (char*)textoSimbolo(ids[i]));
+            }
+            break;
+        case OP_CONTAR_PISTAS:
+            // Percorre a árvore inteira a cada chamada: repete por ~0,2 s
+            operacoes = 0;
+            while (operacoes < SUSPEITOS_SUITE || agoraSegundos() - inicio < 0.2) {
+                sumidouroBenchmark += (size_t)contarPistasSuspeito(raiz, &tabela,
+                                                                   suspeitos[operacoes % SUSPEITOS_SUITE]);
+                operacoes++;
+            }
+            break;
+        case OP_EXIBIR_PISTAS: {
+            // A saída vai para /dev/null durante a medição
+            fflush(stdout);
+            int salvo = dup(STDOUT_FILENO);
+            int nulo = open("/dev/null", O_WRONLY);
+            if (nulo >= 0) {
+                dup2(nulo, STDOUT_FILENO);
+                close(nulo);
+            }
+            inicio = agoraSegundos();
+            exibirPistas(raiz);
+            fflush(stdout);
+            decorrido = agoraSegundos() - inicio;
+            dup2(salvo, STDOUT_FILENO);
+            close(salvo);
+            operacoes = 1;
+            break;
+        }
+    }
+    if (operacao != OP_EXIBIR_PISTAS) decorrido = agoraSegundos() - inicio;
+    size_t alocacoes = atomic_load(&alocacoesSistema) - alocacoesAntes;
+
+    printf("%-21s %10zu | %13.1f %9.4f |", nomesOperacao[operacao], operacoes,
+           decorrido * 1e9 / operacoes, (double)alocacoes / operacoes);
+
+    free(ids);
+    liberarHash(&tabela);
+    arenaResetar(&arenaCaso);
+    liberarSimbolos();
+}
+
+/*
+ * benchmarkSuite() – mede cada operação num processo filho, para que o pico
+ * de memória (ru_maxrss devolvido por wait4) seja só daquela operação.
+ */
+static void benchmarkSuite(size_t n, int distribuicao) {
+    char (*textos)[100] = gerarCargaSuite(n, distribuicao);
+    struct rusage uso;
+
+    getrusage(RUSAGE_SELF, &uso);
+    printf("\n[%s, n = %zu; base com a carga gerada: %ld KiB]\n",
+           nomesDistribuicao[distribuicao], n, uso.ru_maxrss);
+    for (int operacao = 0; operacao < TOTAL_OPERACOES; operacao++) {
+        fflush(stdout);
+        pid_t filho = fork();
+        if (filho == 0) {
+            medirOperacaoSuite(operacao, n, textos);
+            fflush(stdout);
+            _exit(0);
+        }
+
+        if (filho > 0 && wait4(filho, NULL, 0, &uso) == filho) {
+            printf(" %10ld\n", uso.ru_maxrss);
+        } else {
+            // Sem processo filho: mede aqui mesmo (pico do processo inteiro)
+            medirOperacaoSuite(operacao, n, textos);
+            getrusage(RUSAGE_SELF, &uso);
+            printf(" %9ld*\n", uso.ru_maxrss);
+        }
+    }
+    free(textos);
+}
+
+/*
+ * executarBenchmark() – ponto de entrada de "<alvo> [n...]".
+ */
+int executarBenchmark(int argc, char* argv[]) {
+    if (argc < 1) {
+        printf("Uso: Ultimo_Caso_Benchmarks <alvo> [n...]\nAlvos: suite, hash, avl, veredito, carga, layout, saida, pilha, perito, sessao, diario, simd,\n       gabarito, bitset, ponderado, nomes, mapa, jogo, concorrente\n");
+        return 1;
+    }
+
+    if (strcmp(argv[0], "jogo") == 0) {
+        // jogo [salas] [sessoes] [chave=valor...] (parâmetros do gerador)
+        size_t numeros[2] = {100000, SESSOES_CARGA};
+        int i = 1;
+        for (int lidos = 0; i < argc && lidos < 2 && strchr(argv[i], '=') == NULL; i++, lidos++) {
+            numeros[lidos] = (size_t)strtoull(argv[i], NULL, 10);
+        }
+        ParametrosCaso parametros;
+        parametrosPadrao(&parametros);
+        if (!lerParametrosCaso(&parametros, argc - i, argv + i)) return 1;
+        if (numeros[0] == 0 || numeros[0] > MAX_SALAS_COMPACTAS) numeros[0] = 100000;
+        if (numeros[1] == 0) numeros[1] = 1;
+        int status = benchmarkJogo(numeros[0], numeros[1], &parametros);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "suite") == 0) {
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 100000;
+        int escolhida = -1;
+        for (int d = 0; argc >= 3 && d < TOTAL_DISTRIBUICOES; d++) {
+            if (strcmp(argv[2], nomesDistribuicao[d]) == 0) escolhida = d;
+        }
+        if (argc >= 3 && escolhida < 0) {
+            printf("Distribuição desconhecida: %s (ordenada, aleatoria, colisao)\n", argv[2]);
+            return 1;
+        }
+        if (n == 0) n = 1;
+
+        printf("Suíte de microbenchmarks: tempo, pedidos de memória ao sistema e\n");
+        printf("pico de memória residente (KiB) de cada operação, medida isolada.\n");
+        printf("operação              %10s | %13s %9s | %10s\n", "ops", "ns/op", "aloc/op", "pico RSS");
+        for (int d = 0; d < TOTAL_DISTRIBUICOES; d++) {
+            if (escolhida < 0 || escolhida == d) benchmarkSuite(n, d);
+        }
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "hash") == 0) {
+        printf("Consultas em encontrarSuspeito (ns/op)\n");
+        printf("%10s | %12s %12s %10s | %12s %14s | %9s\n", "n",
+               "ins. aberta", "cons. aberta", "cons. id", "ins. encad.", "cons. encad.", "ganho");
+        if (argc == 1) {
+            benchmarkHash(1000);
+            benchmarkHash(100000);
+        }
+        for (int i = 1; i < argc; i++) {
+            benchmarkHash((size_t)strtoull(argv[i], NULL, 10));
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[0], "avl") == 0) {
+        printf("Árvore de pistas: inserção e travessia em-ordem (ns/pista)\n");
+        printf("%10s %-10s %-6s | %14s %14s | %6s\n", "n", "entrada", "árvore",
+               "inserção", "travessia", "altura");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 20000;
+        benchmarkAvl(n, 1);
+        benchmarkAvl(n, 0);
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "veredito") == 0) {
+        printf("Custo de uma acusação (ns/op) e do ranking completo (ns)\n");
+        printf("%10s %8s | %14s %10s | %12s\n", "pistas", "suspeitos",
+               "recontagem", "placar", "ranking");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 100000;
+        benchmarkVeredito(1000, 3);
+        benchmarkVeredito(n, 3);
+        benchmarkVeredito(n, 1000);
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "bitset") == 0) {
+        printf("Acusação com metade das pistas coletadas (ns/op) e memória do inventário (KiB)\n");
+        printf("%9s %6s | %12s %9s %7s | %9s %9s | %8s %8s\n", "pistas", "susp.", "recontagem",
+               "popcount", "placar", "faltando", "em comum", "BST", "bits");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 100000;
+        int status = benchmarkBitset(64, 3) | benchmarkBitset(1000, 3) | benchmarkBitset(n, 3) |
+                     benchmarkBitset(n, 100);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "ponderado") == 0) {
+        printf("Pontos ponderados de todos os suspeitos (metade das pistas coletada), em µs por operação\n");
+        printf("%8s %7s %8s | %7s | %10s %8s %10s | %11s %11s\n", "pistas", "susp.", "entradas",
+               "índ. ms", "coletar", "top-10", "qsort", "rec./susp.", "rec. ms");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 100000;
+        int status = benchmarkPonderado(n, 3) | benchmarkPonderado(n, 1000) | benchmarkPonderado(n, 20000) |
+                     benchmarkPonderado(n, 50000);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "nomes") == 0) {
+        printf("Acusação pelo nome num elenco de k suspeitos (ns por consulta)\n");
+        printf("%9s | %9s | %9s %9s %9s | %10s %8s | %12s\n", "suspeitos", "índ. ms", "exato", "sem caixa",
+               "começo", "sugestões", "achados", "sem índice");
+        size_t k = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkNomes(100) | benchmarkNomes(10000) | benchmarkNomes(k);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "mapa") == 0) {
+        printf("Mapa em grafo: montagem (ms) e menor rota entre salas sorteadas (µs por rota)\n");
+        printf("%10s %9s | %9s %9s | %7s | %10s %10s\n", "salas", "portas", "CSR ms", "listas ms", "passos",
+               "CSR", "listas");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkMapa(n / 100 ? n / 100 : 2) | benchmarkMapa(n);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "carga") == 0) {
+        printf("Partida do jogo: carregar o caso (texto versus .dqc mapeado)\n");
+        printf("%10s | %27s | %27s\n", "salas", "texto", "binário");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkCarga(n);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "layout") == 0) {
+        printf("Percursos na mansão (ns/sala): ponteiros versus layout compacto\n");
+        printf("%10s %-9s | %8s | %9s %9s %9s | %9s %9s\n", "salas", "forma", "conversão",
+               "ptr DFS", "comp DFS", "comp lin.", "ptr desc.", "comp desc.");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+        benchmarkLayout(n, 0);
+        benchmarkLayout(n, 1);
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "saida") == 0) {
+        printf("Listagem de pistas: ns/pista, MB/s e chamadas a write()\n");
+        printf("%10s %-10s %-16s | %8s %10s | %s\n", "pistas", "destino", "saída",
+               "ns/pista", "MB/s", "escritas");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        char temporario[] = "/tmp/dq_saida_XXXXXX";
+        int descritor = mkstemp(temporario);
+        benchmarkSaida(n, "/dev/null", "/dev/null");
+        if (descritor >= 0) {
+            close(descritor);
+            benchmarkSaida(n, temporario, "arquivo");
+            unlink(temporario);
+        }
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "perito") == 0) {
+        printf("Perito: preparo (uma passada) e consulta durante o jogo\n");
+        printf("%10s %-9s %9s | %10s %10s | %10s | %8s\n", "salas", "forma", "suspeitos",
+               "preparo ms", "ns/sala", "ns/consul.", "máx s0 ");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        benchmarkPerito(n, 3, 0);
+        benchmarkPerito(n, 3, 1);
+        benchmarkPerito(n, 16, 0);
+        benchmarkPerito(n * 4, 3, 0);
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    if (strcmp(argv[0], "sessao") == 0) {
+        printf("Sessão gravada (ms): gravar, continuar (mmap) e recoletar pista por pista\n");
+        printf("%10s %9s | %12s | %10s %10s | %10s\n", "pistas", "suspeitos", "arquivo",
+               "gravar", "continuar", "recoletar");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkSessao(n / 10 ? n / 10 : 1, 8) | benchmarkSessao(n, 8);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "diario") == 0) {
+        printf("Diário de movimentos: custo por passo no caminho de explorarSalas\n");
+        printf("    passos |   ns/passo  acréscimo | sincronias  política\n");
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkDiario(n ? n : 1);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "concorrente") == 0) {
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int maximo = (argc >= 3) ? atoi(argv[2]) : 8;
+        if (n == 0 || n >= INT32_MAX) n = 1000000;
+        if (maximo < 1) maximo = 1;
+        // O estresse é quem mais ocupa lugares: escritores, leitores e a conferência final
+        if (maximo > MAX_PARTICIPANTES - LEITORES_ESTRESSE - 1) maximo = MAX_PARTICIPANTES - LEITORES_ESTRESSE - 1;
+        printf("Tabela concorrente sem travas (%ld núcleo(s) disponível(is))\n", sysconf(_SC_NPROCESSORS_ONLN));
+        int status = estresseConcorrente(n / 4 ? n / 4 : 1, maximo < 4 ? 4 : maximo);
+        printf("Vazão (milhões de operações/s), %zu pistas a partir da tabela mínima:\n", n);
+        printf("threads | carga: sem trava  com mutex | busca: sem trava  pronta | liberados\n");
+        status |= benchmarkConcorrente(n, maximo);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "simd") == 0) {
+        printf("Textos vetorizados: hash (nível detectado: %s)\n", nomesSimd[detectarSimd()]);
+        size_t n = (argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 1000000;
+        int status = benchmarkSimd(n);
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "gabarito") == 0) {
+        printf("Gabarito da mansão padrão: %zu pares, 6 consultas que acham e 2 que não\n", PARES_GABARITO_ORIGINAL);
+        int status = benchmarkGabarito();
+        arenaDestruir(&arenaCaso);
+        return status;
+    }
+
+    if (strcmp(argv[0], "pilha") == 0) {
+        printf("Percursos numa árvore degenerada (ns/nó): Morris versus recursão\n");
+        printf("       nós operação              |  iterativo |  recursivo\n");
+        if (argc == 1) benchmarkPilha(100000);
+        benchmarkPilha((argc >= 2) ? (size_t)strtoull(argv[1], NULL, 10) : 10000000);
+        arenaDestruir(&arenaCaso);
+        return 0;
+    }
+
+    printf("Alvo de benchmark desconhecido: %s\n", argv[0]);
+    return 1;
+}
+
+// ============================================================================
+// CLIENTE DE TESTE DO SERVIDOR
+// ============================================================================
+
+// Resposta do servidor (um bloco, até a linha vazia).
+typedef struct BlocoResposta {
+    char* dados;
+    size_t usados, capacidade;
+} BlocoResposta;
+
+static int conectarServidor(const char* caminho) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    memcpy(endereco.sun_path, caminho, strlen(caminho) + 1);
+
+    int descritor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (descritor >= 0 && connect(descritor, (struct sockaddr*)&endereco, sizeof(endereco)) != 0) {
+        close(descritor);
+        descritor = -1;
+    }
+    return descritor;
+}
+
+// Lê até o fim do bloco ("\n\n"); 0 se a conexão fechar antes.
+static int lerBloco(int descritor, BlocoResposta* bloco) {
+    bloco->usados = 0;
+    for (;;) {
+        if (bloco->capacidade - bloco->usados < 512) {
+            bloco->capacidade = bloco->capacidade ? bloco->capacidade * 2 : 4096;
+            bloco->dados = realocarOuSair(bloco->dados, bloco->capacidade);
+        }
+        ssize_t lidos = read(descritor, bloco->dados + bloco->usados, bloco->capacidade - bloco->usados - 1);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos <= 0) return 0;
+        bloco->usados += (size_t)lidos;
+        bloco->dados[bloco->usados] = '\0';
+        if (bloco->usados >= 2 && memcmp(bloco->dados + bloco->usados - 2, "\n\n", 2) == 0) return 1;
+    }
+}
+
+// Envia uma linha e espera a resposta inteira; registra o tempo de ida e volta.
+static int comandoCliente(int descritor, const char* linha, BlocoResposta* bloco, HistogramaLatencia* latencia) {
+    size_t tamanho = strlen(linha);
+    double inicio = agoraSegundos();
+    if (send(descritor, linha, tamanho, MSG_NOSIGNAL) != (ssize_t)tamanho || !lerBloco(descritor, bloco)) return 0;
+    registrarLatencia(latencia, (uint64_t)((agoraSegundos() - inicio) * 1e9));
+    return 1;
+}
+
+// Valor do campo "nome<TAB>..." no bloco (começo da linha), ou NULL.
+static const char* campoDoBloco(const BlocoResposta* bloco, const char* nome) {
+    size_t tamanho = strlen(nome);
+    for (const char* linha = bloco->dados; *linha != '\0';) {
+        if (strncmp(linha, nome, tamanho) == 0 && linha[tamanho] == '\t') return linha + tamanho + 1;
+        const char* quebra = strchr(linha, '\n');
+        if (quebra == NULL) break;
+        linha = quebra + 1;
+    }
+    return NULL;
+}
+
+/*
+ * executarCliente() – "--cliente": abre 'ociosas' conexões que só
+ * recebem a sala de entrada e ficam paradas, e então joga 'sessoes' partidas
+ * completas, uma por vez, com movimentos sorteados entre as saídas (10% de
+ * chance de sair antes) e a acusação de um nome sorteado da lista. Mostra
+ * comandos por segundo e os percentis do tempo de ida e volta.
+ */
+int executarCliente(const char* caminho, size_t ociosas, size_t sessoes) {
+    BlocoResposta bloco = {0};
+    HistogramaLatencia* latencia = alocarZeradoOuSair(2, sizeof(HistogramaLatencia)); // [0] comandos, [1] conexão
+    int* paradas = realocarOuSair(NULL, (ociosas + 1) * sizeof(int));
+    uint64_t semente = 2463534242ULL;
+    size_t abertas = 0, jogadas = 0, culpados = 0, comandos = 0;
+    int ok = 1;
+
+    elevarLimiteDescritores();
+
+    double inicio = agoraSegundos();
+    while (abertas < ociosas) {
+        int descritor = conectarServidor(caminho);
+        if (descritor < 0 || !lerBloco(descritor, &bloco)) {
+            printf("Erro: conexão %zu recusada: %s\n", abertas + 1, strerror(errno));
+            if (descritor >= 0) close(descritor);
+            ok = 0;
+            break;
+        }
+        paradas[abertas++] = descritor;
+    }
+    if (ociosas > 0) {
+        printf("%zu sessão(ões) ociosa(s) abertas em %.2f s.\n", abertas, agoraSegundos() - inicio);
+    }
+
+    inicio = agoraSegundos();
+    while (ok && jogadas < sessoes) {
+        double antes = agoraSegundos();
+        int descritor = conectarServidor(caminho);
+        if (descritor < 0 || !lerBloco(descritor, &bloco)) {
+            printf("Erro: sessão %zu sem resposta do servidor.\n", jogadas + 1);
+            if (descritor >= 0) close(descritor);
+            ok = 0;
+            break;
+        }
+        registrarLatencia(&latencia[1], (uint64_t)((agoraSegundos() - antes) * 1e9));
+
+        const char* lista;
+        while (ok && (lista = campoDoBloco(&bloco, "acusar")) == NULL) {
+            const char* saidas = campoDoBloco(&bloco, "saidas");
+            char linha[4] = "s\n";
+            size_t opcoes = saidas ? strcspn(saidas, "\n") : 0;
+            if (opcoes > 0 && aleatorio(&semente) % 10 != 0) linha[0] = saidas[aleatorio(&semente) % opcoes];
+            ok = comandoCliente(descritor, linha, &bloco, &latencia[0]);
+            comandos++;
+        }
+        if (ok) {
+            // Um nome sorteado da lista (separada por tabulações)
+            size_t nomes = 1, escolhido, tamanho;
+            for (const char* c = lista; *c != '\n'; c++) nomes += (*c == '\t');
+            escolhido = aleatorio(&semente) % nomes;
+            while (escolhido-- > 0) lista = strchr(lista, '\t') + 1;
+            tamanho = strcspn(lista, "\t\n");
+            char linha[TAM_LINHA_SERVIDOR];
+            snprintf(linha, sizeof(linha), "%.*s\n", (int)(tamanho < sizeof(linha) - 2 ? tamanho : sizeof(linha) - 2),
+                     lista);
+            ok = comandoCliente(descritor, linha, &bloco, &latencia[0]);
+            comandos++;
+            const char* veredito = ok ? campoDoBloco(&bloco, "veredito") : NULL;
+            if (veredito == NULL) ok = 0;
+            else culpados += (strncmp(veredito, "CULPADO", 7) == 0);
+        }
+        close(descritor);
+        if (ok) jogadas++;
+    }
+    double decorrido = agoraSegundos() - inicio;
+
+    if (jogadas > 0) {
+        printf("%zu partida(s), %zu comando(s) em %.2f s (%.0f comandos/s); %zu culpado(s).\n", jogadas,
+               comandos, decorrido, comandos / decorrido, culpados);
+        mostrarLatencias("Ida e volta por comando", &latencia[0]);
+        mostrarLatencias("Conexão até a sala de entrada", &latencia[1]);
+    }
+    for (size_t i = 0; i < abertas; i++) close(paradas[i]);
+    free(paradas);
+    free(bloco.dados);
+    free(latencia);
+    return ok;
+}
+
+// ============================================================================
+// FUNÇÃO PRINCIPAL
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    arenaIniciar(&arenaCaso);
+    escolherSimd(detectarSimd());
+
+    if (argc >= 2 && strcmp(argv[1], "--cliente") == 0) {
+        if (argc < 3) {
+            printf("Uso: --cliente <socket> [ociosas] [sessoes]\n");
+            return 1;
+        }
+        size_t ociosas = (argc >= 4) ? strtoull(argv[3], NULL, 10) : 1000;
+        size_t sessoes = (argc >= 5) ? strtoull(argv[4], NULL, 10) : 10000;
+        return executarCliente(argv[2], ociosas, sessoes) ? 0 : 1;
+    }
+
+    int status = executarBenchmark(argc - 1, argv + 1);
+    arenaDestruir(&arenaCaso);
+    liberarSimbolos();
+    return status;
+}
@@ -138,13 +138,22 @@ void explorarSalas(Sala* atual) {
 
 /*
  * Função: liberarMapa
- * Objetivo: Percorre a árvore recursivamente liberando a memória alocada (Pós-ordem).
- * Parâmetros: raiz (Sala*) - O nó atual a ser liberado.
+ * Objetivo: Libera todas as salas sem recursão: enquanto a sala atual tiver
+ *           filho esquerdo, uma rotação à direita o traz para cima; sem ele,
+ *           a sala é liberada e o percurso segue pela direita.
+ * Parâmetros: raiz (Sala*) - A raiz da árvore a ser liberada.
  */
 void liberarMapa(Sala* raiz) {
-    if (raiz != NULL) {
-        liberarMapa(raiz->esquerda);
-        liberarMapa(raiz->direita);
-        free(raiz);
+    while (raiz != NULL) {
+        if (raiz->esquerda != NULL) {
+            Sala* esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        } else {
+            Sala* direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
 }